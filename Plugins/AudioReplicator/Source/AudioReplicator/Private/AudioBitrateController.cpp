@@ -0,0 +1,77 @@
+#include "AudioBitrateController.h"
+
+namespace
+{
+    constexpr double DecreaseFactor = 0.8;
+    constexpr double IncreaseFractionPerSec = 0.08;
+    constexpr int32 QueueHighMs = 60;
+    constexpr int32 DecreaseIntervalMs = 200;
+    constexpr int32 HoldMs = 2000;
+    // Loss this heavy is congestion on the relay path rather than random drops; FEC alone will not fix it.
+    constexpr int32 CongestionLossPercent = 10;
+    // Bitrate changes are applied in steps of this size so tiny increases do not touch the encoder every frame.
+    constexpr int32 BitrateStep = 500;
+}
+
+void FAudioBitrateController::Configure(int32 InMinBitrate, int32 InMaxBitrate, int32 InMinLossPercent, int32 InMaxLossPercent, int32 InFrameMs)
+{
+    MaxBitrate = FMath::Max(0, InMaxBitrate);
+    MinBitrate = FMath::Clamp(InMinBitrate, 0, MaxBitrate);
+    MinLossPercent = FMath::Clamp(InMinLossPercent, 0, 100);
+    MaxLossPercent = FMath::Clamp(InMaxLossPercent, MinLossPercent, 100);
+
+    const int32 FrameMs = FMath::Max(1, InFrameMs);
+    QueueHighFrames = FMath::Max(2, QueueHighMs / FrameMs);
+    DecreaseIntervalFrames = FMath::Max(1, DecreaseIntervalMs / FrameMs);
+    HoldFrames = FMath::Max(1, HoldMs / FrameMs);
+    IncreasePerFrame = MaxBitrate * IncreaseFractionPerSec * FrameMs / 1000.0;
+
+    Rate = MaxBitrate;
+    Bitrate = MaxBitrate;
+    LossPercent = MinLossPercent;
+    FramesSinceDecrease = HoldFrames;
+    NumDecreases = 0;
+}
+
+bool FAudioBitrateController::Update(const FConditions& Conditions)
+{
+    if (!IsEnabled())
+        return false;
+
+    FramesSinceDecrease = FMath::Min(FramesSinceDecrease + 1, HoldFrames);
+
+    const bool bCongested = Conditions.bSaturated
+        || Conditions.QueuedFrames >= QueueHighFrames
+        || Conditions.LossPercent >= CongestionLossPercent;
+
+    if (bCongested)
+    {
+        // Wait for the previous cut to show before cutting again.
+        if (FramesSinceDecrease >= DecreaseIntervalFrames)
+        {
+            Rate = FMath::Max<double>(MinBitrate, Rate * DecreaseFactor);
+            FramesSinceDecrease = 0;
+            ++NumDecreases;
+        }
+    }
+    else if (FramesSinceDecrease >= HoldFrames)
+    {
+        Rate = FMath::Min<double>(MaxBitrate, Rate + IncreasePerFrame);
+    }
+
+    int32 NewBitrate = FMath::Clamp(FMath::RoundToInt32(Rate / BitrateStep) * BitrateStep, MinBitrate, MaxBitrate);
+    if (Rate >= MaxBitrate)
+    {
+        NewBitrate = MaxBitrate;
+    }
+    else if (Rate <= MinBitrate)
+    {
+        NewBitrate = MinBitrate;
+    }
+    const int32 NewLossPercent = FMath::Clamp(Conditions.LossPercent, MinLossPercent, MaxLossPercent);
+
+    const bool bChanged = NewBitrate != Bitrate || NewLossPercent != LossPercent;
+    Bitrate = NewBitrate;
+    LossPercent = NewLossPercent;
+    return bChanged;
+}
@@ -0,0 +1,65 @@
+#include "AudioPcmBuffer.h"
+#include "UObject/Package.h"
+#include "PcmDsp.h"
+
+UAudioPcmBuffer* UAudioPcmBuffer::Create(TArray<int16>&& InSamples, int32 InSampleRate, int32 InChannels)
+{
+    UAudioPcmBuffer* Buffer = NewObject<UAudioPcmBuffer>(GetTransientPackage());
+    Buffer->SetSamples(MoveTemp(InSamples), InSampleRate, InChannels);
+    return Buffer;
+}
+
+void UAudioPcmBuffer::SetSamples(TArray<int16>&& InSamples, int32 InSampleRate, int32 InChannels)
+{
+    Samples = MoveTemp(InSamples);
+    SampleRate = InSampleRate;
+    Channels = InChannels;
+}
+
+float UAudioPcmBuffer::GetDurationSec() const
+{
+    const int64 Den = (int64)SampleRate * Channels;
+    return (Den > 0) ? (float)((double)Samples.Num() / (double)Den) : 0.0f;
+}
+
+void UAudioPcmBuffer::GetSampleValues(int32 StartSample, int32 Count, TArray<int32>& OutValues) const
+{
+    const int32 Begin = FMath::Clamp(StartSample, 0, Samples.Num());
+    const int32 End = (Count < 0) ? Samples.Num() : FMath::Clamp(Begin + Count, Begin, Samples.Num());
+
+    OutValues.Reset(End - Begin);
+    OutValues.AddUninitialized(End - Begin);
+    PcmDsp::Int16ToInt32(Samples.GetData() + Begin, OutValues.GetData(), End - Begin);
+}
+
+void UAudioPcmBuffer::SetSampleValues(const TArray<int32>& Values, int32 InSampleRate, int32 InChannels)
+{
+    Samples.Reset(Values.Num());
+    Samples.AddUninitialized(Values.Num());
+    PcmDsp::Int32ToInt16(Values.GetData(), Samples.GetData(), Values.Num());
+    SampleRate = InSampleRate;
+    Channels = InChannels;
+}
+
+void UAudioPcmBuffer::ApplyGain(float Gain)
+{
+    PcmDsp::ApplyGain(Samples.GetData(), Samples.Num(), Gain);
+}
+
+bool UAudioPcmBuffer::AppendBuffer(const UAudioPcmBuffer* Other)
+{
+    if (!Other || Other->SampleRate != SampleRate || Other->Channels != Channels)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("AppendBuffer: format mismatch"));
+        return false;
+    }
+    if (Other == this)
+    {
+        Samples.Append(TArray<int16>(Samples));
+    }
+    else
+    {
+        Samples.Append(Other->Samples);
+    }
+    return true;
+}
@@ -1,7 +1,12 @@
 #include "AudioReplicatorBPLibrary.h"
 #include "OpusCodec.h"
+#include "OpusCodecPool.h"
+#include "OpusPacketArena.h"
 #include "PcmWavUtils.h"
 #include "Chunking.h"
+#include "PcmDsp.h"
+#include "PcmResampler.h"
+#include "AudioReplicatorBenchmarks.h"
 #include "Misc/Paths.h"
 #include "HAL/FileManager.h"
 
@@ -9,35 +14,77 @@ static void Int32ToInt16(const TArray<int32>& In, TArray<int16>& Out)
 {
     Out.Reset(In.Num());
     Out.AddUninitialized(In.Num());
-    for (int32 i = 0; i < In.Num(); ++i)
-    {
-        int32 v = FMath::Clamp(In[i], -32768, 32767);
-        Out[i] = (int16)v;
-    }
+    PcmDsp::Int32ToInt16(In.GetData(), Out.GetData(), In.Num());
 }
 static void Int16ToInt32(const TArray<int16>& In, TArray<int32>& Out)
 {
     Out.Reset(In.Num());
     Out.AddUninitialized(In.Num());
-    for (int32 i = 0; i < In.Num(); ++i) Out[i] = (int32)In[i];
+    PcmDsp::Int16ToInt32(In.GetData(), Out.GetData(), In.Num());
 }
 
-static void WrapPackets(const TArray<TArray<uint8>>& In, TArray<FOpusPacket>& Out)
+static void UnwrapPackets(const TArray<FOpusPacket>& In, TArray<TArray<uint8>>& Out)
 {
     Out.Reset(In.Num());
-    for (const auto& P : In)
+    for (const auto& W : In)
     {
-        FOpusPacket W; W.Data = P;
-        Out.Add(MoveTemp(W));
+        Out.Add(W.Data);
     }
 }
-static void UnwrapPackets(const TArray<FOpusPacket>& In, TArray<TArray<uint8>>& Out)
+
+// Rates Opus cannot encode (44.1 kHz, ...) go through FPcmResampler to AUDIO_REPL_OPUS_SR first.
+// OutHeader describes the packets, including the trims that restore the exact length.
+static bool EncodePcm16(TArrayView<const int16> Pcm, int32 SR, int32 Ch, int32 Bitrate, int32 FrameMs, EOpusEncoderProfile Profile, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader)
 {
-    Out.Reset(In.Num());
-    for (const auto& W : In)
+    const int32 EncodeSR = FOpusCodec::GetEncodeSampleRate(SR);
+    const int32 FrameSize = (EncodeSR / 1000) * FrameMs; // per channel
+
+    TSharedPtr<FOpusCodec> Codec = FOpusCodecPool::Get().AcquireEncoder(EncodeSR, Ch, Bitrate, Profile);
+    if (!Codec) return false;
+
+    TArray<int16> Resampled;
+    if (EncodeSR != SR)
     {
-        Out.Add(W.Data);
+        if (!FPcmResampler::ResampleBuffer(Pcm, SR, EncodeSR, Ch, EAudioResampleQuality::Balanced, Resampled)) return false;
+        Pcm = Resampled;
     }
+
+    // Encode into one arena; each packet is copied once, into its FOpusPacket.
+    FOpusPacketArena Arena;
+    if (!Codec->EncodeClipToArena(Pcm, FrameSize, Arena, OutHeader.PreSkip, OutHeader.EndTrim)) return false;
+
+    Arena.ToPackets(OutPackets);
+    OutHeader.SampleRate = EncodeSR;
+    OutHeader.Channels = Ch;
+    OutHeader.Bitrate = Bitrate;
+    OutHeader.FrameMs = FrameMs;
+    OutHeader.Profile = Profile;
+    OutHeader.NumPackets = OutPackets.Num();
+    OutHeader.bLive = false;
+    return true;
+}
+
+// SR is the rate the packets were encoded from (EncodePcm16 may have resampled it); the PCM
+// comes out at OutSR, e.g. the audio device rate, or at SR when OutSR is 0.
+// PreSkip and EndTrim are in samples per channel at the codec rate, as in FOpusStreamHeader.
+static bool DecodePcm16(const TArray<FOpusPacket>& Packets, int32 SR, int32 Ch, int32 PreSkip, int32 EndTrim, int32 OutSR, TArray<int16>& OutPcm)
+{
+    const int32 DecodeSR = FOpusCodec::GetEncodeSampleRate(SR);
+    TSharedPtr<FOpusCodec> Codec = FOpusCodecPool::Get().AcquireDecoder(DecodeSR, Ch);
+    if (!Codec) return false;
+
+    TArray<TArray<uint8>> RawPackets;
+    UnwrapPackets(Packets, RawPackets);
+
+    const int32 TargetSR = OutSR > 0 ? OutSR : SR;
+    if (TargetSR == DecodeSR)
+    {
+        return Codec->DecodePacketsToPcm16(RawPackets, OutPcm, PreSkip, EndTrim);
+    }
+
+    TArray<int16> Decoded;
+    if (!Codec->DecodePacketsToPcm16(RawPackets, Decoded, PreSkip, EndTrim)) return false;
+    return FPcmResampler::ResampleBuffer(Decoded, DecodeSR, TargetSR, Ch, EAudioResampleQuality::Balanced, OutPcm);
 }
 
 FString UAudioReplicatorBPLibrary::ResolveProjectPath(const FString& Path)
@@ -65,19 +112,10 @@ bool UAudioReplicatorBPLibrary::LoadWavToPcm16(const FString& WavPath, TArray<in
     return true;
 }
 
-bool UAudioReplicatorBPLibrary::EncodePcm16ToOpusPackets(const TArray<int32>& Pcm16, int32 SR, int32 Ch, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets)
+bool UAudioReplicatorBPLibrary::EncodePcm16ToOpusPackets(const TArray<int32>& Pcm16, int32 SR, int32 Ch, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader, EOpusEncoderProfile Profile)
 {
-    const int32 FrameSize = (SR / 1000) * FrameMs; // per channel
     TArray<int16> Pcm16s; Int32ToInt16(Pcm16, Pcm16s);
-
-    auto Codec = FOpusCodec::Create(SR, Ch, Bitrate);
-    if (!Codec) return false;
-
-    TArray<TArray<uint8>> RawPackets;
-    if (!Codec->EncodePcm16ToPackets(Pcm16s, FrameSize, RawPackets)) return false;
-
-    WrapPackets(RawPackets, OutPackets);
-    return true;
+    return EncodePcm16(Pcm16s, SR, Ch, Bitrate, FrameMs, Profile, OutPackets, OutHeader);
 }
 
 void UAudioReplicatorBPLibrary::PackOpusPackets(const TArray<FOpusPacket>& Packets, TArray<uint8>& OutBuffer)
@@ -90,16 +128,10 @@ bool UAudioReplicatorBPLibrary::UnpackOpusPackets(const TArray<uint8>& Buffer, T
     return Chunking::UnpackWithLengths(Buffer, OutPackets);
 }
 
-bool UAudioReplicatorBPLibrary::DecodeOpusPacketsToPcm16(const TArray<FOpusPacket>& Packets, int32 SR, int32 Ch, TArray<int32>& OutPcm16)
+bool UAudioReplicatorBPLibrary::DecodeOpusPacketsToPcm16(const TArray<FOpusPacket>& Packets, int32 SR, int32 Ch, TArray<int32>& OutPcm16, int32 OutputSampleRate)
 {
-    auto Codec = FOpusCodec::Create(SR, Ch, 32000);
-    if (!Codec) return false;
-
-    TArray<TArray<uint8>> RawPackets;
-    UnwrapPackets(Packets, RawPackets);
-
     TArray<int16> Pcm;
-    if (!Codec->DecodePacketsToPcm16(RawPackets, Pcm)) return false;
+    if (!DecodePcm16(Packets, SR, Ch, 0, 0, OutputSampleRate, Pcm)) return false;
     Int16ToInt32(Pcm, OutPcm16);
     return true;
 }
@@ -110,19 +142,81 @@ bool UAudioReplicatorBPLibrary::SavePcm16ToWav(const FString& OutPath, const TAr
     return PcmWav::SavePcm16ToWavFile(OutPath, Pcm16s, SR, Ch);
 }
 
-bool UAudioReplicatorBPLibrary::TranscodeWavToOpusAndBack(const FString& InWavPath, const FString& OutWavPath, int32 Bitrate, int32 FrameMs)
+bool UAudioReplicatorBPLibrary::LoadWavToPcmBuffer(const FString& WavPath, UAudioPcmBuffer*& OutBuffer, EAudioWavDownmix Downmix)
 {
+    OutBuffer = nullptr;
     int32 SR = 0, Ch = 0;
-    TArray<int32> Pcm;
-    if (!LoadWavToPcm16(InWavPath, Pcm, SR, Ch)) return false;
+    TArray<int16> Pcm;
+    PcmWav::FWavLoadOptions Options;
+    Options.Downmix = Downmix;
+    if (!PcmWav::LoadWavFileToPcm16(WavPath, Pcm, SR, Ch, Options)) return false;
+    OutBuffer = UAudioPcmBuffer::Create(MoveTemp(Pcm), SR, Ch);
+    return true;
+}
+
+bool UAudioReplicatorBPLibrary::EncodePcmBufferToOpusPackets(const UAudioPcmBuffer* Buffer, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader, EOpusEncoderProfile Profile)
+{
+    if (!Buffer) return false;
+    return EncodePcm16(Buffer->GetSamples(), Buffer->GetSampleRate(), Buffer->GetChannels(), Bitrate, FrameMs, Profile, OutPackets, OutHeader);
+}
+
+bool UAudioReplicatorBPLibrary::DecodeOpusPacketsToPcmBuffer(const TArray<FOpusPacket>& Packets, int32 SR, int32 Ch, UAudioPcmBuffer*& OutBuffer, int32 OutputSampleRate)
+{
+    OutBuffer = nullptr;
+    TArray<int16> Pcm;
+    if (!DecodePcm16(Packets, SR, Ch, 0, 0, OutputSampleRate, Pcm)) return false;
+    OutBuffer = UAudioPcmBuffer::Create(MoveTemp(Pcm), OutputSampleRate > 0 ? OutputSampleRate : SR, Ch);
+    return true;
+}
+
+bool UAudioReplicatorBPLibrary::DecodeOpusStreamToPcmBuffer(const TArray<FOpusPacket>& Packets, const FOpusStreamHeader& Header, UAudioPcmBuffer*& OutBuffer, int32 OutputSampleRate)
+{
+    OutBuffer = nullptr;
+    TArray<int16> Pcm;
+    if (!DecodePcm16(Packets, Header.SampleRate, Header.Channels, Header.PreSkip, Header.EndTrim, OutputSampleRate, Pcm)) return false;
+    OutBuffer = UAudioPcmBuffer::Create(MoveTemp(Pcm), OutputSampleRate > 0 ? OutputSampleRate : Header.SampleRate, Header.Channels);
+    return true;
+}
+
+bool UAudioReplicatorBPLibrary::ResamplePcmBuffer(const UAudioPcmBuffer* Buffer, int32 SampleRate, UAudioPcmBuffer*& OutBuffer, EAudioResampleQuality Quality)
+{
+    OutBuffer = nullptr;
+    if (!Buffer) return false;
+
+    TArray<int16> Pcm;
+    if (!FPcmResampler::ResampleBuffer(Buffer->GetSamples(), Buffer->GetSampleRate(), SampleRate, Buffer->GetChannels(), Quality, Pcm)) return false;
+    OutBuffer = UAudioPcmBuffer::Create(MoveTemp(Pcm), SampleRate, Buffer->GetChannels());
+    return true;
+}
+
+bool UAudioReplicatorBPLibrary::SavePcmBufferToWav(const FString& OutPath, const UAudioPcmBuffer* Buffer)
+{
+    if (!Buffer) return false;
+    return PcmWav::SavePcm16ToWavFile(OutPath, Buffer->GetSamples(), Buffer->GetSampleRate(), Buffer->GetChannels());
+}
+
+UAudioPcmBuffer* UAudioReplicatorBPLibrary::MakePcmBuffer(const TArray<int32>& Pcm16, int32 SR, int32 Ch)
+{
+    TArray<int16> Pcm16s; Int32ToInt16(Pcm16, Pcm16s);
+    return UAudioPcmBuffer::Create(MoveTemp(Pcm16s), SR, Ch);
+}
+
+bool UAudioReplicatorBPLibrary::TranscodeWavToOpusAndBack(const FString& InWavPath, const FString& OutWavPath, int32 Bitrate, int32 FrameMs, EOpusEncoderProfile Profile)
+{
+    // Stays in int16 end to end.
+    int32 SR = 0, Ch = 0;
+    TArray<int16> Pcm;
+    if (!PcmWav::LoadWavFileToPcm16(InWavPath, Pcm, SR, Ch)) return false;
 
     TArray<FOpusPacket> Packets;
-    if (!EncodePcm16ToOpusPackets(Pcm, SR, Ch, Bitrate, FrameMs, Packets)) return false;
+    FOpusStreamHeader Header;
+    if (!EncodePcm16(Pcm, SR, Ch, Bitrate, FrameMs, Profile, Packets, Header)) return false;
 
-    TArray<int32> DecPcm;
-    if (!DecodeOpusPacketsToPcm16(Packets, SR, Ch, DecPcm)) return false;
+    // Trimmed with the header, so the output lines up with the input sample for sample.
+    TArray<int16> DecPcm;
+    if (!DecodePcm16(Packets, SR, Ch, Header.PreSkip, Header.EndTrim, 0, DecPcm)) return false;
 
-    return SavePcm16ToWav(OutWavPath, DecPcm, SR, Ch);
+    return PcmWav::SavePcm16ToWavFile(OutWavPath, DecPcm, SR, Ch);
 }
 
 
@@ -151,9 +245,13 @@ FString UAudioReplicatorBPLibrary::FormatAudioTestReport(
     const double DurInSec = Den > 0.0 ? double(PcmSamplesTotal) / Den : 0.0;
     const double DurOutSec = (DecPcmSamplesTotal >= 0 && Den > 0.0) ? double(DecPcmSamplesTotal) / Den : -1.0;
 
-    // Tail samples that do not align with a full frame
+    // Samples of the last frame, and the padding the encoder adds around the clip (trimmed on decode)
+    const int32 PreSkip = FOpusCodec::GetLookahead(SR);
+    int32 EndTrim = 0;
+    const int32 ClipFrames = FOpusCodec::GetClipFrameCount(PcmSamplesTotal / Ch, FrameSampPerCh, PreSkip, EndTrim);
     const int32 TailSamples = (FrameSampTotal > 0) ? (PcmSamplesTotal % FrameSampTotal) : 0;
     const double TailMs = Den > 0.0 ? (double)TailSamples * 1000.0 / Den : 0.0;
+    const double PadMs = (double)(PreSkip + EndTrim) * 1000.0 / double(SR);
 
     // Sizes and compression
     const int64 PcmBytes = int64(PcmSamplesTotal) * 2; // int16
@@ -163,7 +261,7 @@ FString UAudioReplicatorBPLibrary::FormatAudioTestReport(
     // Packets
     const double AvgPktBytes = (PacketCount > 0) ? double(BufferBytes) / double(PacketCount) : 0.0;
     const double PktsPerSec = (DurInSec > 0.0) ? double(PacketCount) / DurInSec : 0.0;
-    const double ExpPktCount = (DurInSec > 0.0 && FrmMs > 0) ? DurInSec * (1000.0 / double(FrmMs)) : 0.0;
+    const double ExpPktCount = double(ClipFrames);
     const double PktCountDiff = double(PacketCount) - ExpPktCount;
 
     // "Effective" average bitrate based on the resulting buffer
@@ -183,8 +281,8 @@ FString UAudioReplicatorBPLibrary::FormatAudioTestReport(
             *FmtF(DurOutSec, 3),
             *FmtF(DurOutSec - DurInSec, 3));
     }
-    Out += FString::Printf(TEXT("Tail (non-aligned to frame): %d samp  ≈%s ms\n"),
-        TailSamples, *FmtF(TailMs, 2));
+    Out += FString::Printf(TEXT("Tail (padded into last frame): %d samp  ≈%s ms   Padding: pre-skip %d + end trim %d samp/ch  ≈%s ms\n"),
+        TailSamples, *FmtF(TailMs, 2), PreSkip, EndTrim, *FmtF(PadMs, 2));
 
     Out += TEXT("\n--- Compression ---\n");
     Out += FString::Printf(TEXT("Opus Buffer: %d bytes  Packets: %d  AvgPkt≈%s B\n"),
@@ -198,18 +296,51 @@ FString UAudioReplicatorBPLibrary::FormatAudioTestReport(
     Out += FString::Printf(TEXT("Pkts/sec≈ %s   Expected≈ %s   Δ≈ %s\n"),
         *FmtF(PktsPerSec, 2), *FmtF(ExpPktCount, 1), *FmtF(PktCountDiff, 1));
 
-    Out += TEXT("\nHint: Δ≈0 and a small tail are expected. Large |Δ| or tail → check frame alignment and FrameMs.\n");
+    Out += TEXT("\nHint: Δ≈0 and Δdur=0 (decoded with the header trims) are expected. Large |Δ| → check FrameMs and SampleRate.\n");
     return Out;
 }
 
+FString UAudioReplicatorBPLibrary::RunPcmKernelBenchmark(int32 Iterations)
+{
+    return AudioReplicatorBenchmarks::RunPcmKernels(Iterations);
+}
+
+FString UAudioReplicatorBPLibrary::RunWavConversionBenchmark(int32 Iterations)
+{
+    return AudioReplicatorBenchmarks::RunWavConversion(Iterations);
+}
+
+FString UAudioReplicatorBPLibrary::RunResamplerBenchmark(int32 Iterations)
+{
+    return AudioReplicatorBenchmarks::RunResampler(Iterations);
+}
+
+FString UAudioReplicatorBPLibrary::RunEncoderProfileBenchmark(int32 Seconds)
+{
+    return AudioReplicatorBenchmarks::RunEncoderProfiles(Seconds);
+}
+
+void UAudioReplicatorBPLibrary::GetPcmBufferLevel(const UAudioPcmBuffer* Buffer, float& OutPeak, float& OutRms)
+{
+    OutPeak = 0.0f;
+    OutRms = 0.0f;
+    if (Buffer)
+    {
+        PcmDsp::ComputePeakRms(Buffer->GetSamples().GetData(), Buffer->GetNumSamples(), OutPeak, OutRms);
+    }
+}
+
 FString UAudioReplicatorBPLibrary::OpusStreamHeaderToString(const FOpusStreamHeader& Header)
 {
-    return FString::Printf(TEXT("Opus Header: SR=%d Hz  Ch=%d  Bitrate=%d bps  Frame=%d ms  Packets=%d"),
+    return FString::Printf(TEXT("Opus Header: SR=%d Hz  Ch=%d  Bitrate=%d bps  Frame=%d ms  Profile=%s  Packets=%d  PreSkip=%d  EndTrim=%d"),
         Header.SampleRate,
         Header.Channels,
         Header.Bitrate,
         Header.FrameMs,
-        Header.NumPackets);
+        *UEnum::GetDisplayValueAsText(Header.Profile).ToString(),
+        Header.NumPackets,
+        Header.PreSkip,
+        Header.EndTrim);
 }
 
 static FString JoinIntArray(const TArray<int32>& Values)
@@ -226,6 +357,21 @@ static FString JoinIntArray(const TArray<int32>& Values)
     return Result;
 }
 
+static FString JoinRanges(const TArray<FIntPoint>& Ranges)
+{
+    FString Result;
+    for (int32 i = 0; i < Ranges.Num(); ++i)
+    {
+        const FIntPoint& R = Ranges[i];
+        Result += (R.X == R.Y) ? FString::Printf(TEXT("%d"), R.X) : FString::Printf(TEXT("%d-%d"), R.X, R.Y);
+        if (i + 1 < Ranges.Num())
+        {
+            Result += TEXT(", ");
+        }
+    }
+    return Result;
+}
+
 FString UAudioReplicatorBPLibrary::FormatOutgoingDebugReport(const FAudioReplicatorOutgoingDebug& DebugInfo)
 {
     FString Out;
@@ -245,13 +391,22 @@ FString UAudioReplicatorBPLibrary::FormatOutgoingDebugReport(const FAudioReplica
         DebugInfo.bHeaderSent ? TEXT("true") : TEXT("false"),
         DebugInfo.bEndSent ? TEXT("true") : TEXT("false"),
         DebugInfo.bTransferComplete ? TEXT("true") : TEXT("false"));
+    if (DebugInfo.Header.bLive)
+    {
+        Out += FString::Printf(TEXT("Frames suppressed (silence): %d\n"), DebugInfo.FramesSuppressed);
+        Out += FString::Printf(TEXT("Adaptive: bitrate=%d bps  expected loss=%d%%  backoffs=%d\n"),
+            DebugInfo.CurrentBitrate, DebugInfo.CurrentLossPercent, DebugInfo.BitrateDecreases);
+    }
 
     if (DebugInfo.PendingChunkIndices.Num() > 0)
     {
         Out += FString::Printf(TEXT("Pending indices: %s\n"), *JoinIntArray(DebugInfo.PendingChunkIndices));
     }
 
-    Out += TEXT("\n--- Chunk Details ---\n");
+    if (DebugInfo.Chunks.Num() > 0)
+    {
+        Out += TEXT("\n--- Chunk Details ---\n");
+    }
     for (const FAudioReplicatorChunkDebug& Chunk : DebugInfo.Chunks)
     {
         Out += FString::Printf(TEXT("[%d] size=%d B  sent=%s\n"),
@@ -283,12 +438,17 @@ FString UAudioReplicatorBPLibrary::FormatIncomingDebugReport(const FAudioReplica
         *FmtF(DebugInfo.EstimatedDurationSec, 3),
         *FmtF(DebugInfo.EstimatedBitrateKbps, 2));
 
-    if (DebugInfo.MissingChunkIndices.Num() > 0)
+    if (DebugInfo.MissingRanges.Num() > 0)
     {
-        Out += FString::Printf(TEXT("Missing indices: %s\n"), *JoinIntArray(DebugInfo.MissingChunkIndices));
+        const int32 NotShown = DebugInfo.MissingRangeCount - DebugInfo.MissingRanges.Num();
+        Out += FString::Printf(TEXT("Missing ranges: %s%s\n"), *JoinRanges(DebugInfo.MissingRanges),
+            NotShown > 0 ? *FString::Printf(TEXT(" (+%d more)"), NotShown) : TEXT(""));
     }
 
-    Out += TEXT("\n--- Chunk Details ---\n");
+    if (DebugInfo.Chunks.Num() > 0)
+    {
+        Out += TEXT("\n--- Chunk Details ---\n");
+    }
     for (const FAudioReplicatorChunkDebug& Chunk : DebugInfo.Chunks)
     {
         Out += FString::Printf(TEXT("[%d] size=%d B  received=%s\n"),
@@ -0,0 +1,358 @@
+#include "AudioReplicatorBenchmarks.h"
+#include "PcmDsp.h"
+#include "PcmWavUtils.h"
+#include "PcmResampler.h"
+#include "OpusCodec.h"
+#include "OpusPacketArena.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+    constexpr int32 BenchSampleRate = 48000;
+    constexpr int32 BenchChannels = 2;
+
+    template <typename FuncType>
+    double TimeMs(int32 Iterations, FuncType&& Func)
+    {
+        Func(); // warm up caches and page in the buffers
+        const double Start = FPlatformTime::Seconds();
+        for (int32 i = 0; i < Iterations; ++i)
+        {
+            Func();
+        }
+        return (FPlatformTime::Seconds() - Start) * 1000.0;
+    }
+
+    // Raw little-endian data for one second of a noise-like signal at about -6 dBFS.
+    TArray<uint8> MakeRawSource(PcmWav::ESampleFormat Format, int32 Channels)
+    {
+        PcmWav::FWavSourceFormat Layout;
+        Layout.SampleFormat = Format;
+        Layout.Channels = Channels;
+
+        const int32 Num = BenchSampleRate * Channels;
+        TArray<uint8> Raw;
+        Raw.SetNumUninitialized(Num * Layout.GetBytesPerSample());
+        uint8* Dst = Raw.GetData();
+        uint32 Seed = 0x7654321u;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            Seed = Seed * 1664525u + 1013904223u;
+            const int32 V = (int32)Seed >> 1; // full-scale int32 halved
+            switch (Format)
+            {
+            case PcmWav::ESampleFormat::Int16:   { const int16 S = (int16)(V >> 16); FMemory::Memcpy(Dst, &S, 2); Dst += 2; break; }
+            case PcmWav::ESampleFormat::Int24:   { FMemory::Memcpy(Dst, reinterpret_cast<const uint8*>(&V) + 1, 3); Dst += 3; break; }
+            case PcmWav::ESampleFormat::Int32:   { FMemory::Memcpy(Dst, &V, 4); Dst += 4; break; }
+            case PcmWav::ESampleFormat::Float32: { const float F = V / 2147483648.0f; FMemory::Memcpy(Dst, &F, 4); Dst += 4; break; }
+            }
+        }
+        return Raw;
+    }
+
+    // Speedup over the scalar reference the vector kernels are meant to reach.
+    constexpr double TargetSpeedup = 4.0;
+
+    // One kernel row; counts the kernels that miss TargetSpeedup.
+    void AddRow(FString& Out, const TCHAR* Name, double ScalarMs, double VectorMs, int32 Iterations, int32& InOutBelowTarget)
+    {
+        const double Speedup = (VectorMs > 0.0) ? ScalarMs / VectorMs : 0.0;
+        const bool bBelowTarget = Speedup < TargetSpeedup;
+        InOutBelowTarget += bBelowTarget ? 1 : 0;
+        Out += FString::Printf(TEXT("%-18s scalar=%8.3f ms  vector=%8.3f ms  x%.2f%s\n"),
+            Name, ScalarMs / Iterations, VectorMs / Iterations, Speedup, bBelowTarget ? TEXT("  (below target)") : TEXT(""));
+    }
+}
+
+namespace AudioReplicatorBenchmarks
+{
+    FString RunPcmKernels(int32 Iterations)
+    {
+        Iterations = FMath::Clamp(Iterations, 1, 100000);
+        const int32 Frames = BenchSampleRate;
+        const int32 Num = Frames * BenchChannels;
+
+        // Deterministic noise-like signal that also hits both int16 extremes.
+        TArray<int16> Pcm;
+        Pcm.SetNumUninitialized(Num);
+        uint32 Seed = 0x1234567u;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            Seed = Seed * 1664525u + 1013904223u;
+            Pcm[i] = (int16)(Seed >> 16);
+        }
+        Pcm[0] = -32768;
+        Pcm[1] = 32767;
+
+        TArray<int32> Wide;
+        Wide.SetNumUninitialized(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            Wide[i] = Pcm[i] * 3; // about two thirds of the samples need clamping
+        }
+
+        TArray<float> Float;
+        Float.SetNumUninitialized(Num);
+        TArray<int16> Out16;
+        Out16.SetNumUninitialized(Num);
+        TArray<int16> Left, Right;
+        Left.SetNumUninitialized(Frames);
+        Right.SetNumUninitialized(Frames);
+        int16* Planes[2] = { Left.GetData(), Right.GetData() };
+        const int16* ConstPlanes[2] = { Left.GetData(), Right.GetData() };
+        float Peak = 0.0f, Rms = 0.0f;
+        float Dot = 0.0f;
+
+        FString Out;
+        Out += FString::Printf(TEXT("=== PcmDsp kernels · %s · %d Hz x%d · %d iterations ===\n"),
+            PcmDsp::GetKernelPathName(), BenchSampleRate, BenchChannels, Iterations);
+        Out += TEXT("Per-call time for one second of audio:\n");
+        int32 BelowTarget = 0;
+
+        AddRow(Out, TEXT("Int16ToFloat"),
+            TimeMs(Iterations, [&]() { PcmDsp::Scalar::Int16ToFloat(Pcm.GetData(), Float.GetData(), Num); }),
+            TimeMs(Iterations, [&]() { PcmDsp::Int16ToFloat(Pcm.GetData(), Float.GetData(), Num); }), Iterations, BelowTarget);
+        AddRow(Out, TEXT("FloatToInt16"),
+            TimeMs(Iterations, [&]() { PcmDsp::Scalar::FloatToInt16(Float.GetData(), Out16.GetData(), Num); }),
+            TimeMs(Iterations, [&]() { PcmDsp::FloatToInt16(Float.GetData(), Out16.GetData(), Num); }), Iterations, BelowTarget);
+        AddRow(Out, TEXT("Int32ToInt16 (sat)"),
+            TimeMs(Iterations, [&]() { PcmDsp::Scalar::Int32ToInt16(Wide.GetData(), Out16.GetData(), Num); }),
+            TimeMs(Iterations, [&]() { PcmDsp::Int32ToInt16(Wide.GetData(), Out16.GetData(), Num); }), Iterations, BelowTarget);
+        AddRow(Out, TEXT("ApplyGain int16"),
+            TimeMs(Iterations, [&]() { PcmDsp::Scalar::ApplyGain(Out16.GetData(), Num, 0.8f); }),
+            TimeMs(Iterations, [&]() { PcmDsp::ApplyGain(Out16.GetData(), Num, 0.8f); }), Iterations, BelowTarget);
+        AddRow(Out, TEXT("Deinterleave"),
+            TimeMs(Iterations, [&]() { PcmDsp::Scalar::Deinterleave(Pcm.GetData(), BenchChannels, Frames, Planes); }),
+            TimeMs(Iterations, [&]() { PcmDsp::Deinterleave(Pcm.GetData(), BenchChannels, Frames, Planes); }), Iterations, BelowTarget);
+        AddRow(Out, TEXT("Interleave"),
+            TimeMs(Iterations, [&]() { PcmDsp::Scalar::Interleave(ConstPlanes, BenchChannels, Frames, Out16.GetData()); }),
+            TimeMs(Iterations, [&]() { PcmDsp::Interleave(ConstPlanes, BenchChannels, Frames, Out16.GetData()); }), Iterations, BelowTarget);
+        AddRow(Out, TEXT("PeakRms"),
+            TimeMs(Iterations, [&]() { PcmDsp::Scalar::ComputePeakRms(Pcm.GetData(), Num, Peak, Rms); }),
+            TimeMs(Iterations, [&]() { PcmDsp::ComputePeakRms(Pcm.GetData(), Num, Peak, Rms); }), Iterations, BelowTarget);
+        AddRow(Out, TEXT("DotProduct"),
+            TimeMs(Iterations, [&]() { Dot += PcmDsp::Scalar::DotProduct(Float.GetData(), Float.GetData() + Frames, Frames); }),
+            TimeMs(Iterations, [&]() { Dot += PcmDsp::DotProduct(Float.GetData(), Float.GetData() + Frames, Frames); }), Iterations, BelowTarget);
+
+        // The scalar reference is plain C++ that the compiler may vectorize on its own, so memory-bound
+        // conversions can stay below the target in optimized builds.
+        Out += FString::Printf(TEXT("Target x%.1f: %s\n"), TargetSpeedup,
+            BelowTarget == 0 ? TEXT("met by every kernel") : *FString::Printf(TEXT("missed by %d of 8 kernels"), BelowTarget));
+
+        // Printing the results keeps the compiler from discarding the work.
+        Out += FString::Printf(TEXT("Check: peak=%.3f rms=%.3f dot=%.3f out[1]=%d\n"), Peak, Rms, Dot, (int32)Out16[1]);
+        return Out;
+    }
+
+    FString RunWavConversion(int32 Iterations)
+    {
+        Iterations = FMath::Clamp(Iterations, 1, 100000);
+
+        struct FCase
+        {
+            const TCHAR* Name;
+            PcmWav::ESampleFormat Format;
+            int32 Channels;
+            EAudioWavDownmix Downmix;
+            bool bDither;
+        };
+        const FCase Cases[] =
+        {
+            { TEXT("PCM16 stereo"),           PcmWav::ESampleFormat::Int16,   2, EAudioWavDownmix::Stereo, true  },
+            { TEXT("PCM16 stereo -> mono"),   PcmWav::ESampleFormat::Int16,   2, EAudioWavDownmix::Mono,   true  },
+            { TEXT("PCM24 stereo"),           PcmWav::ESampleFormat::Int24,   2, EAudioWavDownmix::Stereo, true  },
+            { TEXT("PCM32 stereo"),           PcmWav::ESampleFormat::Int32,   2, EAudioWavDownmix::Stereo, true  },
+            { TEXT("Float32 stereo"),         PcmWav::ESampleFormat::Float32, 2, EAudioWavDownmix::Stereo, true  },
+            { TEXT("Float32 stereo no dith"), PcmWav::ESampleFormat::Float32, 2, EAudioWavDownmix::Stereo, false },
+            { TEXT("PCM24 5.1 -> stereo"),    PcmWav::ESampleFormat::Int24,   6, EAudioWavDownmix::Stereo, true  },
+            { TEXT("Float32 5.1 -> stereo"),  PcmWav::ESampleFormat::Float32, 6, EAudioWavDownmix::Stereo, true  },
+            { TEXT("Float32 7.1 -> mono"),    PcmWav::ESampleFormat::Float32, 8, EAudioWavDownmix::Mono,   true  },
+        };
+
+        FString Out;
+        Out += FString::Printf(TEXT("=== WAV conversion · %s · %d Hz · %d iterations ===\n"),
+            PcmDsp::GetKernelPathName(), BenchSampleRate, Iterations);
+        Out += TEXT("Per-call time for one second of audio:\n");
+
+        int32 Check = 0;
+        for (const FCase& Case : Cases)
+        {
+            PcmWav::FWavSourceFormat Format;
+            Format.SampleFormat = Case.Format;
+            Format.Channels = Case.Channels;
+
+            PcmWav::FWavLoadOptions Options;
+            Options.Downmix = Case.Downmix;
+            Options.bDither = Case.bDither;
+
+            PcmWav::FWavConverter Converter;
+            Converter.Configure(Format, Options);
+
+            const TArray<uint8> Raw = MakeRawSource(Case.Format, Case.Channels);
+            TArray<int16> Pcm;
+            Pcm.SetNumUninitialized(BenchSampleRate * Converter.GetOutputChannels());
+
+            const double Ms = TimeMs(Iterations, [&]() { Converter.Convert(Raw.GetData(), BenchSampleRate, Pcm.GetData()); }) / Iterations;
+            Out += FString::Printf(TEXT("%-22s %8.3f ms  %7.1f MB/s  x%.0f realtime\n"),
+                Case.Name, Ms, (Ms > 0.0) ? Raw.Num() / (Ms * 1000.0) : 0.0, (Ms > 0.0) ? 1000.0 / Ms : 0.0);
+            Check += Pcm[Pcm.Num() / 2];
+        }
+
+        // Printing the results keeps the compiler from discarding the work.
+        Out += FString::Printf(TEXT("Check: %d\n"), Check);
+        return Out;
+    }
+
+    FString RunResampler(int32 Iterations)
+    {
+        Iterations = FMath::Clamp(Iterations, 1, 10000);
+
+        struct FCase
+        {
+            int32 InputRate;
+            int32 OutputRate;
+        };
+        const FCase Cases[] =
+        {
+            { 44100, 48000 },
+            { 22050, 48000 },
+            { 32000, 48000 },
+            { 96000, 48000 },
+            { 48000, 44100 },
+        };
+        const EAudioResampleQuality Qualities[] = { EAudioResampleQuality::Fast, EAudioResampleQuality::Balanced, EAudioResampleQuality::High };
+        const TCHAR* QualityNames[] = { TEXT("Fast"), TEXT("Balanced"), TEXT("High") };
+
+        FString Out;
+        Out += FString::Printf(TEXT("=== FPcmResampler · %s · x%d · %d iterations ===\n"),
+            PcmDsp::GetKernelPathName(), BenchChannels, Iterations);
+        Out += TEXT("Per-call time for one second of audio, pushed in 10 ms blocks:\n");
+
+        int32 Check = 0;
+        for (const FCase& Case : Cases)
+        {
+            // One second of a 1 kHz tone at the input rate.
+            TArray<int16> Pcm;
+            Pcm.SetNumUninitialized(Case.InputRate * BenchChannels);
+            for (int32 f = 0; f < Case.InputRate; ++f)
+            {
+                const int16 S = (int16)(16384.0 * FMath::Sin(2.0 * UE_DOUBLE_PI * 1000.0 * f / Case.InputRate));
+                for (int32 c = 0; c < BenchChannels; ++c)
+                {
+                    Pcm[f * BenchChannels + c] = S;
+                }
+            }
+            const int32 BlockSamples = (Case.InputRate / 100) * BenchChannels;
+
+            for (int32 q = 0; q < UE_ARRAY_COUNT(Qualities); ++q)
+            {
+                FPcmResampler Resampler;
+                Resampler.Init(Case.InputRate, Case.OutputRate, BenchChannels, Qualities[q]);
+                TArray<int16> Resampled;
+                Resampled.Reserve((int32)Resampler.GetOutputFrames(Case.InputRate) * BenchChannels);
+
+                const double Ms = TimeMs(Iterations, [&]()
+                {
+                    Resampled.Reset();
+                    for (int32 Offset = 0; Offset < Pcm.Num(); Offset += BlockSamples)
+                    {
+                        Resampler.Process(MakeArrayView(Pcm.GetData() + Offset, FMath::Min(BlockSamples, Pcm.Num() - Offset)), Resampled);
+                    }
+                    Resampler.Flush(Resampled);
+                }) / Iterations;
+
+                Out += FString::Printf(TEXT("%6d -> %6d %-8s %8.3f ms  x%6.0f realtime  latency %.2f ms\n"),
+                    Case.InputRate, Case.OutputRate, QualityNames[q], Ms, (Ms > 0.0) ? 1000.0 / Ms : 0.0,
+                    Resampler.GetLatencyFrames() * 1000.0 / Case.InputRate);
+                Check += Resampled[Resampled.Num() / 2];
+            }
+        }
+
+        // Printing the results keeps the compiler from discarding the work.
+        Out += FString::Printf(TEXT("Check: %d\n"), Check);
+        return Out;
+    }
+
+    FString RunEncoderProfiles(int32 Seconds)
+    {
+        Seconds = FMath::Clamp(Seconds, 1, 600);
+        constexpr int32 FrameMs = 20;
+        constexpr int32 FrameSamplesPerCh = BenchSampleRate / 1000 * FrameMs;
+
+        // Speech-like source: a 140 Hz harmonic voice with vibrato plus breath noise, gated at a
+        // syllable rate of 4 Hz so the encoder also sees onsets and pauses.
+        TArray<int16> Mono;
+        Mono.SetNumUninitialized(BenchSampleRate * Seconds);
+        uint32 Seed = 0x2468aceu;
+        double Phase = 0.0;
+        for (int32 i = 0; i < Mono.Num(); ++i)
+        {
+            const double T = (double)i / BenchSampleRate;
+            Phase += 2.0 * UE_DOUBLE_PI * 140.0 * (1.0 + 0.03 * FMath::Sin(2.0 * UE_DOUBLE_PI * 5.0 * T)) / BenchSampleRate;
+            double V = 0.0;
+            for (int32 h = 1; h <= 12; ++h)
+            {
+                V += FMath::Sin(h * Phase) / h;
+            }
+            Seed = Seed * 1664525u + 1013904223u;
+            V += 0.05 * ((int32)Seed / 2147483648.0);
+            const double Envelope = FMath::Max(0.0, FMath::Sin(2.0 * UE_DOUBLE_PI * 4.0 * T));
+            Mono[i] = (int16)FMath::Clamp(8000.0 * Envelope * V, -32768.0, 32767.0);
+        }
+        TArray<int16> Stereo;
+        Stereo.SetNumUninitialized(Mono.Num() * 2);
+        for (int32 i = 0; i < Mono.Num(); ++i)
+        {
+            Stereo[2 * i] = Mono[i];
+            Stereo[2 * i + 1] = (int16)(Mono[i] / 2);
+        }
+
+        struct FCase
+        {
+            EOpusEncoderProfile Profile;
+            const TCHAR* Name;
+        };
+        const FCase Cases[] =
+        {
+            { EOpusEncoderProfile::Voice,      TEXT("Voice") },
+            { EOpusEncoderProfile::MusicClip,  TEXT("MusicClip") },
+            { EOpusEncoderProfile::LowLatency, TEXT("LowLatency") },
+            { EOpusEncoderProfile::Archival,   TEXT("Archival") },
+        };
+
+        FString Out;
+        Out += FString::Printf(TEXT("=== Opus encoder profiles · %d Hz · %d ms frames · %d s ===\n"), BenchSampleRate, FrameMs, Seconds);
+        Out += TEXT("Encode time per second of audio (one core):\n");
+
+        int64 Check = 0;
+        for (const FCase& Case : Cases)
+        {
+            for (int32 Channels = 1; Channels <= 2; ++Channels)
+            {
+                const int32 Bitrate = 32000 * Channels;
+                TUniquePtr<FOpusCodec> Codec = FOpusCodec::CreateEncoder(BenchSampleRate, Channels, Bitrate, Case.Profile);
+                if (!Codec)
+                {
+                    Out += FString::Printf(TEXT("%-10s x%d  failed to create the encoder\n"), Case.Name, Channels);
+                    continue;
+                }
+
+                const TArray<int16>& Pcm = Channels == 1 ? Mono : Stereo;
+                // The warm-up pass runs the encoder through the whole signal once before the timed one.
+                FOpusPacketArena Packets;
+                int32 PreSkip = 0, EndTrim = 0;
+                const double Ms = TimeMs(1, [&]() { Codec->EncodeClipToArena(Pcm, FrameSamplesPerCh, Packets, PreSkip, EndTrim); }) / Seconds;
+
+                const double Kbps = Packets.GetTotalBytes() * 8.0 / Seconds / 1000.0;
+                Out += FString::Printf(TEXT("%-10s x%d  %7.3f ms  x%6.0f realtime  %6.1f kbps  delay %.1f ms\n"),
+                    Case.Name, Channels, Ms, (Ms > 0.0) ? 1000.0 / Ms : 0.0, Kbps,
+                    FOpusCodec::GetLookahead(BenchSampleRate, Case.Profile) * 1000.0 / BenchSampleRate);
+                Check += Packets.GetTotalBytes();
+            }
+        }
+
+        // Printing the results keeps the compiler from discarding the work.
+        Out += FString::Printf(TEXT("Check: %lld\n"), Check);
+        return Out;
+    }
+}
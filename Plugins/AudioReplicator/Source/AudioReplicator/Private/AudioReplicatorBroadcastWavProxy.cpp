@@ -0,0 +1,243 @@
+#include "AudioReplicatorBroadcastWavProxy.h"
+#include "AudioReplicatorComponent.h"
+#include "OpusCodecPool.h"
+#include "OpusPacketArena.h"
+#include "PcmWavUtils.h"
+#include "PcmResampler.h"
+#include "Async/Async.h"
+
+// Samples being encoded: the mapped data chunk when the file could be mapped, a loaded copy otherwise.
+struct FBroadcastWavSource
+{
+    PcmWav::FWavReader Reader;
+    TArray<int16> Copy;
+    TArrayView<const int16> Samples;
+    // Converts Samples to the header rate; a passthrough when Opus can encode the file's own rate.
+    FPcmResampler Resampler;
+};
+
+UAudioReplicatorBroadcastWavProxy* UAudioReplicatorBroadcastWavProxy::BroadcastWavAsync(UAudioReplicatorComponent* Component, const FString& WavPath, int32 Bitrate, int32 FrameMs)
+{
+    UAudioReplicatorBroadcastWavProxy* Proxy = NewObject<UAudioReplicatorBroadcastWavProxy>();
+    Proxy->Component = Component;
+    Proxy->WavPath = WavPath;
+    Proxy->Bitrate = Bitrate;
+    Proxy->FrameMs = FrameMs;
+    if (Component)
+    {
+        Proxy->RegisterWithGameInstance(Component);
+    }
+    return Proxy;
+}
+
+void UAudioReplicatorBroadcastWavProxy::Activate()
+{
+    UAudioReplicatorComponent* Comp = Component.Get();
+    if (!Comp || !Comp->IsOwnerClient())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("BroadcastWavAsync: must be called on owning client"));
+        Fail();
+        return;
+    }
+
+    FOpusStreamHeader Params;
+    Params.Bitrate = Bitrate;
+    Params.FrameMs = FrameMs;
+    Params.Profile = Comp->ClipEncoderProfile;
+    const bool bHash = Comp->bUseClipCache;
+    const PcmWav::FWavLoadOptions Options = Comp->GetWavLoadOptions();
+    const EAudioResampleQuality Quality = Comp->ResampleQuality;
+
+    TWeakObjectPtr<UAudioReplicatorBroadcastWavProxy> WeakThis(this);
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, Path = WavPath, Params, bHash, Options, Quality]() mutable
+    {
+        TSharedPtr<FBroadcastWavSource, ESPMode::ThreadSafe> Source = MakeShared<FBroadcastWavSource, ESPMode::ThreadSafe>();
+        bool bSuccess = Source->Reader.Open(Path, Options);
+        const int32 SR = Source->Reader.GetSampleRate();
+        const int32 Ch = Source->Reader.GetChannels();
+        if (bSuccess && Source->Reader.IsMapped())
+        {
+            Source->Samples = Source->Reader.GetMappedSamples();
+        }
+        else if (bSuccess)
+        {
+            // Not mappable, or converted on load: one chunked read into a copy, still without a file-sized staging buffer.
+            bSuccess = Source->Reader.GetNumSamples() <= MAX_int32;
+            if (bSuccess)
+            {
+                Source->Copy.SetNumUninitialized((int32)Source->Reader.GetNumSamples());
+                bSuccess = Source->Reader.ReadSamples(0, Source->Copy) == Source->Copy.Num();
+                Source->Samples = Source->Copy;
+            }
+            Source->Reader.Close();
+        }
+
+        const TArrayView<const int16> Pcm = Source->Samples;
+
+        const int32 EncodeSR = FOpusCodec::GetEncodeSampleRate(SR);
+        const int32 FrameSamplesPerCh = (EncodeSR / 1000) * Params.FrameMs;
+        bSuccess = bSuccess && Source->Resampler.Init(SR, EncodeSR, Ch, Quality);
+        if (bSuccess && (FrameSamplesPerCh <= 0 || Pcm.Num() < Ch))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("BroadcastWavAsync: nothing to encode in %s (SR=%d Ch=%d FrameMs=%d)"), *Path, SR, Ch, Params.FrameMs);
+            bSuccess = false;
+        }
+
+        if (bSuccess)
+        {
+            Params.SampleRate = EncodeSR;
+            Params.Channels = Ch;
+            Params.PreSkip = FOpusCodec::GetLookahead(EncodeSR, Params.Profile);
+            FOpusCodec::GetClipFrameCount(Source->Resampler.GetOutputFrames(Pcm.Num() / Ch), FrameSamplesPerCh, Params.PreSkip, Params.EndTrim);
+            if (bHash)
+            {
+                Params.ContentHash = UAudioReplicatorComponent::MakeContentHash(Params, MakeArrayView(reinterpret_cast<const uint8*>(Pcm.GetData()), Pcm.Num() * (int32)sizeof(int16)));
+            }
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, bSuccess, Params = MoveTemp(Params), Source = MoveTemp(Source)]() mutable
+        {
+            if (UAudioReplicatorBroadcastWavProxy* This = WeakThis.Get())
+            {
+                This->HandleLoaded(bSuccess, MoveTemp(Params), MoveTemp(Source));
+            }
+        });
+    });
+}
+
+void UAudioReplicatorBroadcastWavProxy::HandleLoaded(bool bSuccess, FOpusStreamHeader&& InHeader, TSharedPtr<FBroadcastWavSource, ESPMode::ThreadSafe> Source)
+{
+    UAudioReplicatorComponent* Comp = Component.Get();
+    if (!bSuccess || !Comp || !Comp->BeginStreamedClip(InHeader, SessionId))
+    {
+        Fail();
+        return;
+    }
+
+    Header = MoveTemp(InHeader);
+    const int32 FrameSamplesPerCh = (Header.SampleRate / 1000) * Header.FrameMs;
+    int32 EndTrim = 0;
+    TotalFrames = FOpusCodec::GetClipFrameCount(Source->Resampler.GetOutputFrames(Source->Samples.Num() / Header.Channels), FrameSamplesPerCh, Header.PreSkip, EndTrim);
+    OnStarted.Broadcast(SessionId, Header, 0.0f);
+
+    TWeakObjectPtr<UAudioReplicatorBroadcastWavProxy> WeakThis(this);
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, Cancelled = bCancelled, Params = Header, Source = MoveTemp(Source), FrameSamplesPerCh, Total = TotalFrames]()
+    {
+        // One encoder for the whole clip: blocks are contiguous, so there is no seam between them.
+        TSharedPtr<FOpusCodec> Codec = FOpusCodecPool::Get().AcquireEncoder(Params.SampleRate, Params.Channels, Params.Bitrate, Params.Profile);
+        const int32 SamplesPerFrameTotal = FrameSamplesPerCh * Params.Channels;
+        FPcmResampler& Resampler = Source->Resampler;
+
+        // Resampled sources are converted a block ahead of the encoder instead of all at once.
+        TArray<int16> Resampled;
+        int32 SourceOffset = 0;
+
+        int32 FramesDone = 0;
+        while (FramesDone < Total && !*Cancelled)
+        {
+            const int32 BlockFrames = FMath::Min(FramesPerBlock, Total - FramesDone);
+
+            // The last block runs past the samples; EncodeFramesToArena pads it with silence.
+            FOpusPacketArena Packets;
+            bool bOk = Codec.IsValid();
+            if (bOk && Resampler.IsPassthrough())
+            {
+                bOk = Codec->EncodeFramesToArena(Source->Samples, FrameSamplesPerCh, FramesDone, BlockFrames, Packets);
+            }
+            else if (bOk)
+            {
+                while (Resampled.Num() < BlockFrames * SamplesPerFrameTotal && SourceOffset < Source->Samples.Num())
+                {
+                    const int32 Take = FMath::Min(Source->Samples.Num() - SourceOffset, SamplesPerFrameTotal * FramesPerBlock);
+                    Resampler.Process(Source->Samples.Slice(SourceOffset, Take), Resampled);
+                    SourceOffset += Take;
+                    if (SourceOffset >= Source->Samples.Num())
+                    {
+                        Resampler.Flush(Resampled);
+                    }
+                }
+                bOk = Codec->EncodeFramesToArena(Resampled, FrameSamplesPerCh, 0, BlockFrames, Packets);
+                Resampled.RemoveAt(0, FMath::Min(Resampled.Num(), BlockFrames * SamplesPerFrameTotal), EAllowShrinking::No);
+            }
+            FramesDone += BlockFrames;
+            const bool bLast = FramesDone >= Total;
+
+            AsyncTask(ENamedThreads::GameThread, [WeakThis, bOk, Packets = MoveTemp(Packets), FramesDone, bLast]() mutable
+            {
+                if (UAudioReplicatorBroadcastWavProxy* This = WeakThis.Get())
+                {
+                    if (bOk)
+                    {
+                        This->HandleBlock(MoveTemp(Packets), FramesDone, bLast);
+                    }
+                    else
+                    {
+                        This->Fail();
+                    }
+                }
+            });
+
+            if (!bOk)
+                break;
+        }
+    });
+}
+
+void UAudioReplicatorBroadcastWavProxy::HandleBlock(FOpusPacketArena&& Packets, int32 FramesDone, bool bLast)
+{
+    if (bFinished)
+        return;
+
+    UAudioReplicatorComponent* Comp = Component.Get();
+    if (!Comp)
+    {
+        Fail();
+        return;
+    }
+
+    switch (Comp->AppendStreamedClipPackets(SessionId, Packets, bLast))
+    {
+    case UAudioReplicatorComponent::EStreamedClipAppend::Queued:
+        OnProgress.Broadcast(SessionId, Header, TotalFrames > 0 ? (float)FramesDone / TotalFrames : 1.0f);
+        if (bLast)
+        {
+            OnCompleted.Broadcast(SessionId, Header, 1.0f);
+            Finish();
+        }
+        break;
+
+    case UAudioReplicatorComponent::EStreamedClipAppend::ServedFromCache:
+        // The server relays its own copy; the rest of the clip need not be encoded.
+        OnCompleted.Broadcast(SessionId, Header, 1.0f);
+        Finish();
+        break;
+
+    default:
+        UE_LOG(LogTemp, Warning, TEXT("BroadcastWavAsync: session %s is gone"), *SessionId.ToString());
+        Fail();
+        break;
+    }
+}
+
+void UAudioReplicatorBroadcastWavProxy::Fail()
+{
+    if (bFinished)
+        return;
+
+    if (SessionId.IsValid())
+    {
+        if (UAudioReplicatorComponent* Comp = Component.Get())
+        {
+            Comp->CancelBroadcast(SessionId);
+        }
+    }
+    OnFailed.Broadcast(SessionId, Header, 0.0f);
+    Finish();
+}
+
+void UAudioReplicatorBroadcastWavProxy::Finish()
+{
+    bFinished = true;
+    *bCancelled = true;
+    SetReadyToDestroy();
+}
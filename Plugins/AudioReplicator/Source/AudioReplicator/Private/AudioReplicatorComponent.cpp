@@ -1,7 +1,114 @@
 #include "AudioReplicatorComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
 #include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
 #include "AudioReplicatorBPLibrary.h" // leverage local blueprint helpers for encoding/decoding
+#include "AudioReplicatorSubsystem.h"
+#include "OpusCodec.h"
+#include "OpusCodecPool.h"
+#include "Chunking.h"
+#include "PcmWavUtils.h"
+#include "Misc/SecureHash.h"
+#include "OpusJitterBuffer.h"
+#include "OpusSessionRecorder.h"
+#include "PcmDsp.h"
+#include "OpusParallelEncoder.h"
+#include "Sound/SoundWaveProcedural.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+    // How long chunks of an unknown session may keep arriving before a catch-up is requested;
+    // shorter gaps are just unreliable chunks overtaking their start message.
+    constexpr double CatchUpRequestDelaySec = 0.5;
+
+    // Unknown handles whose start message (or catch-up) has not come by then are given up on.
+    constexpr double UnresolvedHandleTimeoutSec = 10.0;
+
+    // How often the server re-evaluates who should hear running sessions.
+    constexpr double RecipientRefreshSec = 0.5;
+
+    // How long a clip offer may stay unanswered before the client uploads anyway.
+    constexpr double ClipOfferTimeoutSec = 5.0;
+
+    // Source hashes whose encoded frame hash a client remembers (KnownContentHashes).
+    constexpr int32 MaxKnownContentHashes = 256;
+
+    // Receiver: dropped incoming sessions remembered so that late chunks cannot bring them back.
+    constexpr int32 MaxClosedIncoming = 64;
+
+    // Frames one retransmission request may ask for, about 80 s of 20 ms frames.
+    constexpr int32 MaxRetransmitIndices = 4096;
+
+    // Missing ranges GetIncomingDebugInfo copies without bIncludeChunks.
+    constexpr int32 MaxSummaryMissingRanges = 16;
+
+    // Live frames this small are Opus DTX frames (or suppressed, empty ones) and are not sent.
+    constexpr int32 MaxSilentFrameBytes = 2;
+
+    // Adaptive bitrate feedback: receiver loss reports are combined (worst wins) over windows of this
+    // length, a relay congestion report counts for CongestionHoldSec, and the server sends at most one
+    // per session every CongestionReportIntervalSec.
+    constexpr double LossReportHoldSec = 2.0;
+    constexpr double CongestionHoldSec = 0.5;
+    constexpr double CongestionReportIntervalSec = 0.25;
+
+    // Longest session accepted. Packet counts and chunk indices from the network are checked against the
+    // frames it allows before anything is allocated for them.
+    constexpr int32 MaxSessionDurationSec = 60 * 60;
+
+    int32 GetMaxPacketsPerSession(int32 FrameMs)
+    {
+        // Header frame durations are whole milliseconds, so no valid Opus frame is shorter than 5 ms.
+        return FMath::DivideAndRoundUp(MaxSessionDurationSec * 1000, FMath::Clamp(FrameMs, 5, 120));
+    }
+
+    bool IsValidPacketCount(int32 NumPackets, int32 FrameMs)
+    {
+        return NumPackets >= 0 && NumPackets <= GetMaxPacketsPerSession(FrameMs);
+    }
+
+    // Where a player is in the world: the controlled pawn for controllers, the actor itself otherwise.
+    const AActor* GetPlayerLocationActor(const UAudioReplicatorComponent* Component)
+    {
+        const AActor* Owner = Component ? Component->GetOwner() : nullptr;
+        if (const APlayerController* PC = Cast<APlayerController>(Owner))
+        {
+            return PC->GetPawn();
+        }
+        return Owner;
+    }
+}
+
+FGuid UAudioReplicatorComponent::MakeContentHash(const FOpusStreamHeader& Header, TArrayView<const uint8> Content)
+{
+    const int32 Params[7] = { Header.SampleRate, Header.Channels, Header.Bitrate, Header.FrameMs, (int32)Header.Profile, Header.PreSkip, Header.EndTrim };
+
+    FMD5 Md5;
+    Md5.Update(reinterpret_cast<const uint8*>(Params), sizeof(Params));
+    Md5.Update(Content.GetData(), Content.Num());
+
+    uint8 Digest[16];
+    Md5.Final(Digest);
+
+    uint32 Words[4];
+    FMemory::Memcpy(Words, Digest, sizeof(Words));
+    return FGuid(Words[0], Words[1], Words[2], Words[3]);
+}
+
+FGuid UAudioReplicatorComponent::MakeContentHash(const FOpusStreamHeader& Header, const FOpusPacketArena& Packets)
+{
+    TArray<uint8> Packed;
+    Packed.Reserve((int32)Packets.GetRangeBytes(0, Packets.Num()) + 2 * Packets.Num());
+    for (int32 i = 0; i < Packets.Num(); ++i)
+    {
+        Chunking::AppendWithLength(Packets.GetPacket(i), Packed);
+    }
+    return MakeContentHash(Header, Packed);
+}
 
 UAudioReplicatorComponent::UAudioReplicatorComponent()
 {
@@ -12,6 +119,21 @@ UAudioReplicatorComponent::UAudioReplicatorComponent()
 void UAudioReplicatorComponent::BeginPlay()
 {
     Super::BeginPlay();
+
+    if (UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr)
+    {
+        Subsystem->RegisterComponent(this);
+    }
+}
+
+void UAudioReplicatorComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr)
+    {
+        Subsystem->UnregisterComponent(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 bool UAudioReplicatorComponent::IsOwnerClient() const
@@ -40,38 +162,6 @@ bool UAudioReplicatorComponent::IsOwnerClient() const
     return false;
 }
 
-void UAudioReplicatorComponent::BuildChunks(const TArray<FOpusPacket>& Packets, TArray<FOpusChunk>& OutChunks)
-{
-    OutChunks.Reset(Packets.Num());
-    int32 idx = 0;
-    for (const FOpusPacket& P : Packets)
-    {
-        FOpusChunk C;
-        C.Index = idx++;
-        C.Packet = P;
-        OutChunks.Add(MoveTemp(C));
-    }
-}
-
-bool UAudioReplicatorComponent::EncodeWavToOpusPackets(const FString& WavPath, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader) const
-{
-    int32 SR = 0, Ch = 0;
-    TArray<int32> Pcm;
-    if (!UAudioReplicatorBPLibrary::LoadWavToPcm16(WavPath, Pcm, SR, Ch))
-        return false;
-
-    OutHeader.SampleRate = SR;
-    OutHeader.Channels = Ch;
-    OutHeader.Bitrate = Bitrate;
-    OutHeader.FrameMs = FrameMs;
-
-    if (!UAudioReplicatorBPLibrary::EncodePcm16ToOpusPackets(Pcm, SR, Ch, Bitrate, FrameMs, OutPackets))
-        return false;
-
-    OutHeader.NumPackets = OutPackets.Num();
-    return true;
-}
-
 bool UAudioReplicatorComponent::StartBroadcastOpus(const TArray<FOpusPacket>& Packets, FOpusStreamHeader Header, FGuid& OutSessionId)
 {
     if (!IsOwnerClient())
@@ -84,299 +174,2834 @@ bool UAudioReplicatorComponent::StartBroadcastOpus(const TArray<FOpusPacket>& Pa
         UE_LOG(LogTemp, Warning, TEXT("StartBroadcastOpus: empty packet list"));
         return false;
     }
+    if (!IsValidPacketCount(Packets.Num(), Header.FrameMs))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("StartBroadcastOpus: %d packets exceed the %d s session limit"), Packets.Num(), MaxSessionDurationSec);
+        return false;
+    }
+    for (int32 i = 0; i < Packets.Num(); ++i)
+    {
+        if (2 + Packets[i].Data.Num() > FOpusChunkBatch::MaxPayloadBytes)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("StartBroadcastOpus: packet %d is too large for a chunk batch (%d bytes)"), i, Packets[i].Data.Num());
+            return false;
+        }
+    }
 
     FGuid SessionId = FGuid::NewGuid();
     OutSessionId = SessionId;
 
     FOutgoingTransfer Tr;
     Tr.SessionId = SessionId;
+    Tr.SessionHandle = AllocateSessionHandle();
     Tr.Header = Header;
     Tr.Header.NumPackets = Packets.Num();
-    BuildChunks(Packets, Tr.Chunks);
+    Tr.Header.bLive = false;
+    Tr.Packets.AddPackets(Packets);
 
-    Outgoing.Add(SessionId, MoveTemp(Tr));
-
-    // Send the header right away
-    Server_StartTransfer(SessionId, Header);
-    Outgoing[SessionId].bHeaderSent = true;
+    if (bUseClipCache && !Tr.Header.ContentHash.IsValid())
+    {
+        TArray<uint8> Packed;
+        Chunking::PackWithLengths(Packets, Packed);
+        Tr.Header.ContentHash = MakeContentHash(Tr.Header, Packed);
+    }
 
-    return true;
+    return BeginOutgoingClip(MoveTemp(Tr));
 }
 
 bool UAudioReplicatorComponent::StartBroadcastFromWav(const FString& WavPath, int32 Bitrate, int32 FrameMs, FGuid& OutSessionId)
 {
-    TArray<FOpusPacket> Packets;
-    FOpusStreamHeader Header;
-    if (!EncodeWavToOpusPackets(WavPath, Bitrate, FrameMs, Packets, Header))
+    if (!IsOwnerClient())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("StartBroadcastFromWav: must be called on owning client"));
         return false;
-    return StartBroadcastOpus(Packets, Header, OutSessionId);
-}
+    }
 
-void UAudioReplicatorComponent::CancelBroadcast(const FGuid& SessionId)
-{
-    if (FOutgoingTransfer* Tr = Outgoing.Find(SessionId))
+    // With the clip cache the PCM is hashed first; a file encoded before is offered by the hash of its
+    // frames and only encoded again if the server does not have the clip.
+    int32 SR = 0, Ch = 0;
+    TArray<int16> Pcm;
+    if (!PcmWav::LoadWavFileToPcm16(WavPath, Pcm, SR, Ch, GetWavLoadOptions()))
+        return false;
+
+    // Rates Opus cannot encode are resampled to AUDIO_REPL_OPUS_SR along with the encode.
+    const int32 EncodeSR = FOpusCodec::GetEncodeSampleRate(SR);
+    const int32 FrameSamplesPerCh = (EncodeSR / 1000) * FrameMs;
+    if (FrameSamplesPerCh <= 0 || Ch <= 0 || Pcm.Num() < Ch)
     {
-        // Send the end marker if it has not been sent yet
-        if (!Tr->bEndSent && Tr->bHeaderSent)
-        {
-            Server_EndTransfer(SessionId);
-            Tr->bEndSent = true;
-        }
-        Outgoing.Remove(SessionId);
+        UE_LOG(LogTemp, Warning, TEXT("StartBroadcastFromWav: nothing to encode in %s (SR=%d Ch=%d FrameMs=%d)"), *WavPath, SR, Ch, FrameMs);
+        return false;
     }
-}
 
-bool UAudioReplicatorComponent::GetReceivedPackets(const FGuid& SessionId, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader) const
-{
-    if (const FIncomingTransfer* In = Incoming.Find(SessionId))
+    FGuid SessionId = FGuid::NewGuid();
+    OutSessionId = SessionId;
+
+    FOutgoingTransfer Tr;
+    Tr.SessionId = SessionId;
+    Tr.SessionHandle = AllocateSessionHandle();
+    Tr.Header.SampleRate = EncodeSR;
+    Tr.Header.Channels = Ch;
+    Tr.Header.Bitrate = Bitrate;
+    Tr.Header.FrameMs = FrameMs;
+    Tr.Header.Profile = ClipEncoderProfile;
+    // The encoder pads the last frame; receivers trim the delay and the padding back off.
+    Tr.Header.PreSkip = FOpusCodec::GetLookahead(EncodeSR, Tr.Header.Profile);
+    const int64 EncodedFrames = FPcmResampler::GetOutputFrames(Pcm.Num() / Ch, SR, EncodeSR);
+    FOpusCodec::GetClipFrameCount(EncodedFrames, FrameSamplesPerCh, Tr.Header.PreSkip, Tr.Header.EndTrim);
+    Tr.SourceSampleRate = SR;
+    if (bUseClipCache)
     {
-        OutPackets = In->Packets;
-        OutHeader = In->Header;
-        return true;
-#if 0
-        // Optional: clear the cache after reading
-        Incoming.Remove(SessionId);
-#endif
+        Tr.SourceHash = MakeContentHash(Tr.Header, MakeArrayView(reinterpret_cast<const uint8*>(Pcm.GetData()), Pcm.Num() * (int32)sizeof(int16)));
     }
-    return false;
+    Tr.FrameSamplesPerCh = FrameSamplesPerCh;
+    Tr.PendingPcm = MoveTemp(Pcm);
+
+    return BeginOutgoingClip(MoveTemp(Tr));
 }
 
-bool UAudioReplicatorComponent::GetOutgoingDebugInfo(const FGuid& SessionId, FAudioReplicatorOutgoingDebug& OutDebug) const
+PcmWav::FWavLoadOptions UAudioReplicatorComponent::GetWavLoadOptions() const
 {
-    if (const FOutgoingTransfer* Tr = Outgoing.Find(SessionId))
-    {
-        OutDebug = FAudioReplicatorOutgoingDebug();
-        OutDebug.SessionId = SessionId;
-        OutDebug.Header = Tr->Header;
-        OutDebug.TotalChunks = Tr->Chunks.Num();
-        OutDebug.SentChunks = FMath::Clamp(Tr->NextIndex, 0, OutDebug.TotalChunks);
-        OutDebug.PendingChunks = FMath::Max(0, OutDebug.TotalChunks - OutDebug.SentChunks);
-        OutDebug.NextChunkIndex = FMath::Clamp(Tr->NextIndex, 0, OutDebug.TotalChunks);
-        OutDebug.bHeaderSent = Tr->bHeaderSent;
-        OutDebug.bEndSent = Tr->bEndSent;
+    PcmWav::FWavLoadOptions Options;
+    Options.Downmix = WavDownmix;
+    Options.bDither = bDitherWavSources;
+    return Options;
+}
 
-        OutDebug.Chunks.Reset(OutDebug.TotalChunks);
-        OutDebug.PendingChunkIndices.Reset();
+bool UAudioReplicatorComponent::BeginOutgoingClip(FOutgoingTransfer&& Tr)
+{
+    const FGuid SessionId = Tr.SessionId;
+    FOutgoingTransfer& Added = Outgoing.Add(SessionId, MoveTemp(Tr));
 
-        int32 TotalBytes = 0;
-        for (int32 i = 0; i < Tr->Chunks.Num(); ++i)
-        {
-            const FOpusChunk& Chunk = Tr->Chunks[i];
+    // The server keys its cache by the hash of the frames it received. A source hash still goes out
+    // in the header so the clip is cached, but it is only worth an offer once it maps to frames.
+    bool bOffer = Added.Header.ContentHash.IsValid();
+    if (bUseClipCache && Added.SourceHash.IsValid())
+    {
+        const FGuid* Known = KnownContentHashes.Find(Added.SourceHash);
+        Added.Header.ContentHash = Known ? *Known : Added.SourceHash;
+        bOffer = Known != nullptr;
+    }
 
-            FAudioReplicatorChunkDebug ChunkDebug;
-            ChunkDebug.Index = Chunk.Index;
-            ChunkDebug.SizeBytes = Chunk.Packet.Data.Num();
-            ChunkDebug.bIsSent = (i < Tr->NextIndex);
-            ChunkDebug.bIsReceived = false;
+    if (bUseClipCache && bOffer)
+    {
+        // Offer the hash first; the chunks only go out if the server does not have the clip yet.
+        Added.bAwaitingCacheReply = true;
+        Added.OfferTime = FPlatformTime::Seconds();
+        Server_OfferClip(SessionId, Added.SessionHandle, Added.Header);
+        return true;
+    }
 
-            TotalBytes += ChunkDebug.SizeBytes;
-            if (!ChunkDebug.bIsSent)
-            {
-                OutDebug.PendingChunkIndices.Add(ChunkDebug.Index);
-            }
+    if (!FinishClipOffer(Added))
+    {
+        Outgoing.Remove(SessionId);
+        return false;
+    }
+    return true;
+}
 
-            OutDebug.Chunks.Add(ChunkDebug);
-        }
+bool UAudioReplicatorComponent::FinishClipOffer(FOutgoingTransfer& Tr)
+{
+    Tr.bAwaitingCacheReply = false;
 
-        OutDebug.TotalBytes = TotalBytes;
-        OutDebug.EstimatedDurationSec = (Tr->Header.FrameMs > 0)
-            ? (OutDebug.TotalChunks * Tr->Header.FrameMs) / 1000.0f
-            : 0.0f;
+    if (Tr.PendingPcm.Num() > 0)
+    {
+        // Long clips would hitch the game thread; encode them in parallel segments in the background.
+        OpusParallelEncoder::FParams Params;
+        Params.SampleRate = Tr.Header.SampleRate;
+        Params.Channels = Tr.Header.Channels;
+        Params.Bitrate = Tr.Header.Bitrate;
+        Params.FrameSamplesPerCh = Tr.FrameSamplesPerCh;
+        Params.SourceSampleRate = Tr.SourceSampleRate;
+        Params.ResampleQuality = ResampleQuality;
+        Params.Profile = Tr.Header.Profile;
 
-        if (OutDebug.EstimatedDurationSec > 0.0f)
-        {
-            OutDebug.EstimatedBitrateKbps = (TotalBytes * 8.0f / OutDebug.EstimatedDurationSec) / 1000.0f;
-        }
-        else
+        Tr.bEncoding = true;
+        TWeakObjectPtr<UAudioReplicatorComponent> WeakThis(this);
+        const FGuid SessionId = Tr.SessionId;
+        OpusParallelEncoder::EncodeAsync(MoveTemp(Tr.PendingPcm), Params, [WeakThis, SessionId](bool bSuccess, FOpusPacketArena&& Packets)
         {
-            OutDebug.EstimatedBitrateKbps = 0.0f;
-        }
-
-        OutDebug.bTransferComplete = (OutDebug.TotalChunks > 0)
-            ? (OutDebug.SentChunks >= OutDebug.TotalChunks && Tr->bEndSent)
-            : Tr->bEndSent;
-
+            if (UAudioReplicatorComponent* This = WeakThis.Get())
+            {
+                This->HandleClipEncoded(SessionId, bSuccess, MoveTemp(Packets));
+            }
+        });
+        Tr.PendingPcm.Empty();
         return true;
     }
-    return false;
+
+    Server_StartTransfer(Tr.SessionId, Tr.SessionHandle, Tr.Header);
+    Tr.bHeaderSent = true;
+    return true;
 }
 
-bool UAudioReplicatorComponent::GetIncomingDebugInfo(const FGuid& SessionId, FAudioReplicatorIncomingDebug& OutDebug) const
+void UAudioReplicatorComponent::HandleClipEncoded(const FGuid& SessionId, bool bSuccess, FOpusPacketArena&& Packets)
 {
-    if (const FIncomingTransfer* In = Incoming.Find(SessionId))
-    {
-        OutDebug = FAudioReplicatorIncomingDebug();
-        OutDebug.SessionId = SessionId;
-        OutDebug.Header = In->Header;
-        OutDebug.bStarted = In->bStarted;
-        OutDebug.bEnded = In->bEnded;
-        OutDebug.ReceivedChunks = In->Received;
+    FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (!Tr || !Tr->bEncoding)
+        return; // cancelled while encoding
 
-        OutDebug.ExpectedChunks = (In->Header.NumPackets > 0) ? In->Header.NumPackets : 0;
-        const int32 DisplayChunkCount = (OutDebug.ExpectedChunks > 0) ? OutDebug.ExpectedChunks : In->Packets.Num();
+    Tr->bEncoding = false;
+    if (!bSuccess || Packets.Num() == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("HandleClipEncoded: failed to encode session %s"), *SessionId.ToString());
+        Outgoing.Remove(SessionId);
+        OnBroadcastEncoded.Broadcast(SessionId, false);
+        return;
+    }
 
-        OutDebug.Chunks.Reset(DisplayChunkCount);
-        OutDebug.MissingChunkIndices.Reset();
+    Tr->Packets = MoveTemp(Packets);
+    Tr->Header.NumPackets = Tr->Packets.Num();
+    RememberContentHash(*Tr);
+    Server_StartTransfer(SessionId, Tr->SessionHandle, Tr->Header);
+    Tr->bHeaderSent = true;
+    OnBroadcastEncoded.Broadcast(SessionId, true);
+}
 
-        int32 UniqueChunks = 0;
-        int32 TotalBytes = 0;
+void UAudioReplicatorComponent::RememberContentHash(FOutgoingTransfer& Tr)
+{
+    if (!bUseClipCache || !Tr.SourceHash.IsValid())
+        return;
 
-        for (int32 Index = 0; Index < DisplayChunkCount; ++Index)
-        {
-            FAudioReplicatorChunkDebug ChunkDebug;
-            ChunkDebug.Index = Index;
-            ChunkDebug.bIsSent = false;
-            ChunkDebug.bIsReceived = false;
+    const FGuid ContentHash = MakeContentHash(Tr.Header, Tr.Packets);
+    if (!KnownContentHashes.Contains(Tr.SourceHash) && KnownContentHashes.Num() >= MaxKnownContentHashes)
+    {
+        KnownContentHashes.Remove(KnownContentHashes.CreateConstIterator().Key());
+    }
+    KnownContentHashes.Add(Tr.SourceHash, ContentHash);
 
-            if (Index < In->Packets.Num())
-            {
-                const FOpusPacket& Packet = In->Packets[Index];
-                ChunkDebug.SizeBytes = Packet.Data.Num();
-                if (ChunkDebug.SizeBytes > 0)
-                {
-                    ChunkDebug.bIsReceived = true;
-                    ++UniqueChunks;
-                    TotalBytes += ChunkDebug.SizeBytes;
-                }
-            }
+    // A header that has not gone out yet carries the real key; a streamed clip's is already sent,
+    // and the server computes the key from the frames anyway.
+    if (!Tr.bHeaderSent)
+    {
+        Tr.Header.ContentHash = ContentHash;
+    }
+}
 
-            if (!ChunkDebug.bIsReceived && OutDebug.ExpectedChunks > 0)
-            {
-                OutDebug.MissingChunkIndices.Add(Index);
-            }
+bool UAudioReplicatorComponent::BeginStreamedClip(const FOpusStreamHeader& Header, FGuid& OutSessionId)
+{
+    if (!IsOwnerClient())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("BeginStreamedClip: must be called on owning client"));
+        return false;
+    }
 
-            OutDebug.Chunks.Add(ChunkDebug);
-        }
+    FGuid SessionId = FGuid::NewGuid();
+    OutSessionId = SessionId;
 
-        OutDebug.UniqueChunks = UniqueChunks;
-        OutDebug.TotalBytes = TotalBytes;
-        OutDebug.MissingChunks = (OutDebug.ExpectedChunks > 0)
-            ? FMath::Max(0, OutDebug.ExpectedChunks - UniqueChunks)
-            : 0;
+    FOutgoingTransfer Tr;
+    Tr.SessionId = SessionId;
+    Tr.SessionHandle = AllocateSessionHandle();
+    Tr.Header = Header;
+    Tr.Header.NumPackets = 0; // unknown until the last block
+    Tr.Header.bLive = false;
+    Tr.bStreaming = true;
+    if (bUseClipCache)
+    {
+        // BroadcastWavAsync hashes the source PCM; BeginOutgoingClip maps it to the frames encoded before.
+        Tr.SourceHash = Header.ContentHash;
+    }
 
-        OutDebug.EstimatedDurationSec = (In->Header.FrameMs > 0)
-            ? (UniqueChunks * In->Header.FrameMs) / 1000.0f
-            : 0.0f;
+    return BeginOutgoingClip(MoveTemp(Tr));
+}
 
-        if (OutDebug.EstimatedDurationSec > 0.0f)
-        {
-            OutDebug.EstimatedBitrateKbps = (TotalBytes * 8.0f / OutDebug.EstimatedDurationSec) / 1000.0f;
-        }
-        else
-        {
-            OutDebug.EstimatedBitrateKbps = 0.0f;
-        }
+UAudioReplicatorComponent::EStreamedClipAppend UAudioReplicatorComponent::AppendStreamedClipPackets(const FGuid& SessionId, const FOpusPacketArena& Packets, bool bLast)
+{
+    FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (!Tr || !Tr->bStreaming)
+        return EStreamedClipAppend::Gone;
 
-        OutDebug.bReadyToAssemble = OutDebug.bEnded && (OutDebug.ExpectedChunks == 0 || OutDebug.MissingChunks == 0);
+    if (Tr->bServedFromCache)
+    {
+        Outgoing.Remove(SessionId);
+        return EStreamedClipAppend::ServedFromCache;
+    }
 
-        return true;
+    Tr->Packets.AppendRange(Packets, 0, Packets.Num());
+    if (bLast)
+    {
+        // From here on it is a regular clip: PumpOutgoing sends the end marker once everything is out.
+        Tr->bStreaming = false;
+        Tr->Header.NumPackets = Tr->Packets.Num();
+        RememberContentHash(*Tr);
     }
-    return false;
+    return EStreamedClipAppend::Queued;
 }
 
-void UAudioReplicatorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+bool UAudioReplicatorComponent::OpenStreamSession(int32 SampleRate, int32 Channels, int32 Bitrate, int32 FrameMs, FGuid& OutSessionId)
 {
-    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-    if (!IsOwnerClient()) return;
+    if (!IsOwnerClient())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("OpenStreamSession: must be called on owning client"));
+        return false;
+    }
 
-    // Pump outgoing queues
-    TArray<FGuid> ToFinish;
-    for (auto& KV : Outgoing)
+    const int32 EncodeSR = FOpusCodec::GetEncodeSampleRate(SampleRate);
+    const int32 FrameSamplesPerCh = (EncodeSR / 1000) * FrameMs;
+    if (FrameSamplesPerCh <= 0 || Channels <= 0 || SampleRate <= 0)
     {
-        FOutgoingTransfer& Tr = KV.Value;
-        if (!Tr.bHeaderSent)
-            continue;
+        UE_LOG(LogTemp, Warning, TEXT("OpenStreamSession: bad params SR=%d Ch=%d FrameMs=%d"), SampleRate, Channels, FrameMs);
+        return false;
+    }
 
-        int32 SentThisTick = 0;
-        while (Tr.NextIndex < Tr.Chunks.Num() && SentThisTick < MaxPacketsPerTick)
-        {
-            Server_SendChunk(Tr.SessionId, Tr.Chunks[Tr.NextIndex]);
-            Tr.NextIndex++;
-            SentThisTick++;
-        }
+    TSharedPtr<FOpusCodec> Codec = FOpusCodecPool::Get().AcquireEncoder(EncodeSR, Channels, Bitrate, LiveEncoderProfile);
+    if (!Codec.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("OpenStreamSession: failed to create codec SR=%d Ch=%d"), EncodeSR, Channels);
+        return false;
+    }
+    Codec->SetPacketLossPercent(ExpectedPacketLossPercent);
+    // The Opus VAD only reports through DTX, so it runs for both gated modes.
+    Codec->SetDtx(SilenceMode != EAudioSilenceMode::SendAll);
 
-        if (Tr.NextIndex >= Tr.Chunks.Num() && !Tr.bEndSent)
-        {
-            Server_EndTransfer(Tr.SessionId);
-            Tr.bEndSent = true;
-            ToFinish.Add(Tr.SessionId);
-        }
+    // Capture devices often run at 44.1 kHz; pushed PCM is converted before it reaches the encoder.
+    TSharedPtr<FPcmResampler> Resampler;
+    if (EncodeSR != SampleRate)
+    {
+        Resampler = MakeShared<FPcmResampler>();
+        if (!Resampler->Init(SampleRate, EncodeSR, Channels, ResampleQuality))
+            return false;
     }
 
-    for (const FGuid& S : ToFinish)
+    FGuid SessionId = FGuid::NewGuid();
+    OutSessionId = SessionId;
+
+    FOutgoingTransfer Tr;
+    Tr.SessionId = SessionId;
+    Tr.SessionHandle = AllocateSessionHandle();
+    Tr.Header.SampleRate = EncodeSR;
+    Tr.Header.Channels = Channels;
+    Tr.Header.Bitrate = Bitrate;
+    Tr.Header.FrameMs = FrameMs;
+    Tr.Header.NumPackets = 0; // unknown until the session is closed
+    Tr.Header.bLive = true;
+    Tr.Header.Profile = LiveEncoderProfile;
+    Tr.Header.PreSkip = FOpusCodec::GetLookahead(EncodeSR, LiveEncoderProfile);
+    Tr.Codec = MoveTemp(Codec);
+    Tr.FrameSamplesPerCh = FrameSamplesPerCh;
+    Tr.SourceSampleRate = SampleRate;
+    Tr.Resampler = MoveTemp(Resampler);
+    Tr.SilenceMode = SilenceMode;
+    Tr.Vad.Configure(VoiceActivityThreshold, FMath::DivideAndRoundUp(FMath::Max(0, VoiceHangoverMs), FrameMs));
+    if (bAdaptiveBitrate)
     {
-        Outgoing.Remove(S);
+        Tr.RateControl.Configure(MinAdaptiveBitrate, Bitrate, ExpectedPacketLossPercent, MaxAdaptiveLossPercent, FrameMs);
     }
-}
 
-// ================= SERVER RPC =================
+    FOutgoingTransfer& Added = Outgoing.Add(SessionId, MoveTemp(Tr));
 
-void UAudioReplicatorComponent::Server_StartTransfer_Implementation(const FGuid& SessionId, const FOpusStreamHeader& Header)
-{
-    Multicast_StartTransfer(SessionId, Header);
-}
+    Server_StartTransfer(SessionId, Added.SessionHandle, Added.Header);
+    Added.bHeaderSent = true;
 
-void UAudioReplicatorComponent::Server_SendChunk_Implementation(const FGuid& SessionId, const FOpusChunk& Chunk)
-{
-    Multicast_SendChunk(SessionId, Chunk);
+    return true;
 }
 
-void UAudioReplicatorComponent::Server_EndTransfer_Implementation(const FGuid& SessionId)
+bool UAudioReplicatorComponent::PushStreamPcm(const FGuid& SessionId, const TArray<int32>& Pcm16)
 {
-    Multicast_EndTransfer(SessionId);
+    TArray<int16> Pcm16s;
+    Pcm16s.SetNumUninitialized(Pcm16.Num());
+    PcmDsp::Int32ToInt16(Pcm16.GetData(), Pcm16s.GetData(), Pcm16.Num());
+    return PushStreamPcm16(SessionId, Pcm16s);
 }
 
-// ================= MULTICAST RPC =================
-
-void UAudioReplicatorComponent::Multicast_StartTransfer_Implementation(const FGuid& SessionId, const FOpusStreamHeader& Header)
+bool UAudioReplicatorComponent::PushStreamPcmBuffer(const FGuid& SessionId, const UAudioPcmBuffer* Buffer)
 {
-    FIncomingTransfer& In = Incoming.FindOrAdd(SessionId);
-    In.Header = Header;
-    In.Packets.Reset(Header.NumPackets > 0 ? Header.NumPackets : 0);
-    In.Received = 0;
-    In.bStarted = true;
-    In.bEnded = false;
+    if (!Buffer)
+        return false;
 
-    OnTransferStarted.Broadcast(SessionId, Header);
+    const FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (Tr && (Buffer->GetSampleRate() != Tr->SourceSampleRate || Buffer->GetChannels() != Tr->Header.Channels))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("PushStreamPcmBuffer: buffer is %d Hz x%d, session %s expects %d Hz x%d"),
+            Buffer->GetSampleRate(), Buffer->GetChannels(), *SessionId.ToString(), Tr->SourceSampleRate, Tr->Header.Channels);
+        return false;
+    }
+    return PushStreamPcm16(SessionId, Buffer->GetSamples());
 }
 
-void UAudioReplicatorComponent::Multicast_SendChunk_Implementation(const FGuid& SessionId, const FOpusChunk& Chunk)
+bool UAudioReplicatorComponent::PushStreamPcm16(const FGuid& SessionId, TArrayView<const int16> Pcm16)
 {
-    FIncomingTransfer& In = Incoming.FindOrAdd(SessionId);
-    if (!In.bStarted)
+    FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (!Tr || !Tr->Header.bLive || !Tr->Codec.IsValid() || Tr->bEndSent)
     {
-        // Safety guard: mark the transfer as started even if the header went missing
-        In.bStarted = true;
+        UE_LOG(LogTemp, Warning, TEXT("PushStreamPcm: no open live session %s"), *SessionId.ToString());
+        return false;
     }
 
-    // Ensure the array has enough room
-    if (In.Header.NumPackets > 0 && In.Packets.Num() < In.Header.NumPackets)
-        In.Packets.SetNum(In.Header.NumPackets);
+    const int32 SamplesPerFrameTotal = Tr->FrameSamplesPerCh * Tr->Header.Channels;
+    const int32 AppendAt = Tr->PendingPcm.Num();
+    if (Tr->Resampler.IsValid())
+    {
+        Tr->Resampler->Process(Pcm16, Tr->PendingPcm);
+    }
+    else
+    {
+        Tr->PendingPcm.Append(Pcm16.GetData(), Pcm16.Num());
+    }
+    PcmDsp::ApplyGain(Tr->PendingPcm.GetData() + AppendAt, Tr->PendingPcm.Num() - AppendAt, FMath::Max(0.0f, InputGain));
+
+    // Encode every complete frame now; the remainder waits for the next push. The network is read once
+    // per push, the bitrate controller still steps once per frame.
+    const FAudioBitrateController::FConditions Conditions = GetSendConditions(*Tr, FPlatformTime::Seconds());
+    int32 Offset = 0;
+    while (Offset + SamplesPerFrameTotal <= Tr->PendingPcm.Num())
+    {
+        if (!IsValidPacketCount(Tr->ReleasedChunks + Tr->Packets.Num() + 1, Tr->Header.FrameMs))
+        {
+            // Receivers drop frames past the limit; the caller has to close the session and open a new one.
+            UE_LOG(LogTemp, Warning, TEXT("PushStreamPcm: session %s reached the %d s limit"), *SessionId.ToString(), MaxSessionDurationSec);
+            Tr->PendingPcm.RemoveAt(0, Offset, EAllowShrinking::No);
+            return false;
+        }
+        if (Tr->RateControl.Update(Conditions))
+        {
+            Tr->Codec->SetBitrate(Tr->RateControl.GetBitrate());
+            Tr->Codec->SetPacketLossPercent(Tr->RateControl.GetLossPercent());
+        }
+        if (!EncodeLiveFrame(*Tr, Tr->PendingPcm.GetData() + Offset))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("PushStreamPcm: encode failed at frame %d"), Tr->ReleasedChunks + Tr->Packets.Num());
+            Tr->PendingPcm.RemoveAt(0, Offset, EAllowShrinking::No);
+            return false;
+        }
+        Offset += SamplesPerFrameTotal;
+    }
+    Tr->PendingPcm.RemoveAt(0, Offset, EAllowShrinking::No);
+
+    // Without priority the frames wait for their share of the pacer budget in the next tick.
+    if (bPrioritizeLiveSessions)
+    {
+        FlushLiveTransfer(*Tr);
+    }
+    return true;
+}
+
+FAudioBitrateController::FConditions UAudioReplicatorComponent::GetSendConditions(const FOutgoingTransfer& Tr, double Now) const
+{
+    FAudioBitrateController::FConditions Conditions;
+    Conditions.QueuedFrames = Tr.Packets.Num() - Tr.NextIndex;
+
+    // Live frames bypass the pacer and overdraw it, so a debt means the budget is oversubscribed.
+    const FAudioReplicatorPacer& ConnectionPacer = GetPacer();
+    const bool bPacerInDebt = ConnectionPacer.GetBudgetBytesPerSec() > 0 && ConnectionPacer.GetAvailableBytes() < 0;
+    const bool bRelayCongested = Tr.CongestionReportTime >= 0.0 && Now - Tr.CongestionReportTime < CongestionHoldSec;
+    Conditions.bSaturated = bPacerInDebt || bRelayCongested || IsConnectionSaturated(GetOwner() ? GetOwner()->GetNetConnection() : nullptr);
+
+    if (Tr.LossReportTime >= 0.0 && Now - Tr.LossReportTime < 2.0 * LossReportHoldSec)
+    {
+        Conditions.LossPercent = Tr.ReportedLossPercent;
+    }
+    return Conditions;
+}
+
+bool UAudioReplicatorComponent::IsConnectionSaturated(UNetConnection* Connection)
+{
+    return Connection && !Connection->IsNetReady(false);
+}
+
+bool UAudioReplicatorComponent::EncodeLiveFrame(FOutgoingTransfer& Tr, const int16* FramePcm)
+{
+    if (Tr.SilenceMode == EAudioSilenceMode::SendAll)
+    {
+        return Tr.Codec->EncodeFrameToArena(FramePcm, Tr.FrameSamplesPerCh, Tr.Packets);
+    }
+
+    // Background noise under the threshold is encoded as digital silence while the gate is closed,
+    // so the Opus VAD settles into DTX instead of coding the noise.
+    const int32 FrameSamples = Tr.FrameSamplesPerCh * Tr.Header.Channels;
+    const bool bAboveThreshold = Tr.Vad.IsAboveThreshold(FramePcm, FrameSamples);
+    const int16* Input = FramePcm;
+    if (!bAboveThreshold && !Tr.Vad.IsActive())
+    {
+        Tr.SilentFrame.SetNumZeroed(FrameSamples);
+        Input = Tr.SilentFrame.GetData();
+    }
+
+    if (!Tr.Codec->EncodeFrameToArena(Input, Tr.FrameSamplesPerCh, Tr.Packets))
+        return false;
+
+    if (!Tr.Vad.Update(bAboveThreshold, Tr.Codec->IsInDtx()))
+    {
+        if (Tr.SilenceMode == EAudioSilenceMode::Suppress)
+        {
+            // Replaced by an empty frame: nothing is sent for it, but it keeps its index and its time.
+            Tr.Packets.RemoveLast();
+            Tr.Packets.AddPacket(TArrayView<const uint8>());
+            ++Tr.FramesSuppressed;
+        }
+        else if (Tr.Packets.GetPacketSize(Tr.Packets.Num() - 1) <= MaxSilentFrameBytes)
+        {
+            // Dtx: counted once the encoder actually codes the frame as DTX; until it settles the
+            // gated frames still go out at full size.
+            ++Tr.FramesSuppressed;
+        }
+    }
+    return true;
+}
+
+void UAudioReplicatorComponent::CloseStreamSession(const FGuid& SessionId)
+{
+    FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (!Tr || !Tr->Header.bLive)
+    {
+        return;
+    }
+
+    // Encode what is still buffered, padded with silence far enough for the encoder delay to come out.
+    if (!Tr->bEndSent && Tr->Codec.IsValid())
+    {
+        if (Tr->Resampler.IsValid())
+        {
+            const int32 AppendAt = Tr->PendingPcm.Num();
+            Tr->Resampler->Flush(Tr->PendingPcm);
+            PcmDsp::ApplyGain(Tr->PendingPcm.GetData() + AppendAt, Tr->PendingPcm.Num() - AppendAt, FMath::Max(0.0f, InputGain));
+        }
+        if (Tr->ReleasedChunks + Tr->Packets.Num() > 0 || Tr->PendingPcm.Num() > 0)
+        {
+            int32 EndTrim = 0;
+            const int32 TailFrames = FOpusCodec::GetClipFrameCount(Tr->PendingPcm.Num() / Tr->Header.Channels, Tr->FrameSamplesPerCh, Tr->Header.PreSkip, EndTrim);
+            Tr->Codec->EncodeFramesToArena(Tr->PendingPcm, Tr->FrameSamplesPerCh, 0, FMath::Max(1, TailFrames), Tr->Packets);
+        }
+        Tr->PendingPcm.Reset();
+    }
+    FlushLiveTransfer(*Tr);
+    if (Tr->bHeaderSent && !Tr->bEndSent)
+    {
+        Server_EndTransfer(SessionId, Tr->ReleasedChunks);
+        Tr->bEndSent = true;
+    }
+    Outgoing.Remove(SessionId);
+}
+
+void UAudioReplicatorComponent::FlushLiveTransfer(FOutgoingTransfer& Tr)
+{
+    if (!Tr.bHeaderSent)
+        return;
+
+    // Voice is latency bound: it goes out now and the pacer makes bulk transfers pay for it.
+    GetPacer().Refill(FPlatformTime::Seconds());
+    const bool bReliable = (Transport == EAudioReplicatorTransport::Reliable);
+    Tr.NextIndex += SendChunkBatches(Tr, Tr.NextIndex, Tr.Packets.Num() - Tr.NextIndex, INDEX_NONE, bReliable);
+    ReleaseSentLiveChunks(Tr);
+}
+
+FAudioReplicatorPacer& UAudioReplicatorComponent::GetPacer()
+{
+    UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+    return Subsystem ? Subsystem->GetConnectionPacer(GetOwner() ? GetOwner()->GetNetConnection() : nullptr) : Pacer;
+}
+
+const FAudioReplicatorPacer& UAudioReplicatorComponent::GetPacer() const
+{
+    const UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+    const FAudioReplicatorPacer* Found = Subsystem ? Subsystem->FindConnectionPacer(GetOwner() ? GetOwner()->GetNetConnection() : nullptr) : nullptr;
+    return Found ? *Found : Pacer;
+}
+
+void UAudioReplicatorComponent::ReleaseSentLiveChunks(FOutgoingTransfer& Tr)
+{
+    if (Tr.NextIndex <= 0)
+        return;
+
+    Tr.ReleasedBytes += (int32)Tr.Packets.GetRangeBytes(0, Tr.NextIndex);
+
+    // Sent chunks are not needed anymore; keep the live queue from growing with the session length.
+    Tr.ReleasedChunks += Tr.NextIndex;
+    Tr.Packets.RemoveFront(Tr.NextIndex);
+    Tr.NextIndex = 0;
+}
+
+uint16 UAudioReplicatorComponent::AllocateSessionHandle()
+{
+    // Wraps after 65535 sessions; by then the old binding is long gone on every peer.
+    ++LastSessionHandle;
+    if (LastSessionHandle == 0)
+    {
+        LastSessionHandle = 1;
+    }
+    return LastSessionHandle;
+}
+
+int32 UAudioReplicatorComponent::SendChunkBatches(FOutgoingTransfer& Tr, int32 FirstArrayIndex, int32 MaxChunks, int32 MaxBatches, bool bReliable)
+{
+    const int32 EndArrayIndex = FMath::Min(Tr.Packets.Num(), FirstArrayIndex + FMath::Max(0, MaxChunks));
+    const int32 Budget = FMath::Clamp(MaxBatchBytes, 64, FOpusChunkBatch::MaxPayloadBytes);
+
+    FOpusChunkBatch Batch;
+    Batch.SessionHandle = Tr.SessionHandle;
+    Batch.Payload.Reserve(Budget);
+
+    FAudioReplicatorPacer& ConnectionPacer = GetPacer();
+    int32 BatchesSent = 0;
+    auto SendBatch = [this, &ConnectionPacer, &Batch, &BatchesSent, bReliable]()
+    {
+        // Charged with a rough estimate of the handle/index/length prefix on top of the payload.
+        ConnectionPacer.Consume(Batch.Payload.Num() + 8);
+        ++BatchesSent;
+        if (bReliable)
+        {
+            Server_SendChunkBatch(Batch);
+        }
+        else
+        {
+            Server_SendChunkBatchUnreliable(Batch);
+        }
+        Batch.Payload.Reset();
+    };
+
+    int32 Sent = 0;
+    for (int32 i = FirstArrayIndex; i < EndArrayIndex; ++i)
+    {
+        TArrayView<const uint8> Packet = Tr.Packets.GetPacket(i);
+
+        // Live silence (DTX frames and frames the gate suppressed) is not sent. The first frame of a run
+        // goes out empty as a marker, so receivers play the run as silence instead of counting it as loss.
+        const bool bSilent = Tr.Header.bLive && Tr.SilenceMode != EAudioSilenceMode::SendAll && Packet.Num() <= MaxSilentFrameBytes;
+        if (bSilent)
+        {
+            Packet = TArrayView<const uint8>();
+        }
+        const int32 Cost = 2 + Packet.Num();
+
+        const bool bTooLarge = Cost > FOpusChunkBatch::MaxPayloadBytes;
+        if (bTooLarge || (bSilent && Tr.bSilenceMarked))
+        {
+            // Not sent. It counts as sent so the transfer still finishes; the batch is cut here so the
+            // following frames keep their indices. Receivers conceal a frame that could not be represented.
+            if (bTooLarge)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("SendChunkBatches: skipped frame %d of %d bytes"), Tr.ReleasedChunks + i, Packet.Num());
+            }
+            if (Batch.Payload.Num() > 0)
+            {
+                SendBatch();
+            }
+            ++Sent;
+            if (MaxBatches != INDEX_NONE && BatchesSent >= MaxBatches)
+            {
+                break;
+            }
+            continue;
+        }
+
+        // Start a new batch when the frame does not fit the budget; a lone oversized frame still goes out alone.
+        if (Batch.Payload.Num() > 0 && Batch.Payload.Num() + Cost > Budget)
+        {
+            SendBatch();
+            if (MaxBatches != INDEX_NONE && BatchesSent >= MaxBatches)
+            {
+                break;
+            }
+        }
+        if (Batch.Payload.Num() == 0)
+        {
+            Batch.FirstIndex = Tr.ReleasedChunks + i;
+        }
+        Chunking::AppendWithLength(Packet, Batch.Payload);
+        Tr.bSilenceMarked = bSilent;
+        ++Sent;
+    }
+
+    if (Batch.Payload.Num() > 0)
+    {
+        SendBatch();
+    }
+    return Sent;
+}
+
+void UAudioReplicatorComponent::CancelBroadcast(const FGuid& SessionId)
+{
+    if (FOutgoingTransfer* Tr = Outgoing.Find(SessionId))
+    {
+        // Send the end marker if it has not been sent yet; only the chunks sent so far count
+        if (!Tr->bEndSent && Tr->bHeaderSent)
+        {
+            Server_EndTransfer(SessionId, Tr->ReleasedChunks + Tr->NextIndex);
+            Tr->bEndSent = true;
+        }
+        Outgoing.Remove(SessionId);
+    }
+}
+
+bool UAudioReplicatorComponent::GetReceivedPackets(const FGuid& SessionId, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader) const
+{
+    if (const FIncomingTransfer* In = Incoming.Find(SessionId))
+    {
+        In->LastUseTime = FPlatformTime::Seconds();
+        OutPackets = In->Packets;
+        OutHeader = In->Header;
+        return true;
+    }
+    return false;
+}
+
+bool UAudioReplicatorComponent::GetReceivedPacketsView(const FGuid& SessionId, TArrayView<const FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader) const
+{
+    if (const FIncomingTransfer* In = Incoming.Find(SessionId))
+    {
+        In->LastUseTime = FPlatformTime::Seconds();
+        OutPackets = In->Packets;
+        OutHeader = In->Header;
+        return true;
+    }
+    OutPackets = TArrayView<const FOpusPacket>();
+    return false;
+}
+
+bool UAudioReplicatorComponent::ReleaseIncomingSession(const FGuid& SessionId)
+{
+    FIncomingTransfer* In = Incoming.Find(SessionId);
+    if (!In)
+        return false;
+
+    if (In->Recorder.IsValid())
+    {
+        FinishRecording(SessionId, *In, 0);
+    }
+    RemoveIncoming(SessionId);
+    return true;
+}
+
+void UAudioReplicatorComponent::GetIncomingStoreStats(FAudioReplicatorIncomingStoreStats& OutStats) const
+{
+    OutStats = FAudioReplicatorIncomingStoreStats();
+    OutStats.NumSessions = Incoming.Num();
+    OutStats.Bytes = IncomingBytes;
+    OutStats.MaxBytes = MaxIncomingBytes;
+    OutStats.Expired = IncomingExpired;
+    OutStats.Evictions = IncomingEvictions;
+    OutStats.LiveChunksTrimmed = IncomingLiveChunksTrimmed;
+}
+
+void UAudioReplicatorComponent::RemoveIncoming(const FGuid& SessionId)
+{
+    if (const FIncomingTransfer* In = Incoming.Find(SessionId))
+    {
+        IncomingBytes -= In->Bytes;
+        Incoming.Remove(SessionId);
+        ForgetSessionHandles(SessionId);
+
+        if (ClosedIncoming.Num() >= MaxClosedIncoming)
+        {
+            ClosedIncoming.Remove(*ClosedIncoming.CreateConstIterator());
+        }
+        ClosedIncoming.Add(SessionId);
+    }
+}
+
+void UAudioReplicatorComponent::GrowIncomingPackets(FIncomingTransfer& In, int32 Num)
+{
+    if (In.Packets.Num() >= Num)
+        return;
+
+    // Each slot costs its FOpusPacket even while empty, which is most of a long live session's index.
+    const int64 DeltaBytes = (int64)(Num - In.Packets.Num()) * sizeof(FOpusPacket);
+    In.Packets.SetNum(Num);
+    In.Bytes += DeltaBytes;
+    IncomingBytes += DeltaBytes;
+}
+
+void UAudioReplicatorComponent::ForgetSessionHandles(const FGuid& SessionId)
+{
+    // A sender reuses handles after 65535 sessions, so only entries still bound to this session go.
+    for (auto It = SessionHandles.CreateIterator(); It; ++It)
+    {
+        if (It.Value() == SessionId)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+USoundWave* UAudioReplicatorComponent::GetIncomingPlaybackWave(const FGuid& SessionId) const
+{
+    const FIncomingTransfer* In = Incoming.Find(SessionId);
+    return In ? In->PlaybackWave.Get() : nullptr;
+}
+
+bool UAudioReplicatorComponent::StartRecordingSession(const FGuid& SessionId, const FString& WavPath)
+{
+    FIncomingTransfer* In = Incoming.Find(SessionId);
+    if (!In || !In->bStarted)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("StartRecordingSession: unknown session %s"), *SessionId.ToString());
+        return false;
+    }
+    if (In->Recorder.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("StartRecordingSession: session %s is already being recorded"), *SessionId.ToString());
+        return false;
+    }
+
+    // Live sessions joined late start at their first received chunk instead of concealing from zero.
+    int32 FirstIndex = INDEX_NONE;
+    if (!In->Header.bLive || (In->Packets.Num() > 0 && In->Packets[0].Data.Num() > 0))
+    {
+        FirstIndex = 0;
+    }
+
+    TSharedPtr<FOpusSessionRecorder> Recorder = MakeShared<FOpusSessionRecorder>();
+    if (!Recorder->Open(WavPath, In->Header, FirstIndex))
+        return false;
+
+    // A live history has silences the sender never sent; a run without packets is written as one,
+    // which sounds the same as concealing a loss and does not trip the recorder's jump limit.
+    int32 EmptyFrom = INDEX_NONE;
+    bool bAnyInserted = false;
+    for (int32 Index = 0; Index < In->Packets.Num(); ++Index)
+    {
+        const TArray<uint8>& Data = In->Packets[Index].Data;
+        if (Data.Num() == 0)
+        {
+            EmptyFrom = (EmptyFrom == INDEX_NONE) ? Index : EmptyFrom;
+            continue;
+        }
+        if (In->Header.bLive && bAnyInserted && EmptyFrom != INDEX_NONE)
+        {
+            Recorder->InsertSilence(EmptyFrom, Index);
+        }
+        EmptyFrom = INDEX_NONE;
+        bAnyInserted = true;
+        Recorder->Insert(Index, Data);
+    }
+    In->Recorder = MoveTemp(Recorder);
+
+    if (In->bEnded)
+    {
+        return FinishRecording(SessionId, *In, In->Header.NumPackets);
+    }
+    return true;
+}
+
+bool UAudioReplicatorComponent::StopRecordingSession(const FGuid& SessionId)
+{
+    FIncomingTransfer* In = Incoming.Find(SessionId);
+    if (!In || !In->Recorder.IsValid())
+        return false;
+
+    return FinishRecording(SessionId, *In, 0);
+}
+
+bool UAudioReplicatorComponent::FinishRecording(const FGuid& SessionId, FIncomingTransfer& In, int32 NumPackets)
+{
+    const TSharedPtr<FOpusSessionRecorder> Recorder = MoveTemp(In.Recorder);
+    In.RecordingDeadline = 0.0;
+    const FString Path = Recorder->GetPath();
+    const bool bSuccess = Recorder->Finish(NumPackets);
+    OnRecordingFinished.Broadcast(SessionId, Path, bSuccess);
+    return bSuccess;
+}
+
+bool UAudioReplicatorComponent::GetIncomingJitterStats(const FGuid& SessionId, FAudioReplicatorJitterStats& OutStats) const
+{
+    const FIncomingTransfer* In = Incoming.Find(SessionId);
+    if (!In || !In->Jitter.IsValid())
+        return false;
+
+    const FOpusJitterBuffer::FStats Stats = In->Jitter->GetStats();
+    OutStats = FAudioReplicatorJitterStats();
+    OutStats.SessionId = SessionId;
+    OutStats.Underruns = Stats.Underruns;
+    OutStats.Overruns = Stats.Overruns;
+    OutStats.LateDrops = Stats.LateDrops;
+    OutStats.FramesDecoded = Stats.FramesDecoded;
+    OutStats.FramesConcealed = Stats.FramesConcealed;
+    OutStats.FramesRecoveredFec = Stats.FramesRecoveredFec;
+    OutStats.FramesSilent = Stats.FramesSilent;
+    OutStats.TargetDepthMs = Stats.TargetDepthMs;
+    OutStats.CurrentDepthMs = Stats.DepthMs;
+    OutStats.bPlaybackFinished = In->bPlaybackFinished;
+    return true;
+}
+
+void UAudioReplicatorComponent::StartLivePlayback(FIncomingTransfer& In)
+{
+    if (!bEnableLivePlayback || GetNetMode() == NM_DedicatedServer || In.Jitter.IsValid())
+        return;
+
+    const FOpusStreamHeader& H = In.Header;
+    TSharedPtr<FOpusJitterBuffer> Jitter = MakeShared<FOpusJitterBuffer>(H.SampleRate, H.Channels, H.FrameMs, JitterMinDepthMs, JitterMaxDepthMs, H.bLive);
+    if (!Jitter->IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("StartLivePlayback: failed to create decoder SR=%d Ch=%d"), H.SampleRate, H.Channels);
+        return;
+    }
+
+    // A replay of a session still held starts with the frames already here.
+    for (int32 Index = 0; Index < In.Packets.Num(); ++Index)
+    {
+        Jitter->Insert(Index, In.Packets[Index].Data);
+    }
+
+    USoundWaveProcedural* Wave = NewObject<USoundWaveProcedural>(this);
+    Wave->SetSampleRate(H.SampleRate);
+    Wave->NumChannels = H.Channels;
+    Wave->Duration = INDEFINITELY_LOOPING_DURATION;
+    Wave->SoundGroup = SOUNDGROUP_Voice;
+    Wave->bLooping = false;
+
+    In.Jitter = MoveTemp(Jitter);
+    In.PlaybackWave = Wave;
+    In.bPlaybackFinished = false;
+}
+
+void UAudioReplicatorComponent::PumpLivePlayback(float DeltaTime)
+{
+    TArray<int16> FramePcm;
+    for (auto& KV : Incoming)
+    {
+        FIncomingTransfer& In = KV.Value;
+        if (!In.Jitter.IsValid() || !In.PlaybackWave || In.bPlaybackFinished)
+            continue;
+
+        // Keep about two frames (or two ticks, whichever is longer) queued in the wave; the rest stays in the jitter buffer.
+        const int32 BytesPerMs = FMath::Max(1, In.Header.SampleRate / 1000) * In.Header.Channels * (int32)sizeof(int16);
+        const int32 LeadMs = FMath::Max(2 * In.Header.FrameMs, FMath::CeilToInt(DeltaTime * 2000.0f));
+        int32 QueuedBytes = In.PlaybackWave->GetAvailableAudioByteCount();
+
+        while (QueuedBytes < LeadMs * BytesPerMs)
+        {
+            const FOpusJitterBuffer::EPullResult Result = In.Jitter->Pull(FramePcm);
+            if (Result == FOpusJitterBuffer::EPullResult::Finished)
+            {
+                In.bPlaybackFinished = true;
+                break;
+            }
+            if (Result == FOpusJitterBuffer::EPullResult::Buffering || Result == FOpusJitterBuffer::EPullResult::Underrun)
+                break;
+
+            const int32 NumBytes = FramePcm.Num() * (int32)sizeof(int16);
+            In.PlaybackWave->QueueAudio(reinterpret_cast<const uint8*>(FramePcm.GetData()), NumBytes);
+            QueuedBytes += NumBytes;
+        }
+    }
+}
+
+bool UAudioReplicatorComponent::GetOutgoingDebugInfo(const FGuid& SessionId, FAudioReplicatorOutgoingDebug& OutDebug, bool bIncludeChunks) const
+{
+    if (const FOutgoingTransfer* Tr = Outgoing.Find(SessionId))
+    {
+        OutDebug = FAudioReplicatorOutgoingDebug();
+        OutDebug.SessionId = SessionId;
+        OutDebug.Header = Tr->Header;
+        OutDebug.TotalChunks = Tr->ReleasedChunks + Tr->Packets.Num();
+        OutDebug.SentChunks = FMath::Clamp(Tr->ReleasedChunks + Tr->NextIndex, 0, OutDebug.TotalChunks);
+        OutDebug.PendingChunks = FMath::Max(0, OutDebug.TotalChunks - OutDebug.SentChunks);
+        OutDebug.NextChunkIndex = OutDebug.SentChunks;
+        OutDebug.bHeaderSent = Tr->bHeaderSent;
+        OutDebug.bEndSent = Tr->bEndSent;
+
+        // The arena keeps its byte total; released live chunks are counted separately.
+        const int64 TotalBytes = Tr->ReleasedBytes + Tr->Packets.GetTotalBytes();
+        OutDebug.TotalBytes = (int32)FMath::Min<int64>(TotalBytes, MAX_int32);
+
+        if (bIncludeChunks)
+        {
+            OutDebug.Chunks.Reset(Tr->Packets.Num());
+            OutDebug.PendingChunkIndices.Reset(OutDebug.PendingChunks);
+            for (int32 i = 0; i < Tr->Packets.Num(); ++i)
+            {
+                FAudioReplicatorChunkDebug ChunkDebug;
+                ChunkDebug.Index = Tr->ReleasedChunks + i;
+                ChunkDebug.SizeBytes = Tr->Packets.GetPacketSize(i);
+                ChunkDebug.bIsSent = (i < Tr->NextIndex);
+                ChunkDebug.bIsReceived = false;
+
+                if (!ChunkDebug.bIsSent)
+                {
+                    OutDebug.PendingChunkIndices.Add(ChunkDebug.Index);
+                }
+                OutDebug.Chunks.Add(ChunkDebug);
+            }
+        }
+
+        // Suppressed frames took no chunk but still count as stream time.
+        OutDebug.FramesSuppressed = Tr->FramesSuppressed;
+        OutDebug.CurrentBitrate = Tr->RateControl.IsEnabled() ? Tr->RateControl.GetBitrate() : Tr->Header.Bitrate;
+        OutDebug.CurrentLossPercent = Tr->RateControl.IsEnabled() ? Tr->RateControl.GetLossPercent() : (Tr->Header.bLive ? ExpectedPacketLossPercent : 0);
+        OutDebug.BitrateDecreases = Tr->RateControl.GetNumDecreases();
+        const int32 StreamFrames = OutDebug.TotalChunks + (Tr->SilenceMode == EAudioSilenceMode::Suppress ? Tr->FramesSuppressed : 0);
+        OutDebug.EstimatedDurationSec = (Tr->Header.FrameMs > 0)
+            ? (StreamFrames * Tr->Header.FrameMs) / 1000.0f
+            : 0.0f;
+
+        if (OutDebug.EstimatedDurationSec > 0.0f)
+        {
+            OutDebug.EstimatedBitrateKbps = (TotalBytes * 8.0f / OutDebug.EstimatedDurationSec) / 1000.0f;
+        }
+        else
+        {
+            OutDebug.EstimatedBitrateKbps = 0.0f;
+        }
+
+        OutDebug.bTransferComplete = (OutDebug.TotalChunks > 0)
+            ? (OutDebug.SentChunks >= OutDebug.TotalChunks && Tr->bEndSent)
+            : Tr->bEndSent;
+
+        return true;
+    }
+    return false;
+}
+
+bool UAudioReplicatorComponent::GetIncomingDebugInfo(const FGuid& SessionId, FAudioReplicatorIncomingDebug& OutDebug, bool bIncludeChunks) const
+{
+    if (const FIncomingTransfer* In = Incoming.Find(SessionId))
+    {
+        OutDebug = FAudioReplicatorIncomingDebug();
+        OutDebug.SessionId = SessionId;
+        OutDebug.Header = In->Header;
+        OutDebug.bStarted = In->bStarted;
+        OutDebug.bEnded = In->bEnded;
+        OutDebug.ReceivedChunks = In->Received;
+        OutDebug.UniqueChunks = In->UniqueChunks;
+        OutDebug.TotalBytes = (int32)FMath::Min<int64>(In->UniqueBytes, MAX_int32);
+        OutDebug.ExpectedChunks = (In->Header.NumPackets > 0) ? In->Header.NumPackets : 0;
+
+        // Gaps below the newest chunk, plus everything after it that the header says is still to come.
+        // A lossy session can have thousands of gaps, so a summary poll copies only the oldest ones.
+        const TArray<FIntPoint>& Gaps = In->Gaps.GetGaps();
+        const int32 NumCopied = bIncludeChunks ? Gaps.Num() : FMath::Min(Gaps.Num(), MaxSummaryMissingRanges);
+        OutDebug.MissingRanges.Append(Gaps.GetData(), NumCopied);
+        OutDebug.MissingRangeCount = Gaps.Num();
+        const int32 NextAfterHighest = In->Gaps.GetHighest() + 1;
+        if (OutDebug.ExpectedChunks > NextAfterHighest)
+        {
+            OutDebug.MissingRanges.Add(FIntPoint(NextAfterHighest, OutDebug.ExpectedChunks - 1));
+            ++OutDebug.MissingRangeCount;
+        }
+        OutDebug.MissingChunks = (OutDebug.ExpectedChunks > 0)
+            ? FMath::Max(0, OutDebug.ExpectedChunks - In->UniqueChunks)
+            : In->Gaps.GetNumMissing();
+
+        if (bIncludeChunks)
+        {
+            const int32 DisplayChunkCount = (OutDebug.ExpectedChunks > 0) ? OutDebug.ExpectedChunks : In->Packets.Num();
+            OutDebug.Chunks.Reset(DisplayChunkCount);
+            for (int32 Index = 0; Index < DisplayChunkCount; ++Index)
+            {
+                FAudioReplicatorChunkDebug ChunkDebug;
+                ChunkDebug.Index = Index;
+                ChunkDebug.SizeBytes = (Index < In->Packets.Num()) ? In->Packets[Index].Data.Num() : 0;
+                ChunkDebug.bIsSent = false;
+                ChunkDebug.bIsReceived = ChunkDebug.SizeBytes > 0;
+                OutDebug.Chunks.Add(ChunkDebug);
+            }
+
+            OutDebug.MissingChunkIndices.Reset(OutDebug.MissingChunks);
+            for (const FIntPoint& Range : OutDebug.MissingRanges)
+            {
+                for (int32 Index = Range.X; Index <= Range.Y; ++Index)
+                {
+                    OutDebug.MissingChunkIndices.Add(Index);
+                }
+            }
+        }
+
+        OutDebug.EstimatedDurationSec = (In->Header.FrameMs > 0)
+            ? (In->UniqueChunks * In->Header.FrameMs) / 1000.0f
+            : 0.0f;
+
+        if (OutDebug.EstimatedDurationSec > 0.0f)
+        {
+            OutDebug.EstimatedBitrateKbps = (In->UniqueBytes * 8.0f / OutDebug.EstimatedDurationSec) / 1000.0f;
+        }
+        else
+        {
+            OutDebug.EstimatedBitrateKbps = 0.0f;
+        }
+
+        OutDebug.bReadyToAssemble = OutDebug.bEnded && (OutDebug.ExpectedChunks == 0 || OutDebug.MissingChunks == 0);
+
+        return true;
+    }
+    return false;
+}
+
+void FChunkGapTracker::AddRange(int32 First, int32 End)
+{
+    for (; First < End && First <= Highest; ++First)
+    {
+        Add(First);
+    }
+    if (First < End)
+    {
+        Add(First);
+        Highest = End - 1;
+    }
+}
+
+void FChunkGapTracker::Add(int32 Index)
+{
+    if (Index > Highest)
+    {
+        if (Index > Highest + 1)
+        {
+            Gaps.Add(FIntPoint(Highest + 1, Index - 1));
+            NumMissing += Index - Highest - 1;
+        }
+        Highest = Index;
+        return;
+    }
+
+    // Late arrival: find the gap that starts at or before Index and close it there.
+    const int32 GapIndex = Algo::UpperBoundBy(Gaps, Index, &FIntPoint::X) - 1;
+    if (GapIndex < 0 || Index > Gaps[GapIndex].Y)
+        return;
+
+    FIntPoint& Gap = Gaps[GapIndex];
+    --NumMissing;
+    if (Gap.X == Gap.Y)
+    {
+        Gaps.RemoveAt(GapIndex);
+    }
+    else if (Index == Gap.X)
+    {
+        ++Gap.X;
+    }
+    else if (Index == Gap.Y)
+    {
+        --Gap.Y;
+    }
+    else
+    {
+        const FIntPoint Upper(Index + 1, Gap.Y);
+        Gap.Y = Index - 1;
+        Gaps.Insert(Upper, GapIndex + 1);
+    }
+}
+
+void UAudioReplicatorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    const double Now = FPlatformTime::Seconds();
+    PumpLivePlayback(DeltaTime);
+    ExpireFinishedTransfers(Now);
+    TrimIncomingSessions(Now);
+    RequestCatchUps(Now);
+    ReportReceiveLoss(Now);
+
+    if (GetOwner() && GetOwner()->HasAuthority())
+    {
+        RefreshRelayRecipients(Now);
+        PumpCatchUps(Now);
+    }
+
+    if (!IsOwnerClient()) return;
+
+    PumpOutgoing(Now);
+}
+
+void UAudioReplicatorComponent::PumpOutgoing(double Now)
+{
+    // Settings may change at runtime; re-applying them keeps the current token balance.
+    FAudioReplicatorPacer& ConnectionPacer = GetPacer();
+    ConnectionPacer.Configure(MaxSendBytesPerSec, FMath::Max(MaxBurstBytes, MaxBatchBytes));
+    ConnectionPacer.Refill(Now);
+
+    const bool bReliable = (Transport == EAudioReplicatorTransport::Reliable);
+
+    // Unreliable transfers keep their chunks after the end marker so the server can ask for lost ones.
+    const bool bRetainFinished = (Transport == EAudioReplicatorTransport::Unreliable) && bRetransmitLostChunks && RetransmitWindowSec > 0.0f;
+
+    // Clip offers the server never answered: upload as if it did not have the clip.
+    TArray<FGuid> ToFinish;
+    for (auto& KV : Outgoing)
+    {
+        FOutgoingTransfer& Tr = KV.Value;
+        if (Tr.bAwaitingCacheReply && Now - Tr.OfferTime > ClipOfferTimeoutSec && !FinishClipOffer(Tr))
+        {
+            ToFinish.Add(Tr.SessionId);
+        }
+    }
+
+    TArray<FOutgoingTransfer*> Queue;
+    for (auto& KV : Outgoing)
+    {
+        FOutgoingTransfer& Tr = KV.Value;
+        if (!Tr.bHeaderSent || Tr.bEndSent || Tr.NextIndex >= Tr.Packets.Num())
+            continue;
+
+        if (Tr.Header.bLive && bPrioritizeLiveSessions)
+        {
+            FlushLiveTransfer(Tr); // normally already flushed on push
+            continue;
+        }
+        Queue.Add(&Tr);
+    }
+
+    // Fair share: every session with pending chunks gets one batch per round until the bucket runs dry.
+    if (Queue.Num() > 0)
+    {
+        const int32 First = RoundRobinOffset++ % Queue.Num();
+        bool bProgress = true;
+        while (bProgress && ConnectionPacer.CanSend())
+        {
+            bProgress = false;
+            for (int32 k = 0; k < Queue.Num() && ConnectionPacer.CanSend(); ++k)
+            {
+                FOutgoingTransfer& Tr = *Queue[(First + k) % Queue.Num()];
+                if (Tr.NextIndex >= Tr.Packets.Num())
+                    continue;
+
+                const int32 Sent = SendChunkBatches(Tr, Tr.NextIndex, Tr.Packets.Num() - Tr.NextIndex, 1, bReliable);
+                Tr.NextIndex += Sent;
+                bProgress |= (Sent > 0);
+            }
+        }
+
+        for (FOutgoingTransfer* Tr : Queue)
+        {
+            if (Tr->Header.bLive)
+            {
+                ReleaseSentLiveChunks(*Tr);
+            }
+        }
+    }
+
+    // Live sessions are finished by CloseStreamSession; clips once every chunk is out.
+    for (auto& KV : Outgoing)
+    {
+        FOutgoingTransfer& Tr = KV.Value;
+        if (!Tr.bHeaderSent || Tr.bEndSent || Tr.Header.bLive || Tr.bStreaming || Tr.NextIndex < Tr.Packets.Num())
+            continue;
+
+        Server_EndTransfer(Tr.SessionId, Tr.Packets.Num());
+        Tr.bEndSent = true;
+        Tr.EndSentTime = Now;
+        if (!bRetainFinished)
+        {
+            ToFinish.Add(Tr.SessionId);
+        }
+    }
+
+    for (const FGuid& S : ToFinish)
+    {
+        Outgoing.Remove(S);
+    }
+}
+
+void UAudioReplicatorComponent::GetSendStats(FAudioReplicatorSendStats& OutStats) const
+{
+    OutStats = FAudioReplicatorSendStats();
+    const FAudioReplicatorPacer& ConnectionPacer = GetPacer();
+    OutStats.BudgetKbps = ConnectionPacer.GetBudgetBytesPerSec() * 8.0f / 1000.0f;
+    OutStats.SendRateKbps = ConnectionPacer.GetSendRateBytesPerSec() * 8.0f / 1000.0f;
+    OutStats.AvailableBytes = ConnectionPacer.GetAvailableBytes();
+    OutStats.TotalBytesSent = ConnectionPacer.GetTotalBytesSent();
+
+    for (const auto& KV : Outgoing)
+    {
+        const FOutgoingTransfer& Tr = KV.Value;
+        if (Tr.bEndSent || Tr.bAwaitingCacheReply || Tr.NextIndex >= Tr.Packets.Num())
+            continue;
+
+        ++OutStats.ActiveSessions;
+        OutStats.QueuedChunks += Tr.Packets.Num() - Tr.NextIndex;
+        OutStats.QueuedBytes += (int32)Tr.Packets.GetRangeBytes(Tr.NextIndex, Tr.Packets.Num() - Tr.NextIndex);
+    }
+}
+
+void UAudioReplicatorComponent::ExpireFinishedTransfers(double Now)
+{
+    for (auto It = Outgoing.CreateIterator(); It; ++It)
+    {
+        const FOutgoingTransfer& Tr = It.Value();
+        if (Tr.bEndSent && Now - Tr.EndSentTime > RetransmitWindowSec)
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    for (auto It = ServerSessions.CreateIterator(); It; ++It)
+    {
+        // Finished clips stay longer so late joiners can still get them. A session whose end never came
+        // (the sender left or the message was lost) goes once it stops sending.
+        const FRelaySession& Session = It.Value();
+        const float RetentionSec = Session.Header.bLive ? RetransmitWindowSec : FMath::Max(RetransmitWindowSec, ClipReplayRetentionSec);
+        const double IdleLimitSec = Session.bSilent ? (double)MaxSessionDurationSec : (double)RelaySessionIdleSec;
+        const bool bAbandoned = !Session.bEnded && RelaySessionIdleSec > 0.0f && Now - Session.LastBatchTime > IdleLimitSec;
+        if ((Session.bEnded && Now - Session.EndedTime > RetentionSec) || bAbandoned)
+        {
+            RelayBytes -= Session.Bytes;
+            ForgetSessionHandles(It.Key());
+            It.RemoveCurrent();
+        }
+    }
+}
+
+bool UAudioReplicatorComponent::MakeRelayRoom(int64 Bytes)
+{
+    // Linear scan per eviction, as for the incoming store: a component relays a handful of sessions.
+    while (ServerSessions.Num() >= MaxRelaySessions || RelayBytes + Bytes > MaxRelayBytes)
+    {
+        const FGuid* OldestKey = nullptr;
+        double OldestEnd = TNumericLimits<double>::Max();
+        for (const TPair<FGuid, FRelaySession>& KV : ServerSessions)
+        {
+            if (KV.Value.bEnded && KV.Value.EndedTime < OldestEnd)
+            {
+                OldestEnd = KV.Value.EndedTime;
+                OldestKey = &KV.Key;
+            }
+        }
+        if (!OldestKey)
+            return false; // running sessions are never cut off
+
+        const FGuid SessionId = *OldestKey;
+        RemoveRelaySession(SessionId);
+    }
+    return true;
+}
+
+void UAudioReplicatorComponent::RemoveRelaySession(const FGuid& SessionId)
+{
+    if (const FRelaySession* Session = ServerSessions.Find(SessionId))
+    {
+        RelayBytes -= Session->Bytes;
+        ServerSessions.Remove(SessionId);
+        ForgetSessionHandles(SessionId);
+    }
+}
+
+void UAudioReplicatorComponent::GrowRelayPackets(FRelaySession& Session, int32 Num)
+{
+    if (Session.Packets.Num() >= Num)
+        return;
+
+    const int64 DeltaBytes = (int64)(Num - Session.Packets.Num()) * sizeof(FOpusPacket);
+    Session.Packets.SetNum(Num);
+    Session.Bytes += DeltaBytes;
+    RelayBytes += DeltaBytes;
+}
+
+void UAudioReplicatorComponent::TrimIncomingSessions(double Now)
+{
+    // Sessions still playing or being recorded are never dropped as a whole.
+    auto IsIdle = [](const FIncomingTransfer& In)
+    {
+        return In.bEnded && !In.Recorder.IsValid() && (!In.Jitter.IsValid() || In.bPlaybackFinished);
+    };
+
+    // Recordings of clips still missing frames close once the retransmissions had their chance.
+    TArray<FGuid> Overdue;
+    for (const TPair<FGuid, FIncomingTransfer>& KV : Incoming)
+    {
+        if (KV.Value.Recorder.IsValid() && KV.Value.RecordingDeadline > 0.0 && Now >= KV.Value.RecordingDeadline)
+        {
+            Overdue.Add(KV.Key);
+        }
+    }
+    for (const FGuid& SessionId : Overdue)
+    {
+        if (FIncomingTransfer* In = Incoming.Find(SessionId))
+        {
+            FinishRecording(SessionId, *In, In->Header.NumPackets);
+        }
+    }
+
+    if (IncomingSessionTtlSec > 0.0f)
+    {
+        // A session whose end message was lost goes once it has been as long without data. A live speaker
+        // in a silence sends nothing at all, so that session gets the session limit instead.
+        TArray<FGuid> Expired;
+        for (const TPair<FGuid, FIncomingTransfer>& KV : Incoming)
+        {
+            const FIncomingTransfer& In = KV.Value;
+            const double IdleSec = Now - In.LastUseTime;
+            const double AbandonSec = (In.SilentFrom != INDEX_NONE) ? (double)MaxSessionDurationSec : (double)IncomingSessionTtlSec;
+            if ((IsIdle(In) && IdleSec > IncomingSessionTtlSec) || (!In.bEnded && IdleSec > AbandonSec))
+            {
+                Expired.Add(KV.Key);
+            }
+        }
+        for (const FGuid& SessionId : Expired)
+        {
+            FIncomingTransfer* In = Incoming.Find(SessionId);
+            if (In && In->Recorder.IsValid())
+            {
+                FinishRecording(SessionId, *In, 0);
+            }
+            if (Incoming.Contains(SessionId)) // OnRecordingFinished may have released it
+            {
+                RemoveIncoming(SessionId);
+                ++IncomingExpired;
+            }
+        }
+    }
+
+    // Linear scan per eviction: a component receives a handful of sessions, not thousands.
+    while (IncomingBytes > MaxIncomingBytes)
+    {
+        const FGuid* OldestKey = nullptr;
+        double OldestUse = TNumericLimits<double>::Max();
+        for (const TPair<FGuid, FIncomingTransfer>& KV : Incoming)
+        {
+            if (IsIdle(KV.Value) && KV.Value.LastUseTime < OldestUse)
+            {
+                OldestUse = KV.Value.LastUseTime;
+                OldestKey = &KV.Key;
+            }
+        }
+        if (!OldestKey)
+            break;
+
+        // A copy: RemoveIncoming still uses the id after the entry holding the key is gone.
+        const FGuid SessionId = *OldestKey;
+        RemoveIncoming(SessionId);
+        ++IncomingEvictions;
+    }
+
+    // Still over: running live sessions give up their oldest packets. The jitter buffer and the
+    // recorder took their copies on arrival, so only GetReceivedPackets sees the difference.
+    for (auto& KV : Incoming)
+    {
+        if (IncomingBytes <= MaxIncomingBytes)
+            break;
+
+        FIncomingTransfer& In = KV.Value;
+        if (!In.Header.bLive)
+            continue;
+
+        // The most recent second of audio is kept so a recording started now still has a lead-in.
+        const int32 KeepFrames = In.Header.FrameMs > 0 ? FMath::DivideAndRoundUp(1000, In.Header.FrameMs) : 50;
+        const int32 TrimEnd = In.Packets.Num() - KeepFrames;
+        while (In.FirstRetainedIndex < TrimEnd && IncomingBytes > MaxIncomingBytes)
+        {
+            TArray<uint8>& Data = In.Packets[In.FirstRetainedIndex++].Data;
+            if (Data.Num() > 0)
+            {
+                In.Bytes -= Data.Num();
+                IncomingBytes -= Data.Num();
+                Data.Empty();
+                ++IncomingLiveChunksTrimmed;
+            }
+        }
+    }
+
+    // Endpoint: a relayed session whose end message never came (the speaker left) keeps its binding
+    // until the incoming session it feeds is gone.
+    for (auto It = RelayBindings.CreateIterator(); It; ++It)
+    {
+        const UAudioReplicatorComponent* Target = It.Value().Target.IsValid() ? It.Value().Target.Get() : this;
+        if (!Target->Incoming.Contains(It.Value().SessionId))
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+// ================= SERVER RPC =================
+
+void UAudioReplicatorComponent::Server_StartTransfer_Implementation(const FGuid& SessionId, uint16 SessionHandle, const FOpusStreamHeader& Header)
+{
+    if (!IsValidPacketCount(Header.NumPackets, Header.FrameMs))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Server_StartTransfer: rejected session %s with %d packets"), *SessionId.ToString(), Header.NumPackets);
+        return;
+    }
+    const FRelaySession* Existing = ServerSessions.Find(SessionId);
+    if (Existing && Existing->bServedFromCache)
+        return; // the offer reply reached the client after it gave up waiting; the clip already played from the cache
+
+    // Only the slots are known up front; the frames are counted as they arrive.
+    const int32 NumRecent = (Header.bLive && LiveCatchUpMs > 0) ? FMath::DivideAndRoundUp(LiveCatchUpMs, FMath::Max(1, Header.FrameMs)) : 0;
+    const int64 SlotBytes = Header.bLive ? (int64)NumRecent * sizeof(FOpusChunk) : (int64)FMath::Max(0, Header.NumPackets) * sizeof(FOpusPacket);
+    if (!Existing && !MakeRelayRoom(SlotBytes))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Server_StartTransfer: rejected session %s, %d sessions and %lld bytes are relayed already"), *SessionId.ToString(), ServerSessions.Num(), RelayBytes);
+        return;
+    }
+
+    SessionHandles.Add(SessionHandle, SessionId);
+
+    FRelaySession& Session = ServerSessions.FindOrAdd(SessionId);
+    Session.Header = Header;
+    Session.LastBatchTime = FPlatformTime::Seconds();
+    if (!Header.bLive)
+    {
+        GrowRelayPackets(Session, Header.NumPackets);
+    }
+    if (NumRecent > Session.RecentChunks.Num())
+    {
+        const int64 DeltaBytes = (int64)(NumRecent - Session.RecentChunks.Num()) * sizeof(FOpusChunk);
+        Session.RecentChunks.SetNum(NumRecent);
+        Session.Bytes += DeltaBytes;
+        RelayBytes += DeltaBytes;
+    }
+
+    if (RelayMode == EAudioReplicatorRelayMode::Multicast)
+    {
+        Multicast_StartTransfer(SessionId, SessionHandle, Header);
+        return;
+    }
+
+    TArray<UAudioReplicatorComponent*> Endpoints;
+    GatherRelayRecipients(Endpoints);
+
+    Session.Recipients.Reset(Endpoints.Num());
+    for (UAudioReplicatorComponent* Endpoint : Endpoints)
+    {
+        FRelayRecipient& Recipient = Session.Recipients.AddDefaulted_GetRef();
+        Recipient.Endpoint = Endpoint;
+        Recipient.Handle = Endpoint->AllocateRelayHandle();
+        Endpoint->Client_RelayStartTransfer(this, SessionId, Recipient.Handle, 0, Header);
+    }
+}
+
+void UAudioReplicatorComponent::GatherRelayRecipients(TArray<UAudioReplicatorComponent*>& OutEndpoints) const
+{
+    OutEndpoints.Reset();
+
+    const UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+    const AActor* Owner = GetOwner();
+    if (!Subsystem || !Owner)
+        return;
+
+    TArray<UAudioReplicatorComponent*> Candidates;
+    if (RelayMode == EAudioReplicatorRelayMode::Explicit)
+    {
+        for (const TWeakObjectPtr<AActor>& Actor : RelayRecipientActors)
+        {
+            if (!Actor.IsValid())
+                continue;
+
+            const UNetConnection* Connection = Actor->GetNetConnection();
+            UAudioReplicatorComponent* Endpoint = Connection
+                ? Subsystem->FindEndpointForConnection(Connection)
+                : (Actor->HasLocalNetOwner() ? Subsystem->FindLocalEndpoint() : nullptr);
+            if (Endpoint)
+            {
+                Candidates.AddUnique(Endpoint);
+            }
+        }
+    }
+    else
+    {
+        Subsystem->GetListenerEndpoints(Candidates);
+    }
+
+    const UNetConnection* OriginConnection = Owner->GetNetConnection();
+    const bool bOriginIsLocal = !OriginConnection && Owner->HasLocalNetOwner();
+    const AActor* Speaker = GetPlayerLocationActor(this);
+
+    for (UAudioReplicatorComponent* Endpoint : Candidates)
+    {
+        const AActor* EndpointOwner = Endpoint->GetOwner();
+        const UNetConnection* Connection = EndpointOwner ? EndpointOwner->GetNetConnection() : nullptr;
+        if ((OriginConnection && Connection == OriginConnection) || (bOriginIsLocal && !Connection))
+            continue; // the originator's own player
+
+        if (RelayMode == EAudioReplicatorRelayMode::Proximity)
+        {
+            const AActor* Listener = GetPlayerLocationActor(Endpoint);
+            if (!Speaker || !Listener || FVector::DistSquared(Speaker->GetActorLocation(), Listener->GetActorLocation()) > FMath::Square(RelayRadius))
+                continue;
+        }
+
+        OutEndpoints.Add(Endpoint);
+    }
+}
+
+bool UAudioReplicatorComponent::IsRelayListener(const FRelaySession& Session, const UAudioReplicatorComponent* Endpoint) const
+{
+    const UNetConnection* Connection = (Endpoint && Endpoint->GetOwner()) ? Endpoint->GetOwner()->GetNetConnection() : nullptr;
+    const UNetConnection* OriginConnection = GetOwner() ? GetOwner()->GetNetConnection() : nullptr;
+    if (!Endpoint || Endpoint == this || (Connection && Connection == OriginConnection))
+        return false;
+
+    const bool bRelayed = Session.Recipients.ContainsByPredicate([Endpoint](const FRelayRecipient& Recipient)
+    {
+        return Recipient.Endpoint.Get() == Endpoint;
+    });
+    if (bRelayed)
+        return true;
+
+    TArray<UAudioReplicatorComponent*> Endpoints;
+    GatherRelayRecipients(Endpoints);
+    return Endpoints.Contains(Endpoint);
+}
+
+bool UAudioReplicatorComponent::StoreRelayedFrames(FRelaySession& Session, const FOpusChunkBatch& Batch)
+{
+    TArray<FOpusPacket> Packets;
+    if (!Chunking::UnpackWithLengths(Batch.Payload, Packets))
+        return false;
+
+    // FirstIndex comes from the client: nothing below zero, past a clip's announced count or past the session limit.
+    const int32 EndLimit = (!Session.Header.bLive && Session.Header.NumPackets > 0) ? Session.Header.NumPackets : GetMaxPacketsPerSession(Session.Header.FrameMs);
+    if (Batch.FirstIndex < 0 || (int64)Batch.FirstIndex + Packets.Num() > EndLimit)
+        return false;
+
+    if (Session.Header.bLive)
+    {
+        // The sender cuts a batch at the marker that starts a silence.
+        Session.bSilent = Packets.Num() > 0 && Packets.Last().Data.Num() == 0;
+        if (Session.RecentChunks.Num() == 0)
+            return true; // nothing to keep
+
+        for (int32 i = 0; i < Packets.Num(); ++i)
+        {
+            FOpusChunk& Slot = Session.RecentChunks[(Batch.FirstIndex + i) % Session.RecentChunks.Num()];
+            const int64 DeltaBytes = (int64)Packets[i].Data.Num() - Slot.Packet.Data.Num();
+            Slot.Index = Batch.FirstIndex + i;
+            Slot.Packet = MoveTemp(Packets[i]);
+            Session.Bytes += DeltaBytes;
+            RelayBytes += DeltaBytes;
+        }
+        return true;
+    }
+
+    GrowRelayPackets(Session, Batch.FirstIndex + Packets.Num());
+    int64 DeltaBytes = 0;
+    for (int32 i = 0; i < Packets.Num(); ++i)
+    {
+        DeltaBytes += (int64)Packets[i].Data.Num() - Session.Packets[Batch.FirstIndex + i].Data.Num();
+    }
+    if (DeltaBytes > 0 && RelayBytes + DeltaBytes > MaxRelayBytes)
+    {
+        // Still relayed to the listeners, just not kept for retransmission, catch-ups or the cache.
+        if (!Session.bStoreFull)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("StoreRelayedFrames: relay store full (%lld bytes), frames from %d on are not kept"), RelayBytes, Batch.FirstIndex);
+            Session.bStoreFull = true;
+        }
+        return true;
+    }
+    for (int32 i = 0; i < Packets.Num(); ++i)
+    {
+        Session.Packets[Batch.FirstIndex + i] = MoveTemp(Packets[i]);
+    }
+    Session.Bytes += DeltaBytes;
+    RelayBytes += DeltaBytes;
+    return true;
+}
+
+void UAudioReplicatorComponent::GetBufferedRange(const FRelaySession& Session, int32& OutFirst, int32& OutEnd)
+{
+    if (!Session.Header.bLive)
+    {
+        OutFirst = 0;
+        OutEnd = Session.Packets.Num();
+        return;
+    }
+
+    int32 Newest = INDEX_NONE;
+    for (const FOpusChunk& Slot : Session.RecentChunks)
+    {
+        if (Slot.Packet.Data.Num() > 0)
+        {
+            Newest = FMath::Max(Newest, Slot.Index);
+        }
+    }
+    // Oldest first, so the listener's jitter buffer starts at the beginning of the catch-up.
+    OutFirst = FMath::Max(0, Newest - Session.RecentChunks.Num() + 1);
+    OutEnd = Newest + 1;
+}
+
+bool UAudioReplicatorComponent::NextBufferedBatch(const FRelaySession& Session, uint16 Handle, int32 Budget, int32 EndIndex, int32& Cursor, FOpusChunkBatch& OutBatch)
+{
+    OutBatch.SessionHandle = Handle;
+    OutBatch.Payload.Reset();
+
+    // Live frames come from the ring; a slot that has moved on since the catch-up started is skipped.
+    auto FindFrame = [&Session](int32 Index) -> const TArray<uint8>*
+    {
+        if (Session.Header.bLive)
+        {
+            const FOpusChunk* Slot = Session.RecentChunks.Num() > 0 ? &Session.RecentChunks[Index % Session.RecentChunks.Num()] : nullptr;
+            return (Slot && Slot->Index == Index) ? &Slot->Packet.Data : nullptr;
+        }
+        return Session.Packets.IsValidIndex(Index) ? &Session.Packets[Index].Data : nullptr;
+    };
+
+    // Batches hold consecutive frames only, so a gap ends one.
+    for (; Cursor < EndIndex; ++Cursor)
+    {
+        const TArray<uint8>* Data = FindFrame(Cursor);
+        if (!Data || Data->Num() == 0)
+        {
+            if (OutBatch.Payload.Num() > 0)
+                break;
+            continue;
+        }
+        if (OutBatch.Payload.Num() > 0 && OutBatch.Payload.Num() + 2 + Data->Num() > Budget)
+            break;
+
+        if (OutBatch.Payload.Num() == 0)
+        {
+            OutBatch.FirstIndex = Cursor;
+        }
+        Chunking::AppendWithLength(*Data, OutBatch.Payload);
+    }
+    return OutBatch.Payload.Num() > 0;
+}
+
+uint16 UAudioReplicatorComponent::SendCatchUp(UAudioReplicatorComponent* Endpoint, const FGuid& SessionId, FRelaySession& Session, uint16 SourceHandle)
+{
+    const uint16 Handle = Endpoint->AllocateRelayHandle();
+    Endpoint->Client_RelayStartTransfer(this, SessionId, Handle, SourceHandle, Session.Header);
+
+    // The frames follow through the player's pacer, so joins and replays do not go out as one reliable
+    // burst. Frames relayed from now on reach the player directly; the catch-up stops at what is buffered.
+    FRelayCatchUp& CatchUp = Endpoint->PendingCatchUps.AddDefaulted_GetRef();
+    CatchUp.Source = this;
+    CatchUp.SessionId = SessionId;
+    CatchUp.Handle = Handle;
+    GetBufferedRange(Session, CatchUp.NextIndex, CatchUp.EndIndex);
+
+    Endpoint->PumpCatchUps(FPlatformTime::Seconds());
+    return Handle;
+}
+
+void UAudioReplicatorComponent::PumpCatchUps(double Now)
+{
+    if (PendingCatchUps.Num() == 0 && PendingRetransmits.Num() == 0)
+        return;
+
+    // The listen server's own player has no connection to protect.
+    const UNetConnection* Connection = GetOwner() ? GetOwner()->GetNetConnection() : nullptr;
+    FAudioReplicatorPacer* ConnectionPacer = Connection ? &GetPacer() : nullptr;
+    if (ConnectionPacer)
+    {
+        ConnectionPacer->Configure(MaxSendBytesPerSec, FMath::Max(MaxBurstBytes, MaxBatchBytes));
+        ConnectionPacer->Refill(Now);
+    }
+    auto CanSend = [ConnectionPacer]() { return !ConnectionPacer || ConnectionPacer->CanSend(); };
+
+    // One batch per catch-up per round, so several sessions caught up at once share the budget.
+    const int32 Budget = FMath::Clamp(MaxBatchBytes, 64, FOpusChunkBatch::MaxPayloadBytes);
+    FOpusChunkBatch Batch;
+    bool bProgress = true;
+    while (bProgress && CanSend())
+    {
+        bProgress = false;
+        for (int32 i = 0; i < PendingCatchUps.Num() && CanSend();)
+        {
+            FRelayCatchUp& CatchUp = PendingCatchUps[i];
+            UAudioReplicatorComponent* Source = CatchUp.Source.Get();
+            FRelaySession* Session = Source ? Source->ServerSessions.Find(CatchUp.SessionId) : nullptr;
+            if (Session && NextBufferedBatch(*Session, CatchUp.Handle, Budget, CatchUp.EndIndex, CatchUp.NextIndex, Batch))
+            {
+                Client_RelayChunkBatch(Batch);
+                Session->BytesRelayed += Batch.Payload.Num();
+                if (ConnectionPacer)
+                {
+                    ConnectionPacer->Consume(Batch.Payload.Num() + 8);
+                }
+                bProgress = true;
+                ++i;
+                continue;
+            }
+
+            // Done, or the session expired meanwhile. Server_EndTransfer leaves the end marker of a
+            // session with a pending catch-up to it, so it goes out behind the last frame.
+            if (Session && Session->bEnded)
+            {
+                Client_RelayEndTransfer(CatchUp.SessionId, CatchUp.Handle, Session->Header.NumPackets);
+            }
+            PendingCatchUps.RemoveAt(i);
+        }
+
+        // Retransmissions take their turn in the same rounds, one group of up to Budget bytes each.
+        for (int32 i = 0; i < PendingRetransmits.Num() && CanSend();)
+        {
+            FRelayRetransmit& Retransmit = PendingRetransmits[i];
+            UAudioReplicatorComponent* Owner = Retransmit.Owner.Get();
+            FRelaySession* Session = Owner ? Owner->ServerSessions.Find(Retransmit.SessionId) : nullptr;
+
+            TArray<FOpusChunk> Chunks;
+            int32 GroupBytes = 0;
+            while (Session && Retransmit.NextIndex < Retransmit.Indices.Num())
+            {
+                const int32 Index = Retransmit.Indices[Retransmit.NextIndex];
+                const TArray<uint8>* Data = Session->Packets.IsValidIndex(Index) ? &Session->Packets[Index].Data : nullptr;
+                if (Data && GroupBytes > 0 && GroupBytes + Data->Num() > Budget)
+                    break;
+
+                ++Retransmit.NextIndex;
+                if (!Data || Data->Num() == 0)
+                    continue; // the server is still waiting for it too; it will be relayed once it arrives
+
+                FOpusChunk& Chunk = Chunks.AddDefaulted_GetRef();
+                Chunk.Index = Index;
+                Chunk.Packet.Data = *Data;
+                GroupBytes += Data->Num();
+            }
+
+            if (Chunks.Num() > 0)
+            {
+                Client_ReceiveChunks(Retransmit.Source.Get(), Retransmit.SessionId, Chunks);
+                Session->BytesRelayed += GroupBytes;
+                if (ConnectionPacer)
+                {
+                    ConnectionPacer->Consume(GroupBytes + 8 * Chunks.Num());
+                }
+                bProgress = true;
+            }
+            if (!Session || Retransmit.NextIndex >= Retransmit.Indices.Num())
+            {
+                PendingRetransmits.RemoveAt(i);
+                continue;
+            }
+            ++i;
+        }
+    }
+}
+
+bool UAudioReplicatorComponent::HasPendingCatchUp(const FGuid& SessionId) const
+{
+    return PendingCatchUps.ContainsByPredicate([&SessionId](const FRelayCatchUp& CatchUp)
+    {
+        return CatchUp.SessionId == SessionId;
+    });
+}
+
+void UAudioReplicatorComponent::TryCacheClip(FRelaySession& Session)
+{
+    const FOpusStreamHeader& H = Session.Header;
+    if (Session.bInClipCache || H.bLive || !H.ContentHash.IsValid() || H.NumPackets <= 0 || Session.Packets.Num() != H.NumPackets)
+        return;
+
+    for (const FOpusPacket& Packet : Session.Packets)
+    {
+        if (Packet.Data.Num() == 0)
+            return; // still waiting for retransmissions
+    }
+
+    UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+    if (!Subsystem)
+        return;
+
+    // The hash in the header only opts the clip in. The key is the hash of the frames that actually
+    // arrived, so an offer can only hit content the server has seen, not whatever a client claimed.
+    Session.bInClipCache = true;
+    TArray<uint8> Packed;
+    Chunking::PackWithLengths(Session.Packets, Packed);
+    FOpusStreamHeader Cached = H;
+    Cached.ContentHash = MakeContentHash(H, Packed);
+    if (!Subsystem->GetClipCache().Contains(Cached.ContentHash))
+    {
+        Subsystem->GetClipCache().Add(Cached.ContentHash, Cached, MoveTemp(Packed));
+    }
+}
+
+void UAudioReplicatorComponent::RefreshRelayRecipients(double Now)
+{
+    if (RelayMode == EAudioReplicatorRelayMode::Multicast || Now < NextRecipientRefreshTime)
+        return;
+    NextRecipientRefreshTime = Now + RecipientRefreshSec;
+
+    TArray<UAudioReplicatorComponent*> Endpoints;
+    bool bGathered = false;
+
+    for (auto& KV : ServerSessions)
+    {
+        FRelaySession& Session = KV.Value;
+        if (Session.bEnded)
+            continue;
+
+        if (!bGathered)
+        {
+            GatherRelayRecipients(Endpoints);
+            bGathered = true;
+        }
+
+        for (UAudioReplicatorComponent* Endpoint : Endpoints)
+        {
+            const bool bKnown = Session.Recipients.ContainsByPredicate([Endpoint](const FRelayRecipient& Recipient)
+            {
+                return Recipient.Endpoint.Get() == Endpoint;
+            });
+            if (bKnown)
+                continue;
+
+            // Joined, moved into range or was added to the recipient list after the session started.
+            FRelayRecipient& Recipient = Session.Recipients.AddDefaulted_GetRef();
+            Recipient.Endpoint = Endpoint;
+            Recipient.Handle = SendCatchUp(Endpoint, KV.Key, Session, 0);
+        }
+    }
+}
+
+void UAudioReplicatorComponent::RequestCatchUps(double Now)
+{
+    for (auto It = UnresolvedSince.CreateIterator(); It; ++It)
+    {
+        if (Now - It.Value() > UnresolvedHandleTimeoutSec)
+        {
+            const uint16 Handle = It.Key();
+            UnresolvedBatches.RemoveAll([Handle](const FOpusChunkBatch& Batch) { return Batch.SessionHandle == Handle; });
+            CatchUpRequested.Remove(Handle);
+            It.RemoveCurrent();
+        }
+    }
+
+    const AActor* Owner = GetOwner();
+    if (!bRequestCatchUp || UnresolvedSince.Num() == 0 || !Owner || Owner->HasAuthority())
+        return;
+
+    UAudioReplicatorComponent* Endpoint = nullptr;
+    for (const TPair<uint16, double>& KV : UnresolvedSince)
+    {
+        if (Now - KV.Value < CatchUpRequestDelaySec || CatchUpRequested.Contains(KV.Key))
+            continue;
+
+        if (!Endpoint)
+        {
+            UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+            Endpoint = Subsystem ? Subsystem->FindLocalEndpoint() : nullptr;
+            if (!Endpoint)
+                return; // try again once the local player is set up
+        }
+
+        Endpoint->Server_RequestCatchUp(this, FGuid(), KV.Key);
+        CatchUpRequested.Add(KV.Key);
+    }
+}
+
+void UAudioReplicatorComponent::ReportReceiveLoss(double Now)
+{
+    const AActor* Owner = GetOwner();
+    if (LossReportIntervalSec <= 0.0f || Incoming.Num() == 0 || !Owner || Owner->HasAuthority())
+        return;
+
+    UAudioReplicatorComponent* Endpoint = nullptr;
+    for (TPair<FGuid, FIncomingTransfer>& KV : Incoming)
+    {
+        FIncomingTransfer& In = KV.Value;
+        if (!In.Header.bLive || In.bEnded || In.Gaps.GetHighest() == INDEX_NONE)
+            continue;
+        if (In.LossWindowStart > 0.0 && Now - In.LossWindowStart < LossReportIntervalSec)
+            continue;
+
+        // The first window opens at the first chunk seen, so frames from before a late join are not counted as lost.
+        const bool bFirstWindow = In.LossWindowStart <= 0.0;
+        const int32 Expected = In.Gaps.GetHighest() - In.LossWindowHighest;
+        const int32 Arrived = In.UniqueChunks - In.LossWindowUnique;
+        In.LossWindowHighest = In.Gaps.GetHighest();
+        In.LossWindowUnique = In.UniqueChunks;
+        In.LossWindowStart = Now;
+
+        // Nothing new: a suppressed silence or a stalled stream, neither of which is loss.
+        if (bFirstWindow || Expected <= 0)
+            continue;
+
+        if (!Endpoint)
+        {
+            UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+            Endpoint = Subsystem ? Subsystem->FindLocalEndpoint() : nullptr;
+            if (!Endpoint)
+                return;
+        }
+
+        // Late chunks that fill an earlier gap count in this window, so the estimate errs low.
+        const int32 LossPercent = FMath::Clamp(100 * (Expected - Arrived) / Expected, 0, 100);
+        Endpoint->Server_ReportLoss(this, KV.Key, LossPercent);
+    }
+}
+
+void UAudioReplicatorComponent::RequestSessionReplay(const FGuid& SessionId)
+{
+    UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+    UAudioReplicatorComponent* Endpoint = Subsystem ? Subsystem->FindLocalEndpoint() : nullptr;
+    if (!Endpoint)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("RequestSessionReplay: no locally owned component to send the request through"));
+        return;
+    }
+    ClosedIncoming.Remove(SessionId); // asked for again on purpose
+    Endpoint->Server_RequestCatchUp(this, SessionId, 0);
+}
+
+uint16 UAudioReplicatorComponent::AllocateRelayHandle()
+{
+    ++LastRelayHandle;
+    if (LastRelayHandle == 0)
+    {
+        LastRelayHandle = 1;
+    }
+    return LastRelayHandle;
+}
+
+void UAudioReplicatorComponent::SetRelayRecipients(const TArray<AActor*>& Recipients)
+{
+    RelayRecipientActors.Reset(Recipients.Num());
+    for (AActor* Actor : Recipients)
+    {
+        if (Actor)
+        {
+            RelayRecipientActors.Add(Actor);
+        }
+    }
+}
+
+bool UAudioReplicatorComponent::GetRelayStats(const FGuid& SessionId, FAudioReplicatorRelayStats& OutStats) const
+{
+    const FRelaySession* Session = ServerSessions.Find(SessionId);
+    if (!Session)
+        return false;
+
+    OutStats = FAudioReplicatorRelayStats();
+    OutStats.SessionId = SessionId;
+    OutStats.Recipients = Session->Recipients.Num();
+    if (RelayMode == EAudioReplicatorRelayMode::Multicast)
+    {
+        const UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr;
+        OutStats.Recipients = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+    }
+    OutStats.BatchesRelayed = Session->BatchesRelayed;
+    OutStats.BytesReceived = Session->BytesReceived;
+    OutStats.BytesRelayed = Session->BytesRelayed;
+    return true;
+}
+
+void UAudioReplicatorComponent::Server_OfferClip_Implementation(const FGuid& SessionId, uint16 SessionHandle, const FOpusStreamHeader& Header)
+{
+    UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+    const FOpusClipCache::FEntry* Entry = (Subsystem && Header.ContentHash.IsValid()) ? Subsystem->GetClipCache().Find(Header.ContentHash) : nullptr;
+
+    TArray<FOpusPacket> Packets;
+    if (!Entry || !Chunking::UnpackWithLengths(Entry->Packed, Packets))
+    {
+        Client_ClipOfferResult(SessionId, false);
+        return;
+    }
+    // Slots plus payloads: the packed form spends two length bytes per frame.
+    const int64 Bytes = (int64)Packets.Num() * sizeof(FOpusPacket) + Entry->Packed.Num() - 2 * Packets.Num();
+    RemoveRelaySession(SessionId);
+    if (!MakeRelayRoom(Bytes))
+    {
+        Client_ClipOfferResult(SessionId, false);
+        return;
+    }
+
+    // From here on the session looks like a finished upload, so late joiners and replays work as usual.
+    SessionHandles.Add(SessionHandle, SessionId);
+    FRelaySession& Session = ServerSessions.Add(SessionId);
+    Session.Header = Entry->Header;
+    Session.Packets = MoveTemp(Packets);
+    Session.Bytes = Bytes;
+    RelayBytes += Bytes;
+    Session.bEnded = true;
+    Session.EndedTime = FPlatformTime::Seconds();
+    Session.bInClipCache = true;
+    Session.bServedFromCache = true;
+
+    // Every listener gets the clip as a catch-up, through its own connection budget, in Multicast mode too:
+    // the whole clip is there at once and would otherwise go out as one reliable burst.
+    TArray<UAudioReplicatorComponent*> Endpoints;
+    GatherRelayRecipients(Endpoints);
+    for (UAudioReplicatorComponent* Endpoint : Endpoints)
+    {
+        FRelayRecipient& Recipient = Session.Recipients.AddDefaulted_GetRef();
+        Recipient.Endpoint = Endpoint;
+        Recipient.Handle = SendCatchUp(Endpoint, SessionId, Session, 0);
+    }
+
+    Client_ClipOfferResult(SessionId, true);
+}
+
+void UAudioReplicatorComponent::Server_SendChunkBatch_Implementation(const FOpusChunkBatch& Batch)
+{
+    RelayChunkBatch(Batch, /*bReliable=*/true);
+}
+
+void UAudioReplicatorComponent::Server_SendChunkBatchUnreliable_Implementation(const FOpusChunkBatch& Batch)
+{
+    RelayChunkBatch(Batch, /*bReliable=*/false);
+}
+
+void UAudioReplicatorComponent::RelayChunkBatch(const FOpusChunkBatch& Batch, bool bReliable)
+{
+    // Keep the frames for retransmission and late joiners. A batch that overtook its start message
+    // is still multicast, but without a session there are no recipients to relay it to; its frames are
+    // re-requested from the owner at the end (or concealed, for live sessions).
+    const FGuid* SessionId = SessionHandles.Find(Batch.SessionHandle);
+    FRelaySession* Session = SessionId ? ServerSessions.Find(*SessionId) : nullptr;
+    if (Session && Session->bServedFromCache)
+        return; // upload after a late offer reply (see Server_StartTransfer)
+    if (Session)
+    {
+        Session->BytesReceived += Batch.Payload.Num();
+        Session->LastBatchTime = FPlatformTime::Seconds();
+    }
+    if (Session)
+    {
+        if (!StoreRelayedFrames(*Session, Batch))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("RelayChunkBatch: dropped a malformed batch for session %s (first index %d)"), *SessionId->ToString(), Batch.FirstIndex);
+            return;
+        }
+        if (Session->bEnded)
+        {
+            TryCacheClip(*Session); // a retransmission may have completed the clip
+        }
+    }
+
+    if (RelayMode == EAudioReplicatorRelayMode::Multicast)
+    {
+        if (Session)
+        {
+            const UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr;
+            Session->BatchesRelayed++;
+            Session->BytesRelayed += (int64)Batch.Payload.Num() * (NetDriver ? NetDriver->ClientConnections.Num() : 0);
+            if (Session->Header.bLive)
+            {
+                ReportRelayCongestion(*SessionId, *Session);
+            }
+        }
+        if (bReliable)
+        {
+            Multicast_SendChunkBatch(Batch);
+        }
+        else
+        {
+            Multicast_SendChunkBatchUnreliable(Batch);
+        }
+        return;
+    }
+
+    if (!Session)
+        return;
+
+    // One copy for all recipients; only the handle differs and RPC parameters are serialized on the call.
+    FOpusChunkBatch Routed = Batch;
+    for (const FRelayRecipient& Recipient : Session->Recipients)
+    {
+        UAudioReplicatorComponent* Endpoint = Recipient.Endpoint.Get();
+        if (!Endpoint)
+            continue; // the listener left
+
+        // Catch-ups to this player get what the relayed traffic leaves of its connection budget.
+        const AActor* EndpointOwner = Endpoint->GetOwner();
+        if (EndpointOwner && EndpointOwner->GetNetConnection())
+        {
+            Endpoint->GetPacer().Consume(Batch.Payload.Num() + 8);
+        }
+
+        Routed.SessionHandle = Recipient.Handle;
+        if (bReliable)
+        {
+            Endpoint->Client_RelayChunkBatch(Routed);
+        }
+        else
+        {
+            Endpoint->Client_RelayChunkBatchUnreliable(Routed);
+        }
+        Session->BytesRelayed += Routed.Payload.Num();
+    }
+    Session->BatchesRelayed++;
+
+    if (Session->Header.bLive)
+    {
+        ReportRelayCongestion(*SessionId, *Session);
+    }
+}
+
+void UAudioReplicatorComponent::ReportRelayCongestion(const FGuid& SessionId, FRelaySession& Session)
+{
+    const double Now = FPlatformTime::Seconds();
+    if (Session.CongestionReportTime >= 0.0 && Now - Session.CongestionReportTime < CongestionReportIntervalSec)
+        return;
+
+    // With many talkers it is the links to the listeners that fill up; each sender backs off a little
+    // instead of every stream stalling behind the queued RPCs.
+    bool bCongested = false;
+    if (RelayMode == EAudioReplicatorRelayMode::Multicast)
+    {
+        const UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr;
+        if (NetDriver)
+        {
+            for (UNetConnection* Connection : NetDriver->ClientConnections)
+            {
+                if (IsConnectionSaturated(Connection))
+                {
+                    bCongested = true;
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (const FRelayRecipient& Recipient : Session.Recipients)
+        {
+            const UAudioReplicatorComponent* Endpoint = Recipient.Endpoint.Get();
+            const AActor* EndpointOwner = Endpoint ? Endpoint->GetOwner() : nullptr;
+            if (EndpointOwner && IsConnectionSaturated(EndpointOwner->GetNetConnection()))
+            {
+                bCongested = true;
+                break;
+            }
+        }
+    }
+
+    if (bCongested)
+    {
+        Session.CongestionReportTime = Now;
+        Client_ReportNetworkFeedback(SessionId, INDEX_NONE, true);
+    }
+}
+
+void UAudioReplicatorComponent::Server_EndTransfer_Implementation(const FGuid& SessionId, int32 NumPackets)
+{
+    FRelaySession* Session = ServerSessions.Find(SessionId);
+    if (!IsValidPacketCount(NumPackets, Session ? Session->Header.FrameMs : 0))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Server_EndTransfer: rejected end of session %s with %d packets"), *SessionId.ToString(), NumPackets);
+        return;
+    }
+    if (Session && Session->bServedFromCache)
+        return;
+
+    if (Session)
+    {
+        Session->bEnded = true;
+        Session->EndedTime = FPlatformTime::Seconds();
+        if (NumPackets > 0)
+        {
+            Session->Header.NumPackets = NumPackets;
+        }
+
+        // Chunks lost between the owner and the server: ask the owner to send them again reliably.
+        if (!Session->Header.bLive && NumPackets > 0)
+        {
+            GrowRelayPackets(*Session, NumPackets);
+
+            TArray<int32> Missing;
+            for (int32 Index = 0; Index < NumPackets; ++Index)
+            {
+                if (Session->Packets[Index].Data.Num() == 0)
+                {
+                    Missing.Add(Index);
+                }
+            }
+            if (Missing.Num() > 0)
+            {
+                Client_ResendChunks(SessionId, Missing);
+            }
+        }
+
+        for (const FRelayRecipient& Recipient : Session->Recipients)
+        {
+            UAudioReplicatorComponent* Endpoint = Recipient.Endpoint.Get();
+            if (Endpoint && !Endpoint->HasPendingCatchUp(SessionId))
+            {
+                Endpoint->Client_RelayEndTransfer(SessionId, Recipient.Handle, NumPackets);
+            }
+        }
+
+        TryCacheClip(*Session);
+    }
 
-    if (In.Header.NumPackets > 0 && Chunk.Index >= 0 && Chunk.Index < In.Packets.Num())
+    if (RelayMode == EAudioReplicatorRelayMode::Multicast)
     {
-        In.Packets[Chunk.Index] = Chunk.Packet;
+        Multicast_EndTransfer(SessionId, NumPackets);
+    }
+}
+
+void UAudioReplicatorComponent::Server_RequestCatchUp_Implementation(UAudioReplicatorComponent* Source, const FGuid& SessionId, uint16 SourceHandle)
+{
+    FGuid ResolvedId = SessionId;
+    if (!ResolvedId.IsValid() && Source)
+    {
+        if (const FGuid* Found = Source->SessionHandles.Find(SourceHandle))
+        {
+            ResolvedId = *Found;
+        }
+    }
+
+    UAudioReplicatorComponent* Owner = Source;
+    FRelaySession* Session = Owner ? Owner->ServerSessions.Find(ResolvedId) : nullptr;
+    if (!Session && ResolvedId.IsValid())
+    {
+        // The requester kept the session on its endpoint because the source was not relevant there.
+        const UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+        Owner = Subsystem ? Subsystem->FindRelayOwner(ResolvedId) : nullptr;
+        Session = Owner ? Owner->ServerSessions.Find(ResolvedId) : nullptr;
+    }
+    if (!Session)
+        return; // unknown or already expired
+
+    // Same rule as the relay itself: a team or proximity session is not replayed to anyone outside it.
+    if (!Owner->IsRelayListener(*Session, this))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Server_RequestCatchUp: %s is not a listener of session %s"), *GetNameSafe(GetOwner()), *ResolvedId.ToString());
+        return;
+    }
+
+    const uint16 Handle = Owner->SendCatchUp(this, ResolvedId, *Session, (Owner == Source) ? SourceHandle : 0);
+
+    // Relayed sessions that are still running continue to this player under the new handle.
+    if (Owner->RelayMode != EAudioReplicatorRelayMode::Multicast && !Session->bEnded)
+    {
+        FRelayRecipient* Existing = Session->Recipients.FindByPredicate([this](const FRelayRecipient& Recipient)
+        {
+            return Recipient.Endpoint.Get() == this;
+        });
+        FRelayRecipient& Recipient = Existing ? *Existing : Session->Recipients.AddDefaulted_GetRef();
+        Recipient.Endpoint = this;
+        Recipient.Handle = Handle;
+    }
+}
+
+void UAudioReplicatorComponent::Server_RequestChunks_Implementation(UAudioReplicatorComponent* Source, const FGuid& SessionId, const TArray<int32>& Indices)
+{
+    UAudioReplicatorComponent* Owner = (Source && Source->ServerSessions.Contains(SessionId)) ? Source : nullptr;
+    if (!Owner)
+    {
+        // The requester kept the session on its endpoint because the source was not relevant there.
+        const UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+        Owner = Subsystem ? Subsystem->FindRelayOwner(SessionId) : nullptr;
+    }
+
+    const FRelaySession* Session = Owner ? Owner->ServerSessions.Find(SessionId) : nullptr;
+    if (!Session || Session->Header.bLive)
+        return;
+
+    if (!Owner->IsRelayListener(*Session, this))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Server_RequestChunks: %s is not a listener of session %s"), *GetNameSafe(GetOwner()), *SessionId.ToString());
+        return;
+    }
+
+    // Indices come from the client: only frames of the clip, each once, and no more than one request's worth.
+    TArray<int32> Wanted;
+    Wanted.Reserve(FMath::Min(Indices.Num(), Session->Packets.Num()));
+    for (const int32 Index : Indices)
+    {
+        if (Session->Packets.IsValidIndex(Index))
+        {
+            Wanted.Add(Index);
+        }
+    }
+    Wanted.Sort();
+    int32 NumUnique = 0;
+    for (int32 i = 0; i < Wanted.Num(); ++i)
+    {
+        if (NumUnique == 0 || Wanted[i] != Wanted[NumUnique - 1])
+        {
+            Wanted[NumUnique++] = Wanted[i];
+        }
+    }
+    if (NumUnique > MaxRetransmitIndices)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Server_RequestChunks: %d frames of session %s requested, sending the first %d"), NumUnique, *SessionId.ToString(), MaxRetransmitIndices);
+        NumUnique = MaxRetransmitIndices;
+    }
+    Wanted.SetNum(NumUnique);
+    if (Wanted.Num() == 0)
+        return;
+
+    // The frames go out through the player's pacer like a catch-up; a newer request for the session
+    // replaces the one still queued.
+    FRelayRetransmit* Existing = PendingRetransmits.FindByPredicate([&SessionId](const FRelayRetransmit& Retransmit)
+    {
+        return Retransmit.SessionId == SessionId;
+    });
+    FRelayRetransmit& Retransmit = Existing ? *Existing : PendingRetransmits.AddDefaulted_GetRef();
+    Retransmit.Owner = Owner;
+    Retransmit.Source = Source;
+    Retransmit.SessionId = SessionId;
+    Retransmit.Indices = MoveTemp(Wanted);
+    Retransmit.NextIndex = 0;
+
+    PumpCatchUps(FPlatformTime::Seconds());
+}
+
+void UAudioReplicatorComponent::Server_ReportLoss_Implementation(UAudioReplicatorComponent* Source, const FGuid& SessionId, int32 LossPercent)
+{
+    UAudioReplicatorComponent* Owner = (Source && Source->ServerSessions.Contains(SessionId)) ? Source : nullptr;
+    if (!Owner)
+    {
+        // The reporter kept the session on its endpoint because the source was not relevant there.
+        const UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+        Owner = Subsystem ? Subsystem->FindRelayOwner(SessionId) : nullptr;
+    }
+
+    const FRelaySession* Session = Owner ? Owner->ServerSessions.Find(SessionId) : nullptr;
+    if (!Session || !Session->Header.bLive || Session->bEnded)
+        return;
+
+    // Only a player the session is relayed to may steer its bitrate; never the originator itself.
+    const UNetConnection* Connection = GetOwner() ? GetOwner()->GetNetConnection() : nullptr;
+    const UNetConnection* OriginConnection = Owner->GetOwner() ? Owner->GetOwner()->GetNetConnection() : nullptr;
+    if (Owner == this || (Connection && Connection == OriginConnection))
+        return;
+
+    bool bRecipient = false;
+    if (Owner->RelayMode == EAudioReplicatorRelayMode::Multicast)
+    {
+        const UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr;
+        bRecipient = Connection && NetDriver && NetDriver->ClientConnections.Contains(Connection);
     }
     else
     {
-        // When NumPackets is unknown, append sequentially
-        In.Packets.Add(Chunk.Packet);
+        bRecipient = Session->Recipients.ContainsByPredicate([this](const FRelayRecipient& Recipient)
+        {
+            return Recipient.Endpoint.Get() == this;
+        });
+    }
+    if (!bRecipient)
+        return;
+
+    Owner->Client_ReportNetworkFeedback(SessionId, FMath::Clamp(LossPercent, 0, 100), false);
+}
+
+// ================= CLIENT RPC =================
+
+void UAudioReplicatorComponent::Client_ReportNetworkFeedback_Implementation(const FGuid& SessionId, int32 LossPercent, bool bCongested)
+{
+    FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (!Tr || !Tr->Header.bLive || Tr->bEndSent)
+        return;
+
+    const double Now = FPlatformTime::Seconds();
+    if (bCongested)
+    {
+        Tr->CongestionReportTime = Now;
+    }
+    if (LossPercent >= 0)
+    {
+        // Receivers report independently; the worst one in the current window counts.
+        if (Tr->LossReportTime < 0.0 || Now - Tr->LossReportTime >= LossReportHoldSec)
+        {
+            Tr->ReportedLossPercent = LossPercent;
+            Tr->LossReportTime = Now;
+        }
+        else
+        {
+            Tr->ReportedLossPercent = FMath::Max(Tr->ReportedLossPercent, LossPercent);
+        }
+    }
+}
+
+void UAudioReplicatorComponent::Client_ResendChunks_Implementation(const FGuid& SessionId, const TArray<int32>& Indices)
+{
+    FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (!Tr || Tr->Header.bLive)
+        return; // already expired, or a live session whose chunks are gone
+
+    // Re-send consecutive runs of the requested indices as reliable batches.
+    for (int32 i = 0; i < Indices.Num();)
+    {
+        const int32 First = Indices[i];
+        int32 Count = 1;
+        while (i + Count < Indices.Num() && Indices[i + Count] == First + Count)
+        {
+            ++Count;
+        }
+        if (Tr->Packets.IsValidIndex(First))
+        {
+            SendChunkBatches(*Tr, First, Count, INDEX_NONE, /*bReliable=*/true);
+        }
+        i += Count;
+    }
+}
+
+void UAudioReplicatorComponent::Client_ClipOfferResult_Implementation(const FGuid& SessionId, bool bCached)
+{
+    FOutgoingTransfer* Tr = Outgoing.Find(SessionId);
+    if (!Tr)
+        return; // cancelled
+
+    // A late reply: the offer timed out and the upload already started. A miss changes nothing; after a
+    // hit the server played the clip from its cache and ignores the upload, so stop sending it (a clip
+    // still encoding finishes first, so OnBroadcastEncoded fires).
+    const bool bLate = !Tr->bAwaitingCacheReply;
+    if (bLate && (!bCached || Tr->bEncoding))
+        return;
+
+    if (bCached)
+    {
+        // The server broadcast the clip from its cache; nothing to upload.
+        if (Tr->bStreaming)
+        {
+            // Kept until the producer appends again, so it learns to stop.
+            Tr->bAwaitingCacheReply = false;
+            Tr->bServedFromCache = true;
+            Tr->Packets.Empty();
+            return;
+        }
+        Outgoing.Remove(SessionId);
+        return;
+    }
+
+    if (!FinishClipOffer(*Tr))
+    {
+        Outgoing.Remove(SessionId);
+    }
+}
+
+void UAudioReplicatorComponent::Client_ReceiveChunks_Implementation(UAudioReplicatorComponent* Source, const FGuid& SessionId, const TArray<FOpusChunk>& Chunks)
+{
+    // The source actor may not be relevant here; the session id is unique, so keep it on the endpoint then.
+    UAudioReplicatorComponent* Target = Source ? Source : this;
+    for (const FOpusChunk& Chunk : Chunks)
+    {
+        Target->HandleIncomingChunk(SessionId, Chunk);
+    }
+}
+
+void UAudioReplicatorComponent::Client_RelayStartTransfer_Implementation(UAudioReplicatorComponent* Source, const FGuid& SessionId, uint16 Handle, uint16 SourceHandle, const FOpusStreamHeader& Header)
+{
+    // The source actor may not be relevant here; the session id is unique, so keep it on the endpoint then.
+    UAudioReplicatorComponent* Target = Source ? Source : this;
+
+    FRelayBinding& Binding = RelayBindings.Add(Handle);
+    Binding.SessionId = SessionId;
+    Binding.Target = Target;
+
+    Target->HandleStartTransfer(SessionId, Header);
+
+    // Catch-up of a multicast session: its regular batches carry the sender's handle.
+    if (Source && SourceHandle != 0)
+    {
+        Source->ResolveParkedBatches(SourceHandle, SessionId);
+    }
+
+    // Batches that arrived before this start message can be resolved now.
+    TArray<FOpusChunkBatch> Parked;
+    for (int32 i = UnresolvedRelayBatches.Num() - 1; i >= 0; --i)
+    {
+        if (UnresolvedRelayBatches[i].SessionHandle == Handle)
+        {
+            Parked.Insert(MoveTemp(UnresolvedRelayBatches[i]), 0);
+            UnresolvedRelayBatches.RemoveAt(i);
+        }
+    }
+    for (const FOpusChunkBatch& Batch : Parked)
+    {
+        HandleRelayedBatch(Batch);
+    }
+}
+
+void UAudioReplicatorComponent::Client_RelayChunkBatch_Implementation(const FOpusChunkBatch& Batch)
+{
+    HandleRelayedBatch(Batch);
+}
+
+void UAudioReplicatorComponent::Client_RelayChunkBatchUnreliable_Implementation(const FOpusChunkBatch& Batch)
+{
+    HandleRelayedBatch(Batch);
+}
+
+void UAudioReplicatorComponent::Client_RelayEndTransfer_Implementation(const FGuid& SessionId, uint16 Handle, int32 NumPackets)
+{
+    FRelayBinding Binding;
+    if (!RelayBindings.RemoveAndCopyValue(Handle, Binding) || !Binding.Target.IsValid())
+    {
+        HandleEndTransfer(SessionId, NumPackets);
+        return;
+    }
+    Binding.Target->HandleEndTransfer(SessionId, NumPackets);
+}
+
+void UAudioReplicatorComponent::HandleRelayedBatch(const FOpusChunkBatch& Batch)
+{
+    const FRelayBinding* Binding = RelayBindings.Find(Batch.SessionHandle);
+    if (!Binding)
+    {
+        ParkBatch(UnresolvedRelayBatches, Batch);
+        return;
+    }
+
+    UAudioReplicatorComponent* Target = Binding->Target.IsValid() ? Binding->Target.Get() : this;
+    Target->DeliverBatch(Binding->SessionId, Batch);
+}
+
+// ================= MULTICAST RPC =================
+
+void UAudioReplicatorComponent::Multicast_StartTransfer_Implementation(const FGuid& SessionId, uint16 SessionHandle, const FOpusStreamHeader& Header)
+{
+    HandleStartTransfer(SessionId, Header);
+    ResolveParkedBatches(SessionHandle, SessionId);
+}
+
+void UAudioReplicatorComponent::ResolveParkedBatches(uint16 SessionHandle, const FGuid& SessionId)
+{
+    SessionHandles.Add(SessionHandle, SessionId);
+    UnresolvedSince.Remove(SessionHandle);
+    CatchUpRequested.Remove(SessionHandle);
+
+    // Batches that arrived before the start message can be resolved now.
+    TArray<FOpusChunkBatch> Parked;
+    for (int32 i = UnresolvedBatches.Num() - 1; i >= 0; --i)
+    {
+        if (UnresolvedBatches[i].SessionHandle == SessionHandle)
+        {
+            Parked.Insert(MoveTemp(UnresolvedBatches[i]), 0);
+            UnresolvedBatches.RemoveAt(i);
+        }
+    }
+    for (const FOpusChunkBatch& Batch : Parked)
+    {
+        HandleIncomingBatch(Batch);
+    }
+}
+
+void UAudioReplicatorComponent::HandleStartTransfer(const FGuid& SessionId, const FOpusStreamHeader& Header)
+{
+    if (!IsValidPacketCount(Header.NumPackets, Header.FrameMs))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("HandleStartTransfer: rejected session %s with %d packets"), *SessionId.ToString(), Header.NumPackets);
+        return;
+    }
+    if (ClosedIncoming.Contains(SessionId))
+        return; // a catch-up set off by late batches of a session this player already dropped
+
+    // A replay of a session still held reuses its entry.
+    FIncomingTransfer& In = Incoming.FindOrAdd(SessionId);
+    In.LastUseTime = FPlatformTime::Seconds();
+    if (In.bEnded)
+    {
+        // Replay of a finished session: play it again from the start.
+        In.Jitter.Reset();
+        In.PlaybackWave = nullptr;
+        In.bPlaybackFinished = false;
+    }
+    In.Header = Header;
+    GrowIncomingPackets(In, Header.NumPackets);
+    In.bStarted = true;
+    In.bEnded = false;
+    StartLivePlayback(In);
+
+    OnTransferStarted.Broadcast(SessionId, Header);
+}
+
+void UAudioReplicatorComponent::Multicast_SendChunkBatch_Implementation(const FOpusChunkBatch& Batch)
+{
+    HandleIncomingBatch(Batch);
+}
+
+void UAudioReplicatorComponent::Multicast_SendChunkBatchUnreliable_Implementation(const FOpusChunkBatch& Batch)
+{
+    HandleIncomingBatch(Batch);
+}
+
+void UAudioReplicatorComponent::HandleIncomingBatch(const FOpusChunkBatch& Batch)
+{
+    const FGuid* SessionId = SessionHandles.Find(Batch.SessionHandle);
+    if (!SessionId)
+    {
+        // Either it overtook its start message or this player joined mid-session (see RequestCatchUps).
+        ParkBatch(UnresolvedBatches, Batch);
+        if (!UnresolvedSince.Contains(Batch.SessionHandle))
+        {
+            UnresolvedSince.Add(Batch.SessionHandle, FPlatformTime::Seconds());
+        }
+        return;
+    }
+    DeliverBatch(*SessionId, Batch);
+}
+
+void UAudioReplicatorComponent::ParkBatch(TArray<FOpusChunkBatch>& Parked, const FOpusChunkBatch& Batch)
+{
+    // Bounded: if the start message never shows up the oldest parked batches are dropped.
+    constexpr int32 MaxUnresolvedBatches = 64;
+    if (Parked.Num() >= MaxUnresolvedBatches)
+    {
+        Parked.RemoveAt(0);
+    }
+    Parked.Add(Batch);
+}
+
+void UAudioReplicatorComponent::DeliverBatch(const FGuid& SessionId, const FOpusChunkBatch& Batch)
+{
+    TArray<FOpusPacket> Packets;
+    if (!Chunking::UnpackWithLengths(Batch.Payload, Packets))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("DeliverBatch: malformed batch for session %s"), *SessionId.ToString());
+        return;
+    }
+
+    for (int32 i = 0; i < Packets.Num(); ++i)
+    {
+        FOpusChunk Chunk;
+        Chunk.Index = Batch.FirstIndex + i;
+        Chunk.Packet = MoveTemp(Packets[i]);
+        HandleIncomingChunk(SessionId, Chunk);
+    }
+}
+
+void UAudioReplicatorComponent::HandleIncomingChunk(const FGuid& SessionId, const FOpusChunk& Chunk)
+{
+    if (Chunk.Index < 0)
+        return;
+
+    // Chunks never create a session: batches wait for the start message that binds their handle, so
+    // a chunk without a session is a late retransmission or duplicate of one already dropped.
+    FIncomingTransfer* Found = Incoming.Find(SessionId);
+    if (!Found)
+        return;
+    FIncomingTransfer& In = *Found;
+
+    // Indices past the announced count, or past the session limit while the count is unknown, are bogus.
+    const int32 MaxIndex = In.Header.NumPackets > 0 ? In.Header.NumPackets : GetMaxPacketsPerSession(In.Header.FrameMs);
+    if (Chunk.Index >= MaxIndex)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("HandleIncomingChunk: dropped chunk %d of session %s (limit %d)"), Chunk.Index, *SessionId.ToString(), MaxIndex);
+        return;
+    }
+
+    // Ensure the array has enough room; with an unknown NumPackets it grows with the highest index seen
+    GrowIncomingPackets(In, FMath::Max(In.Header.NumPackets, Chunk.Index + 1));
+
+    if (In.Header.bLive && HandleLiveSilence(In, Chunk.Index, Chunk.Packet.Data.Num() == 0))
+        return;
+
+    // Chunks below the trimmed range of a live session arrive too late to be worth storing.
+    if (Chunk.Index >= In.FirstRetainedIndex)
+    {
+        if (In.Packets[Chunk.Index].Data.Num() == 0 && Chunk.Packet.Data.Num() > 0)
+        {
+            ++In.UniqueChunks;
+            In.UniqueBytes += Chunk.Packet.Data.Num();
+            In.Gaps.Add(Chunk.Index);
+        }
+        const int64 DeltaBytes = (int64)Chunk.Packet.Data.Num() - In.Packets[Chunk.Index].Data.Num();
+        In.Packets[Chunk.Index] = Chunk.Packet;
+        In.Bytes += DeltaBytes;
+        IncomingBytes += DeltaBytes;
+    }
+    In.LastUseTime = FPlatformTime::Seconds();
+
+    if (In.Jitter.IsValid())
+    {
+        In.Jitter->Insert(Chunk.Index, Chunk.Packet.Data);
+    }
+    if (In.Recorder.IsValid())
+    {
+        In.Recorder->Insert(Chunk.Index, Chunk.Packet.Data);
     }
 
     In.Received++;
     OnChunkReceived.Broadcast(SessionId, Chunk);
+
+    // The last retransmitted frame of a clip that ended incomplete closes its recording. Looked up again:
+    // a handler may have released the session.
+    FIncomingTransfer* Done = Incoming.Find(SessionId);
+    if (Done && Done->Recorder.IsValid() && Done->RecordingDeadline > 0.0 && Done->UniqueChunks >= Done->Header.NumPackets)
+    {
+        FinishRecording(SessionId, *Done, Done->Header.NumPackets);
+    }
+}
+
+bool UAudioReplicatorComponent::HandleLiveSilence(FIncomingTransfer& In, int32 Index, bool bMarker)
+{
+    if (bMarker)
+    {
+        // The sender went quiet at Index and sends nothing more until it speaks again.
+        if (Index > In.Gaps.GetHighest())
+        {
+            In.Gaps.Add(Index);
+            ++In.UniqueChunks;
+            In.SilentFrom = Index;
+        }
+        if (In.Jitter.IsValid())
+        {
+            In.Jitter->Insert(Index, TArray<uint8>());
+        }
+        In.LastUseTime = FPlatformTime::Seconds();
+        return true;
+    }
+
+    // The first frame after a silence: the frames in between were not lost.
+    if (In.SilentFrom != INDEX_NONE && Index > In.SilentFrom)
+    {
+        const int32 First = In.SilentFrom + 1;
+        if (Index > First)
+        {
+            // Newly seen frames: the growth of the tracked range minus the growth of its gaps.
+            const int32 Highest = In.Gaps.GetHighest();
+            const int32 NumMissing = In.Gaps.GetNumMissing();
+            In.Gaps.AddRange(First, Index);
+            In.UniqueChunks += (In.Gaps.GetHighest() - Highest) - (In.Gaps.GetNumMissing() - NumMissing);
+        }
+        if (In.Recorder.IsValid())
+        {
+            In.Recorder->InsertSilence(In.SilentFrom, Index);
+        }
+        In.SilentFrom = INDEX_NONE;
+    }
+    return false;
+}
+
+void UAudioReplicatorComponent::Multicast_EndTransfer_Implementation(const FGuid& SessionId, int32 NumPackets)
+{
+    HandleEndTransfer(SessionId, NumPackets);
 }
 
-void UAudioReplicatorComponent::Multicast_EndTransfer_Implementation(const FGuid& SessionId)
+void UAudioReplicatorComponent::HandleEndTransfer(const FGuid& SessionId, int32 NumPackets)
 {
-    if (FIncomingTransfer* In = Incoming.Find(SessionId))
+    FIncomingTransfer* In = Incoming.Find(SessionId);
+    if (In && !IsValidPacketCount(NumPackets, In->Header.FrameMs))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("HandleEndTransfer: rejected end of session %s with %d packets"), *SessionId.ToString(), NumPackets);
+        return;
+    }
+
+    if (In)
     {
         In->bEnded = true;
+        In->LastUseTime = FPlatformTime::Seconds();
+        if (NumPackets > 0)
+        {
+            In->Header.NumPackets = NumPackets;
+            GrowIncomingPackets(*In, NumPackets);
+        }
+        if (In->Jitter.IsValid())
+        {
+            In->Jitter->MarkEnded(In->Header.NumPackets);
+        }
+        const AActor* Owner = GetOwner();
+        const bool bRetransmit = bRetransmitLostChunks && !In->Header.bLive && Owner && !Owner->HasAuthority();
+        if (bRetransmit)
+        {
+            RequestMissingChunks(SessionId, *In);
+        }
+
+        // Frames re-sent after the end belong in the recording too: it closes when the last one arrives
+        // (HandleIncomingChunk) or when the retransmission window is over (TrimIncomingSessions).
+        if (In->Recorder.IsValid())
+        {
+            if (bRetransmit && In->UniqueChunks < In->Header.NumPackets)
+            {
+                In->RecordingDeadline = In->LastUseTime + RetransmitWindowSec;
+            }
+            else
+            {
+                FinishRecording(SessionId, *In, In->Header.NumPackets);
+            }
+        }
     }
     OnTransferEnded.Broadcast(SessionId);
 }
 
+void UAudioReplicatorComponent::RequestMissingChunks(const FGuid& SessionId, const FIncomingTransfer& In)
+{
+    TArray<int32> Missing;
+    for (int32 Index = 0; Index < In.Header.NumPackets && Index < In.Packets.Num(); ++Index)
+    {
+        if (In.Packets[Index].Data.Num() == 0)
+        {
+            Missing.Add(Index);
+        }
+    }
+    if (Missing.Num() == 0)
+        return;
+
+    UAudioReplicatorSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UAudioReplicatorSubsystem>() : nullptr;
+    UAudioReplicatorComponent* Endpoint = Subsystem ? Subsystem->FindLocalEndpoint() : nullptr;
+    if (!Endpoint)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("RequestMissingChunks: no locally owned component to send the request through (%d missing)"), Missing.Num());
+        return;
+    }
+
+    Endpoint->Server_RequestChunks(this, SessionId, Missing);
+}
+
 // No replicated properties yet, but keep the hook for future use
 void UAudioReplicatorComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
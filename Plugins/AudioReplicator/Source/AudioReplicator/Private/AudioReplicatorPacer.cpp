@@ -0,0 +1,45 @@
+#include "AudioReplicatorPacer.h"
+
+namespace
+{
+    // Length of the window the achieved send rate is averaged over.
+    constexpr double RateWindowSec = 1.0;
+}
+
+void FAudioReplicatorPacer::Configure(int32 InBytesPerSec, int32 InBurstBytes)
+{
+    BytesPerSec = FMath::Max(0, InBytesPerSec);
+    BurstBytes = FMath::Max(1, InBurstBytes);
+    Tokens = FMath::Min(Tokens, (double)BurstBytes);
+}
+
+void FAudioReplicatorPacer::Refill(double Now)
+{
+    if (LastRefillTime < 0.0)
+    {
+        // First use: start with a full bucket.
+        Tokens = BurstBytes;
+        LastRefillTime = Now;
+        WindowStartTime = Now;
+        return;
+    }
+
+    const double Elapsed = FMath::Max(0.0, Now - LastRefillTime);
+    LastRefillTime = Now;
+    Tokens = FMath::Min((double)BurstBytes, Tokens + Elapsed * BytesPerSec);
+
+    const double WindowSec = Now - WindowStartTime;
+    if (WindowSec >= RateWindowSec)
+    {
+        SendRateBytesPerSec = (float)(WindowBytes / WindowSec);
+        WindowBytes = 0;
+        WindowStartTime = Now;
+    }
+}
+
+void FAudioReplicatorPacer::Consume(int32 Bytes)
+{
+    Tokens = FMath::Max(-(double)BurstBytes, Tokens - Bytes);
+    WindowBytes += Bytes;
+    TotalBytesSent += Bytes;
+}
@@ -0,0 +1,143 @@
+#include "AudioReplicatorSubsystem.h"
+#include "AudioReplicatorComponent.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+
+void UAudioReplicatorSubsystem::RegisterComponent(UAudioReplicatorComponent* Component)
+{
+    if (Component)
+    {
+        Components.AddUnique(Component);
+    }
+}
+
+void UAudioReplicatorSubsystem::UnregisterComponent(UAudioReplicatorComponent* Component)
+{
+    Components.RemoveAll([Component](const TWeakObjectPtr<UAudioReplicatorComponent>& Entry)
+    {
+        return !Entry.IsValid() || Entry.Get() == Component;
+    });
+}
+
+UAudioReplicatorComponent* UAudioReplicatorSubsystem::FindLocalEndpoint() const
+{
+    for (const TWeakObjectPtr<UAudioReplicatorComponent>& Entry : Components)
+    {
+        UAudioReplicatorComponent* Component = Entry.Get();
+        const AActor* Owner = Component ? Component->GetOwner() : nullptr;
+        if (Owner && Owner->HasLocalNetOwner())
+        {
+            return Component;
+        }
+    }
+    return nullptr;
+}
+
+UAudioReplicatorComponent* UAudioReplicatorSubsystem::FindEndpointForConnection(const UNetConnection* Connection) const
+{
+    if (!Connection)
+        return nullptr;
+
+    for (const TWeakObjectPtr<UAudioReplicatorComponent>& Entry : Components)
+    {
+        UAudioReplicatorComponent* Component = Entry.Get();
+        const AActor* Owner = Component ? Component->GetOwner() : nullptr;
+        if (Owner && Owner->GetNetConnection() == Connection)
+        {
+            return Component;
+        }
+    }
+    return nullptr;
+}
+
+void UAudioReplicatorSubsystem::GetListenerEndpoints(TArray<UAudioReplicatorComponent*>& OutEndpoints) const
+{
+    OutEndpoints.Reset();
+
+    TSet<const UNetConnection*> SeenConnections;
+    bool bHaveLocal = false;
+    const bool bListenServer = GetWorld() && GetWorld()->GetNetMode() == NM_ListenServer;
+
+    for (const TWeakObjectPtr<UAudioReplicatorComponent>& Entry : Components)
+    {
+        UAudioReplicatorComponent* Component = Entry.Get();
+        const AActor* Owner = Component ? Component->GetOwner() : nullptr;
+        if (!Owner)
+            continue;
+
+        // Several components may share a player (controller and pawn); the first one is its endpoint.
+        if (const UNetConnection* Connection = Owner->GetNetConnection())
+        {
+            bool bAlreadySeen = false;
+            SeenConnections.Add(Connection, &bAlreadySeen);
+            if (!bAlreadySeen)
+            {
+                OutEndpoints.Add(Component);
+            }
+        }
+        else if (bListenServer && !bHaveLocal && Owner->HasLocalNetOwner())
+        {
+            bHaveLocal = true;
+            OutEndpoints.Add(Component);
+        }
+    }
+}
+
+UAudioReplicatorComponent* UAudioReplicatorSubsystem::FindRelayOwner(const FGuid& SessionId) const
+{
+    for (const TWeakObjectPtr<UAudioReplicatorComponent>& Entry : Components)
+    {
+        UAudioReplicatorComponent* Component = Entry.Get();
+        if (Component && Component->IsRelaying(SessionId))
+        {
+            return Component;
+        }
+    }
+    return nullptr;
+}
+
+FAudioReplicatorPacer& UAudioReplicatorSubsystem::GetConnectionPacer(const UNetConnection* Connection)
+{
+    if (!Connection)
+        return LocalPacer;
+
+    if (FAudioReplicatorPacer* Found = ConnectionPacers.Find(Connection))
+        return *Found;
+
+    // Closed connections are dropped whenever a new one shows up.
+    for (auto It = ConnectionPacers.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+    return ConnectionPacers.Add(Connection);
+}
+
+const FAudioReplicatorPacer* UAudioReplicatorSubsystem::FindConnectionPacer(const UNetConnection* Connection) const
+{
+    return Connection ? ConnectionPacers.Find(Connection) : &LocalPacer;
+}
+
+void UAudioReplicatorSubsystem::SetClipCacheMaxBytes(int64 MaxBytes)
+{
+    ClipCache.SetMaxBytes(MaxBytes);
+}
+
+void UAudioReplicatorSubsystem::EmptyClipCache()
+{
+    ClipCache.Empty();
+}
+
+void UAudioReplicatorSubsystem::GetClipCacheStats(FAudioReplicatorClipCacheStats& OutStats) const
+{
+    const FOpusClipCache::FStats Stats = ClipCache.GetStats();
+    OutStats = FAudioReplicatorClipCacheStats();
+    OutStats.Hits = Stats.Hits;
+    OutStats.Misses = Stats.Misses;
+    OutStats.Evictions = Stats.Evictions;
+    OutStats.NumClips = Stats.NumClips;
+    OutStats.Bytes = Stats.Bytes;
+    OutStats.MaxBytes = Stats.MaxBytes;
+}
@@ -16,24 +16,30 @@ namespace Chunking
 
         for (const auto& P : Packets)
         {
-            const int32 n = P.Data.Num();
-            if (n < 0 || n > 65535)
-            {
-                UE_LOG(LogTemp, Warning, TEXT("PackWithLengths: packet too large (%d bytes)"), n);
-                continue;
-            }
+            AppendWithLength(P.Data, OutBuffer);
+        }
+    }
 
-            OutBuffer.Add((uint8)(n & 0xFF));
-            OutBuffer.Add((uint8)((n >> 8) & 0xFF));
+    bool AppendWithLength(TArrayView<const uint8> Packet, TArray<uint8>& OutBuffer)
+    {
+        const int32 n = Packet.Num();
+        if (n < 0 || n > 65535)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("PackWithLengths: packet too large (%d bytes)"), n);
+            return false;
+        }
 
-            if (n > 0)
-            {
-                OutBuffer.Append(P.Data.GetData(), n);
-            }
+        OutBuffer.Add((uint8)(n & 0xFF));
+        OutBuffer.Add((uint8)((n >> 8) & 0xFF));
+
+        if (n > 0)
+        {
+            OutBuffer.Append(Packet.GetData(), n);
         }
+        return true;
     }
 
-    bool UnpackWithLengths(const TArray<uint8>& Buffer, TArray<FOpusPacket>& OutPackets)
+    bool UnpackWithLengths(TArrayView<const uint8> Buffer, TArray<FOpusPacket>& OutPackets)
     {
         OutPackets.Reset();
         const int32 N = Buffer.Num();
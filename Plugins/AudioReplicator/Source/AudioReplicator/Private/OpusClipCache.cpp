@@ -0,0 +1,86 @@
+#include "OpusClipCache.h"
+
+FOpusClipCache::FOpusClipCache(int64 InMaxBytes)
+    : MaxBytes(FMath::Max<int64>(0, InMaxBytes))
+{
+}
+
+const FOpusClipCache::FEntry* FOpusClipCache::Find(const FGuid& Hash)
+{
+    FEntry* Entry = Entries.Find(Hash);
+    if (!Entry)
+    {
+        ++Misses;
+        return nullptr;
+    }
+
+    ++Hits;
+    Entry->LastUse = ++UseCounter;
+    return Entry;
+}
+
+void FOpusClipCache::Add(const FGuid& Hash, const FOpusStreamHeader& Header, TArray<uint8>&& Packed)
+{
+    if (Packed.Num() > MaxBytes)
+        return;
+
+    if (FEntry* Existing = Entries.Find(Hash))
+    {
+        Bytes -= Existing->Packed.Num();
+        Entries.Remove(Hash);
+    }
+
+    EvictToFit(Packed.Num());
+
+    FEntry& Entry = Entries.Add(Hash);
+    Entry.Header = Header;
+    Entry.Packed = MoveTemp(Packed);
+    Entry.LastUse = ++UseCounter;
+    Bytes += Entry.Packed.Num();
+}
+
+void FOpusClipCache::SetMaxBytes(int64 InMaxBytes)
+{
+    MaxBytes = FMath::Max<int64>(0, InMaxBytes);
+    EvictToFit(0);
+}
+
+void FOpusClipCache::Empty()
+{
+    Entries.Empty();
+    Bytes = 0;
+}
+
+FOpusClipCache::FStats FOpusClipCache::GetStats() const
+{
+    FStats Out;
+    Out.Hits = Hits;
+    Out.Misses = Misses;
+    Out.Evictions = Evictions;
+    Out.NumClips = Entries.Num();
+    Out.Bytes = Bytes;
+    Out.MaxBytes = MaxBytes;
+    return Out;
+}
+
+void FOpusClipCache::EvictToFit(int64 NeededBytes)
+{
+    // Linear scan per eviction: the cache holds tens of clips, not thousands.
+    while (Entries.Num() > 0 && Bytes + NeededBytes > MaxBytes)
+    {
+        const FGuid* OldestKey = nullptr;
+        uint64 OldestUse = MAX_uint64;
+        for (const TPair<FGuid, FEntry>& KV : Entries)
+        {
+            if (KV.Value.LastUse < OldestUse)
+            {
+                OldestUse = KV.Value.LastUse;
+                OldestKey = &KV.Key;
+            }
+        }
+        const FGuid Evicted = *OldestKey;
+        Bytes -= Entries[Evicted].Packed.Num();
+        Entries.Remove(Evicted);
+        ++Evictions;
+    }
+}
@@ -1,32 +1,92 @@
 #include "OpusCodec.h"
+#include "OpusPacketArena.h"
 #include <opus.h> // ThirdParty/Opus/Include
 
 namespace
 {
+    constexpr int32 MaxFrameSamplesPerCh = 5760; // 120 ms @ 48 kHz, the longest Opus frame
     constexpr int32 MaxPacketSize = 4000; //     
+
+    int ToOpusApplication(EOpusApplication Application)
+    {
+        switch (Application)
+        {
+        case EOpusApplication::Voip: return OPUS_APPLICATION_VOIP;
+        case EOpusApplication::RestrictedLowDelay: return OPUS_APPLICATION_RESTRICTED_LOWDELAY;
+        default: return OPUS_APPLICATION_AUDIO;
+        }
+    }
+
+    int ToOpusBandwidth(EOpusBandwidth Bandwidth)
+    {
+        switch (Bandwidth)
+        {
+        case EOpusBandwidth::Narrowband: return OPUS_BANDWIDTH_NARROWBAND;
+        case EOpusBandwidth::Mediumband: return OPUS_BANDWIDTH_MEDIUMBAND;
+        case EOpusBandwidth::Wideband: return OPUS_BANDWIDTH_WIDEBAND;
+        case EOpusBandwidth::Superwideband: return OPUS_BANDWIDTH_SUPERWIDEBAND;
+        default: return OPUS_BANDWIDTH_FULLBAND;
+        }
+    }
 }
 
-FOpusCodec::FOpusCodec(int32 InSR, int32 InCh, int32 InBitrate)
-    : SR(InSR), Ch(InCh), Bitrate(InBitrate)
+FOpusEncoderSettings FOpusEncoderSettings::FromProfile(EOpusEncoderProfile Profile)
 {
-    int Err = 0;
-
-    Encoder = opus_encoder_create(SR, Ch, OPUS_APPLICATION_AUDIO, &Err);
-    if (!Encoder || Err != OPUS_OK)
+    FOpusEncoderSettings Settings;
+    switch (Profile)
     {
-        Encoder = nullptr;
+    case EOpusEncoderProfile::Voice:
+        // Speech has little above 8 kHz; the bits go to the band that carries it.
+        Settings.Application = EOpusApplication::Voip;
+        Settings.Complexity = 5;
+        Settings.MaxBandwidth = EOpusBandwidth::Wideband;
+        break;
+    case EOpusEncoderProfile::LowLatency:
+        // CELT only; constant packet sizes keep the send rate flat.
+        Settings.Application = EOpusApplication::RestrictedLowDelay;
+        Settings.Complexity = 5;
+        Settings.bVbr = false;
+        break;
+    case EOpusEncoderProfile::Archival:
+        Settings.Complexity = 10;
+        break;
+    case EOpusEncoderProfile::MusicClip:
+    default:
+        break;
     }
-    else
+    return Settings;
+}
+
+FOpusCodec::FOpusCodec(int32 InSR, int32 InCh, int32 InBitrate, EOpusEncoderProfile InProfile, bool bWithEncoder, bool bWithDecoder)
+    : SR(InSR), Ch(InCh), Bitrate(InBitrate), Profile(InProfile)
+{
+    int Err = 0;
+    const FOpusEncoderSettings Settings = FOpusEncoderSettings::FromProfile(Profile);
+    Application = Settings.Application;
+
+    if (bWithEncoder)
     {
-        opus_encoder_ctl(Encoder, OPUS_SET_BITRATE(Bitrate));
-        opus_encoder_ctl(Encoder, OPUS_SET_VBR(1));
-        opus_encoder_ctl(Encoder, OPUS_SET_COMPLEXITY(8));
+        Encoder = opus_encoder_create(SR, Ch, ToOpusApplication(Application), &Err);
+        if (!Encoder || Err != OPUS_OK)
+        {
+            Encoder = nullptr;
+        }
+        else
+        {
+            opus_encoder_ctl(Encoder, OPUS_SET_BITRATE(Bitrate));
+            opus_encoder_ctl(Encoder, OPUS_SET_VBR(Settings.bVbr ? 1 : 0));
+            opus_encoder_ctl(Encoder, OPUS_SET_COMPLEXITY(Settings.Complexity));
+            opus_encoder_ctl(Encoder, OPUS_SET_MAX_BANDWIDTH(ToOpusBandwidth(Settings.MaxBandwidth)));
+        }
     }
 
-    Decoder = opus_decoder_create(SR, Ch, &Err);
-    if (!Decoder || Err != OPUS_OK)
+    if (bWithDecoder)
     {
-        Decoder = nullptr;
+        Decoder = opus_decoder_create(SR, Ch, &Err);
+        if (!Decoder || Err != OPUS_OK)
+        {
+            Decoder = nullptr;
+        }
     }
 }
 
@@ -38,7 +98,7 @@ FOpusCodec::~FOpusCodec()
 
 TUniquePtr<FOpusCodec> FOpusCodec::Create(int32 SampleRate, int32 Channels, int32 Bitrate)
 {
-    TUniquePtr<FOpusCodec> Ptr(new FOpusCodec(SampleRate, Channels, Bitrate));
+    TUniquePtr<FOpusCodec> Ptr(new FOpusCodec(SampleRate, Channels, Bitrate, EOpusEncoderProfile::MusicClip, true, true));
     if (!Ptr->Encoder || !Ptr->Decoder)
     {
         return nullptr;
@@ -46,65 +106,356 @@ TUniquePtr<FOpusCodec> FOpusCodec::Create(int32 SampleRate, int32 Channels, int3
     return Ptr;
 }
 
-bool FOpusCodec::EncodePcm16ToPackets(const TArray<int16>& Pcm, int32 FrameSizeSamplesPerCh, TArray<TArray<uint8>>& OutPackets)
+TUniquePtr<FOpusCodec> FOpusCodec::CreateEncoder(int32 SampleRate, int32 Channels, int32 Bitrate, EOpusEncoderProfile Profile)
+{
+    TUniquePtr<FOpusCodec> Ptr(new FOpusCodec(SampleRate, Channels, Bitrate, Profile, true, false));
+    if (!Ptr->Encoder)
+    {
+        return nullptr;
+    }
+    return Ptr;
+}
+
+TUniquePtr<FOpusCodec> FOpusCodec::CreateDecoder(int32 SampleRate, int32 Channels)
+{
+    TUniquePtr<FOpusCodec> Ptr(new FOpusCodec(SampleRate, Channels, 0, EOpusEncoderProfile::MusicClip, false, true));
+    if (!Ptr->Decoder)
+    {
+        return nullptr;
+    }
+    return Ptr;
+}
+
+int32 FOpusCodec::GetLookahead(int32 SampleRate, EOpusApplication Application)
+{
+    // 2.5 ms of MDCT overlap, plus 4 ms of delay compensation except in the restricted low-delay mode.
+    const int32 Overlap = SampleRate / 400;
+    return Application == EOpusApplication::RestrictedLowDelay ? Overlap : Overlap + SampleRate / 250;
+}
+
+int32 FOpusCodec::GetLookahead(int32 SampleRate, EOpusEncoderProfile Profile)
+{
+    return GetLookahead(SampleRate, FOpusEncoderSettings::FromProfile(Profile).Application);
+}
+
+int32 FOpusCodec::GetClipFrameCount(int64 NumSamplesPerCh, int32 FrameSizeSamplesPerCh, int32 PreSkip, int32& OutEndTrim)
+{
+    OutEndTrim = 0;
+    if (NumSamplesPerCh <= 0 || FrameSizeSamplesPerCh <= 0) return 0;
+
+    const int64 Needed = NumSamplesPerCh + FMath::Max(0, PreSkip);
+    const int64 NumFrames = (Needed + FrameSizeSamplesPerCh - 1) / FrameSizeSamplesPerCh;
+    OutEndTrim = (int32)(NumFrames * FrameSizeSamplesPerCh - Needed);
+    return (int32)FMath::Min<int64>(NumFrames, MAX_int32);
+}
+
+bool FOpusCodec::IsSupportedSampleRate(int32 SampleRate)
+{
+    return SampleRate == 8000 || SampleRate == 12000 || SampleRate == 16000 || SampleRate == 24000 || SampleRate == 48000;
+}
+
+int32 FOpusCodec::GetEncodeSampleRate(int32 SourceSampleRate)
+{
+    return IsSupportedSampleRate(SourceSampleRate) ? SourceSampleRate : AUDIO_REPL_OPUS_SR;
+}
+
+bool FOpusCodec::EncodeFrame(const int16* FramePcm, int32 FrameSizeSamplesPerCh, TArray<uint8>& OutPacket)
+{
+    if (!Encoder || !FramePcm || FrameSizeSamplesPerCh <= 0) return false;
+
+    OutPacket.SetNumUninitialized(MaxPacketSize);
+
+    const int EncBytes = opus_encode(
+        Encoder,
+        FramePcm,
+        FrameSizeSamplesPerCh,
+        OutPacket.GetData(),
+        OutPacket.Num()
+    );
+    if (EncBytes < 0)
+    {
+        OutPacket.Reset();
+        return false;
+    }
+
+    OutPacket.SetNum(EncBytes);
+    return true;
+}
+
+bool FOpusCodec::EncodePcm16ToPackets(const TArray<int16>& Pcm, int32 FrameSizeSamplesPerCh, TArray<TArray<uint8>>& OutPackets, int32& OutPreSkip, int32& OutEndTrim)
 {
     if (!Encoder || FrameSizeSamplesPerCh <= 0) return false;
 
     const int32 SamplesPerFrameTotal = FrameSizeSamplesPerCh * Ch;
-    int32 Offset = 0;
-    OutPackets.Reset();
+    OutPreSkip = GetLookahead(SR, Application);
+    const int32 NumFrames = GetClipFrameCount(Pcm.Num() / Ch, FrameSizeSamplesPerCh, OutPreSkip, OutEndTrim);
+    OutPackets.Reset(NumFrames);
 
-    while (Offset + SamplesPerFrameTotal <= Pcm.Num())
+    TArray<int16> Padded;
+    for (int32 i = 0; i < NumFrames; ++i)
     {
-        const int16* FramePtr = Pcm.GetData() + Offset;
+        const int32 Offset = i * SamplesPerFrameTotal;
+        const int16* FramePcm = nullptr;
+        if (Offset + SamplesPerFrameTotal <= Pcm.Num())
+        {
+            FramePcm = Pcm.GetData() + Offset;
+        }
+        else
+        {
+            Padded.SetNumZeroed(SamplesPerFrameTotal);
+            const int32 Available = FMath::Max(0, Pcm.Num() - Offset);
+            if (Available > 0)
+            {
+                FMemory::Memcpy(Padded.GetData(), Pcm.GetData() + Offset, Available * sizeof(int16));
+            }
+            FramePcm = Padded.GetData();
+        }
 
         TArray<uint8> Packet;
-        Packet.SetNumUninitialized(MaxPacketSize);
-
-        const int EncBytes = opus_encode(
-            Encoder,
-            FramePtr,
-            FrameSizeSamplesPerCh,
-            Packet.GetData(),
-            Packet.Num()
-        );
-        if (EncBytes < 0)
+        if (!EncodeFrame(FramePcm, FrameSizeSamplesPerCh, Packet))
         {
             return false;
         }
-
-        Packet.SetNum(EncBytes);
         OutPackets.Add(MoveTemp(Packet));
+    }
+
+    return true;
+}
 
-        Offset += SamplesPerFrameTotal;
+bool FOpusCodec::EncodeFrameToArena(const int16* FramePcm, int32 FrameSizeSamplesPerCh, FOpusPacketArena& Arena)
+{
+    if (!Encoder || !FramePcm || FrameSizeSamplesPerCh <= 0) return false;
+
+    uint8* Dest = Arena.BeginPacket(MaxPacketSize);
+    const int EncBytes = opus_encode(Encoder, FramePcm, FrameSizeSamplesPerCh, Dest, MaxPacketSize);
+    if (EncBytes < 0)
+    {
+        return false; // the uncommitted space is discarded by the next BeginPacket
     }
 
+    Arena.CommitPacket(EncBytes);
     return true;
 }
 
-bool FOpusCodec::DecodePacketsToPcm16(const TArray<TArray<uint8>>& Packets, TArray<int16>& OutPcm)
+bool FOpusCodec::EncodeFramesToArena(TArrayView<const int16> Pcm, int32 FrameSizeSamplesPerCh, int32 FirstFrame, int32 NumFrames, FOpusPacketArena& Arena)
+{
+    if (!Encoder || FrameSizeSamplesPerCh <= 0 || FirstFrame < 0) return false;
+
+    const int32 SamplesPerFrameTotal = FrameSizeSamplesPerCh * Ch;
+    TArray<int16> Padded;
+    for (int32 i = FirstFrame; i < FirstFrame + NumFrames; ++i)
+    {
+        const int64 Offset = (int64)i * SamplesPerFrameTotal;
+        const int16* FramePcm = nullptr;
+        if (Offset + SamplesPerFrameTotal <= Pcm.Num())
+        {
+            FramePcm = Pcm.GetData() + Offset;
+        }
+        else
+        {
+            // The last frames of a clip: the rest of the samples, then silence.
+            Padded.SetNumZeroed(SamplesPerFrameTotal);
+            const int32 Available = (int32)FMath::Clamp<int64>(Pcm.Num() - Offset, 0, SamplesPerFrameTotal);
+            if (Available > 0)
+            {
+                FMemory::Memcpy(Padded.GetData(), Pcm.GetData() + Offset, Available * sizeof(int16));
+            }
+            FramePcm = Padded.GetData();
+        }
+
+        if (!EncodeFrameToArena(FramePcm, FrameSizeSamplesPerCh, Arena))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FOpusCodec::EncodeClipToArena(TArrayView<const int16> Pcm, int32 FrameSizeSamplesPerCh, FOpusPacketArena& OutArena, int32& OutPreSkip, int32& OutEndTrim)
+{
+    if (!Encoder || FrameSizeSamplesPerCh <= 0) return false;
+
+    OutPreSkip = GetLookahead(SR, Application);
+    const int32 NumFrames = GetClipFrameCount(Pcm.Num() / Ch, FrameSizeSamplesPerCh, OutPreSkip, OutEndTrim);
+
+    // Size the arena from the nominal bitrate with headroom for VBR peaks, plus room for one worst-case frame.
+    const int64 NominalFrameBytes = (int64)Bitrate * FrameSizeSamplesPerCh / ((int64)SR * 8);
+    const int64 ExpectedBytes = NumFrames * (NominalFrameBytes + NominalFrameBytes / 4) + MaxPacketSize;
+    OutArena.Reset(NumFrames, (int32)FMath::Min<int64>(ExpectedBytes, MAX_int32));
+
+    return EncodeFramesToArena(Pcm, FrameSizeSamplesPerCh, 0, NumFrames, OutArena);
+}
+
+bool FOpusCodec::DecodePacketsToPcm16(const TArray<TArray<uint8>>& Packets, TArray<int16>& OutPcm, int32 PreSkip, int32 EndTrim)
 {
     if (!Decoder) return false;
 
     OutPcm.Reset();
 
-    for (const TArray<uint8>& Packet : Packets)
+    TArray<int16> FramePcm;
+    for (int32 i = 0; i < Packets.Num(); ++i)
     {
-        TArray<int16> FramePcm;
-        FramePcm.SetNumZeroed(5760 * Ch); //   
+        const TArray<uint8>& Packet = Packets[i];
+        if (Packet.Num() > 0)
+        {
+            if (!DecodeFrame(Packet.GetData(), Packet.Num(), FramePcm)) return false;
+            OutPcm.Append(FramePcm);
+            continue;
+        }
 
-        const int DecSamplesPerCh = opus_decode(
-            Decoder,
-            Packet.GetData(),
-            Packet.Num(),
-            FramePcm.GetData(),
-            FramePcm.Num() / Ch,
-            0
-        );
-        if (DecSamplesPerCh < 0) return false;
+        // Missing packet: keep the timeline by recovering it from the next packet's FEC,
+        // or by concealment when the next packet is missing as well.
+        const TArray<uint8>* Next = (i + 1 < Packets.Num() && Packets[i + 1].Num() > 0) ? &Packets[i + 1] : nullptr;
 
-        FramePcm.SetNum(DecSamplesPerCh * Ch);
+        int32 FrameSize = GetLastFrameSamplesPerCh();
+        if (FrameSize <= 0)
+        {
+            // Nothing decoded yet: borrow the duration of the first packet that is present.
+            for (int32 j = i + 1; j < Packets.Num() && FrameSize <= 0; ++j)
+            {
+                FrameSize = GetPacketSamplesPerCh(Packets[j].GetData(), Packets[j].Num());
+            }
+        }
+        if (FrameSize <= 0)
+        {
+            continue; // no packet at all to take timing from
+        }
+
+        const bool bRecovered = Next
+            ? DecodeFecFrame(Next->GetData(), Next->Num(), FrameSize, FramePcm)
+            : ConcealFrame(FrameSize, FramePcm);
+        if (!bRecovered) return false;
         OutPcm.Append(FramePcm);
     }
+
+    // Drop the encoder delay in front and the padding behind the clip.
+    const int32 Tail = FMath::Clamp(EndTrim, 0, OutPcm.Num() / Ch) * Ch;
+    OutPcm.SetNum(OutPcm.Num() - Tail, EAllowShrinking::No);
+    const int32 Head = FMath::Clamp(PreSkip, 0, OutPcm.Num() / Ch) * Ch;
+    OutPcm.RemoveAt(0, Head, EAllowShrinking::No);
+    return true;
+}
+
+bool FOpusCodec::DecodeFrame(const uint8* Data, int32 NumBytes, TArray<int16>& OutPcm)
+{
+    if (!Decoder || !Data || NumBytes <= 0) return false;
+
+    OutPcm.SetNumUninitialized(MaxFrameSamplesPerCh * Ch);
+
+    const int DecSamplesPerCh = opus_decode(
+        Decoder,
+        Data,
+        NumBytes,
+        OutPcm.GetData(),
+        MaxFrameSamplesPerCh,
+        0
+    );
+    if (DecSamplesPerCh < 0)
+    {
+        OutPcm.Reset();
+        return false;
+    }
+
+    OutPcm.SetNum(DecSamplesPerCh * Ch, EAllowShrinking::No);
+    return true;
+}
+
+bool FOpusCodec::DecodeFecFrame(const uint8* NextData, int32 NextNumBytes, int32 FrameSizeSamplesPerCh, TArray<int16>& OutPcm)
+{
+    if (!Decoder || !NextData || NextNumBytes <= 0 || FrameSizeSamplesPerCh <= 0) return false;
+
+    // Without FEC in the next packet libopus falls back to concealment by itself.
+    OutPcm.SetNumUninitialized(FrameSizeSamplesPerCh * Ch);
+    const int DecSamplesPerCh = opus_decode(Decoder, NextData, NextNumBytes, OutPcm.GetData(), FrameSizeSamplesPerCh, 1);
+    if (DecSamplesPerCh < 0)
+    {
+        OutPcm.Reset();
+        return false;
+    }
+
+    OutPcm.SetNum(DecSamplesPerCh * Ch, EAllowShrinking::No);
     return true;
 }
+
+bool FOpusCodec::ConcealFrame(int32 FrameSizeSamplesPerCh, TArray<int16>& OutPcm)
+{
+    if (!Decoder || FrameSizeSamplesPerCh <= 0) return false;
+
+    OutPcm.SetNumUninitialized(FrameSizeSamplesPerCh * Ch);
+    const int DecSamplesPerCh = opus_decode(Decoder, nullptr, 0, OutPcm.GetData(), FrameSizeSamplesPerCh, 0);
+    if (DecSamplesPerCh < 0)
+    {
+        OutPcm.Reset();
+        return false;
+    }
+
+    OutPcm.SetNum(DecSamplesPerCh * Ch, EAllowShrinking::No);
+    return true;
+}
+
+void FOpusCodec::SetBitrate(int32 InBitrate)
+{
+    if (!Encoder || InBitrate <= 0) return;
+    opus_encoder_ctl(Encoder, OPUS_SET_BITRATE(InBitrate));
+}
+
+void FOpusCodec::SetPacketLossPercent(int32 Percent)
+{
+    if (!Encoder) return;
+
+    const int32 Clamped = FMath::Clamp(Percent, 0, 100);
+    opus_encoder_ctl(Encoder, OPUS_SET_PACKET_LOSS_PERC(Clamped));
+    opus_encoder_ctl(Encoder, OPUS_SET_INBAND_FEC(Clamped > 0 ? 1 : 0));
+}
+
+void FOpusCodec::SetDtx(bool bEnable)
+{
+    if (!Encoder) return;
+    opus_encoder_ctl(Encoder, OPUS_SET_DTX(bEnable ? 1 : 0));
+}
+
+bool FOpusCodec::IsInDtx() const
+{
+    if (!Encoder) return false;
+
+    opus_int32 InDtx = 0;
+    opus_encoder_ctl(Encoder, OPUS_GET_IN_DTX(&InDtx));
+    return InDtx != 0;
+}
+
+void FOpusCodec::Reset()
+{
+    if (Encoder)
+    {
+        // OPUS_RESET_STATE clears the signal history but keeps the ctl settings.
+        opus_encoder_ctl(Encoder, OPUS_RESET_STATE);
+        opus_encoder_ctl(Encoder, OPUS_SET_BITRATE(Bitrate));
+        opus_encoder_ctl(Encoder, OPUS_SET_PACKET_LOSS_PERC(0));
+        opus_encoder_ctl(Encoder, OPUS_SET_INBAND_FEC(0));
+        opus_encoder_ctl(Encoder, OPUS_SET_DTX(0));
+    }
+    if (Decoder)
+    {
+        opus_decoder_ctl(Decoder, OPUS_RESET_STATE);
+    }
+}
+
+int32 FOpusCodec::GetLastFrameSamplesPerCh() const
+{
+    if (!Decoder) return 0;
+
+    opus_int32 Duration = 0;
+    if (opus_decoder_ctl(Decoder, OPUS_GET_LAST_PACKET_DURATION(&Duration)) != OPUS_OK)
+    {
+        return 0;
+    }
+    return (int32)Duration;
+}
+
+int32 FOpusCodec::GetPacketSamplesPerCh(const uint8* Data, int32 NumBytes) const
+{
+    if (!Data || NumBytes <= 0) return -1;
+
+    const int Samples = opus_packet_get_nb_samples(Data, NumBytes, SR);
+    return (Samples > 0) ? (int32)Samples : -1;
+}
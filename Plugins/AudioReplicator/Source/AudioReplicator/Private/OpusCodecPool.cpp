@@ -0,0 +1,126 @@
+#include "OpusCodecPool.h"
+
+FOpusCodecPool& FOpusCodecPool::Get()
+{
+    static FOpusCodecPool Pool;
+    return Pool;
+}
+
+FOpusCodecPool::FOpusCodecPool()
+    : State(MakeShared<FState, ESPMode::ThreadSafe>())
+{
+}
+
+TSharedPtr<FOpusCodec> FOpusCodecPool::AcquireEncoder(int32 SampleRate, int32 Channels, int32 Bitrate, EOpusEncoderProfile Profile)
+{
+    FKey Key;
+    Key.SampleRate = SampleRate;
+    Key.Channels = Channels;
+    Key.Bitrate = Bitrate;
+    Key.Profile = Profile;
+    Key.bEncoder = true;
+    return Acquire(Key);
+}
+
+TSharedPtr<FOpusCodec> FOpusCodecPool::AcquireDecoder(int32 SampleRate, int32 Channels)
+{
+    // Bitrate and profile only matter to the encoder.
+    FKey Key;
+    Key.SampleRate = SampleRate;
+    Key.Channels = Channels;
+    return Acquire(Key);
+}
+
+TSharedPtr<FOpusCodec> FOpusCodecPool::Acquire(const FKey& Key)
+{
+    TUniquePtr<FOpusCodec> Codec;
+    {
+        FScopeLock ScopeLock(&State->Lock);
+        if (TArray<TUniquePtr<FOpusCodec>>* Free = State->Idle.Find(Key))
+        {
+            if (Free->Num() > 0)
+            {
+                Codec = Free->Pop(EAllowShrinking::No);
+                --State->NumIdle;
+                ++State->Reused;
+            }
+        }
+    }
+
+    if (!Codec)
+    {
+        // Created outside the lock: opus_*_create allocates and initializes tables.
+        Codec = Key.bEncoder
+            ? FOpusCodec::CreateEncoder(Key.SampleRate, Key.Channels, Key.Bitrate, Key.Profile)
+            : FOpusCodec::CreateDecoder(Key.SampleRate, Key.Channels);
+        if (!Codec)
+        {
+            return nullptr;
+        }
+
+        FScopeLock ScopeLock(&State->Lock);
+        ++State->Created;
+    }
+
+    TSharedRef<FState, ESPMode::ThreadSafe> PoolState = State;
+    return TSharedPtr<FOpusCodec>(Codec.Release(), [PoolState](FOpusCodec* Returned)
+    {
+        FOpusCodecPool::Return(PoolState, Returned);
+    });
+}
+
+void FOpusCodecPool::Return(const TSharedRef<FState, ESPMode::ThreadSafe>& State, FOpusCodec* Codec)
+{
+    TUniquePtr<FOpusCodec> Owned(Codec);
+    Owned->Reset();
+
+    FKey Key;
+    Key.SampleRate = Owned->GetSampleRate();
+    Key.Channels = Owned->GetChannels();
+    Key.bEncoder = Owned->HasEncoder();
+    if (Key.bEncoder)
+    {
+        Key.Bitrate = Owned->GetBitrate();
+        Key.Profile = Owned->GetProfile();
+    }
+
+    FScopeLock ScopeLock(&State->Lock);
+    TArray<TUniquePtr<FOpusCodec>>& Free = State->Idle.FindOrAdd(Key);
+    if (Free.Num() < State->MaxIdlePerKey)
+    {
+        Free.Add(MoveTemp(Owned));
+        ++State->NumIdle;
+    }
+    // Otherwise Owned is destroyed on scope exit.
+}
+
+void FOpusCodecPool::SetMaxIdlePerKey(int32 InMaxIdlePerKey)
+{
+    FScopeLock ScopeLock(&State->Lock);
+    State->MaxIdlePerKey = FMath::Max(0, InMaxIdlePerKey);
+    for (TPair<FKey, TArray<TUniquePtr<FOpusCodec>>>& KV : State->Idle)
+    {
+        while (KV.Value.Num() > State->MaxIdlePerKey)
+        {
+            KV.Value.Pop();
+            --State->NumIdle;
+        }
+    }
+}
+
+void FOpusCodecPool::Empty()
+{
+    FScopeLock ScopeLock(&State->Lock);
+    State->Idle.Empty();
+    State->NumIdle = 0;
+}
+
+FOpusCodecPool::FStats FOpusCodecPool::GetStats() const
+{
+    FScopeLock ScopeLock(&State->Lock);
+    FStats Out;
+    Out.Created = State->Created;
+    Out.Reused = State->Reused;
+    Out.Idle = State->NumIdle;
+    return Out;
+}
@@ -0,0 +1,182 @@
+#include "OpusJitterBuffer.h"
+#include "OpusCodec.h"
+#include "OpusCodecPool.h"
+
+namespace
+{
+    // How long playback must stay free of underruns before the target depth shrinks by one frame.
+    constexpr int32 StableMsBeforeShrink = 5000;
+}
+
+FOpusJitterBuffer::FOpusJitterBuffer(int32 InSampleRate, int32 InChannels, int32 InFrameMs, int32 InMinDepthMs, int32 InMaxDepthMs, bool bInLive)
+    : SampleRate(InSampleRate)
+    , Channels(FMath::Max(1, InChannels))
+    , FrameMs(FMath::Max(1, InFrameMs))
+    , bLive(bInLive)
+{
+    MinDepthMs = FMath::Max(FrameMs, InMinDepthMs);
+    MaxDepthMs = FMath::Max(MinDepthMs, InMaxDepthMs);
+    TargetDepthMs = MinDepthMs;
+
+    Decoder = FOpusCodecPool::Get().AcquireDecoder(SampleRate, Channels);
+}
+
+FOpusJitterBuffer::~FOpusJitterBuffer() = default;
+
+int32 FOpusJitterBuffer::GetDepthMs() const
+{
+    // Span from the next frame to play up to the newest packet, gaps included.
+    return (HighestIndex >= NextIndex) ? (HighestIndex - NextIndex + 1) * FrameMs : 0;
+}
+
+FOpusJitterBuffer::FStats FOpusJitterBuffer::GetStats() const
+{
+    FStats Out = Stats;
+    Out.TargetDepthMs = TargetDepthMs;
+    Out.DepthMs = GetDepthMs();
+    return Out;
+}
+
+void FOpusJitterBuffer::Insert(int32 Index, const TArray<uint8>& Packet)
+{
+    if (Pending.Contains(Index))
+    {
+        return;
+    }
+    if (Packet.Num() == 0)
+    {
+        SilenceIndex = FMath::Max(SilenceIndex, Index);
+    }
+    else if (bInSilence && Index > SilenceIndex)
+    {
+        // A talk spurt after a silence: whether the silence played ran ahead of the sender or fell behind,
+        // resume the target depth behind its first packet. The frames in between are silence either way.
+        NextIndex = FMath::Max(SilenceIndex + 1, Index - TargetDepthMs / FrameMs + 1);
+        for (auto It = Pending.CreateIterator(); It; ++It)
+        {
+            if (It.Key() < NextIndex)
+            {
+                It.RemoveCurrent();
+            }
+        }
+        SilentUntil = Index;
+        bInSilence = false;
+    }
+    if (HighestIndex < 0 || (Index < NextIndex && !bStartedPlayout))
+    {
+        // Nothing played yet: start from the oldest packet seen, which is not frame zero for late joiners.
+        NextIndex = (HighestIndex < 0) ? Index : FMath::Min(NextIndex, Index);
+    }
+    if (Index < NextIndex)
+    {
+        ++Stats.LateDrops;
+        return;
+    }
+
+    Pending.Add(Index, Packet);
+    HighestIndex = FMath::Max(HighestIndex, Index);
+
+    // Too much live audio queued: skip the oldest frames so latency stays bounded. A clip comes in at the
+    // pacer rate, many times faster than it plays, so all of it is kept.
+    while (bLive && GetDepthMs() > MaxDepthMs + FrameMs)
+    {
+        Pending.Remove(NextIndex);
+        ++NextIndex;
+        ++Stats.Overruns;
+    }
+}
+
+void FOpusJitterBuffer::MarkEnded(int32 NumPackets)
+{
+    bEnded = true;
+    EndIndex = (NumPackets > 0) ? NumPackets : -1;
+}
+
+void FOpusJitterBuffer::RecoverMissingFrame(TArray<int16>& OutPcm)
+{
+    const int32 FrameSamplesPerCh = (SampleRate / 1000) * FrameMs;
+
+    if (const TArray<uint8>* Next = Pending.Find(NextIndex))
+    {
+        if (Decoder->DecodeFecFrame(Next->GetData(), Next->Num(), FrameSamplesPerCh, OutPcm))
+        {
+            ++Stats.FramesRecoveredFec;
+            return;
+        }
+    }
+
+    if (Decoder->ConcealFrame(FrameSamplesPerCh, OutPcm))
+    {
+        ++Stats.FramesConcealed;
+        return;
+    }
+
+    // Decoder refused to conceal: fall back to silence so the timeline stays intact.
+    OutPcm.SetNumZeroed(FrameSamplesPerCh * Channels, EAllowShrinking::No);
+    ++Stats.FramesConcealed;
+}
+
+FOpusJitterBuffer::EPullResult FOpusJitterBuffer::Pull(TArray<int16>& OutPcm)
+{
+    OutPcm.Reset();
+
+    const bool bReachedEnd = (EndIndex >= 0) ? (NextIndex >= EndIndex) : (Pending.Num() == 0);
+    if (bEnded && bReachedEnd)
+    {
+        return EPullResult::Finished;
+    }
+
+    if (!bPlaying)
+    {
+        if (GetDepthMs() < TargetDepthMs && !bEnded)
+        {
+            return EPullResult::Buffering;
+        }
+        bPlaying = true;
+        bStartedPlayout = true;
+    }
+
+    if (Pending.Num() == 0 && !bEnded && !bInSilence)
+    {
+        ++Stats.Underruns;
+        TargetDepthMs = FMath::Min(MaxDepthMs, TargetDepthMs + FrameMs);
+        StableFrames = 0;
+        bPlaying = false;
+        return EPullResult::Underrun;
+    }
+
+    TArray<uint8> Packet;
+    const bool bHavePacket = Pending.RemoveAndCopyValue(NextIndex, Packet);
+    const bool bLeadIn = NextIndex < SilentUntil;
+    ++NextIndex;
+
+    if (bHavePacket && Packet.Num() == 0)
+    {
+        bInSilence = true;
+    }
+    if ((bInSilence || bLeadIn) && (!bHavePacket || Packet.Num() == 0))
+    {
+        // The frames were never sent, so there is no noise update to shape; the decoder's concealment
+        // would replay the tail of the last word instead. Silence is what the sender's gate let through.
+        OutPcm.SetNumZeroed((SampleRate / 1000) * FrameMs * Channels, EAllowShrinking::No);
+        ++Stats.FramesSilent;
+        return EPullResult::Silent;
+    }
+    bInSilence = false;
+
+    if (++StableFrames * FrameMs >= StableMsBeforeShrink)
+    {
+        TargetDepthMs = FMath::Max(MinDepthMs, TargetDepthMs - FrameMs);
+        StableFrames = 0;
+    }
+
+    if (bHavePacket && Decoder->DecodeFrame(Packet.GetData(), Packet.Num(), OutPcm))
+    {
+        ++Stats.FramesDecoded;
+        return EPullResult::Decoded;
+    }
+
+    // Missing or corrupt frame: NextIndex already points at the packet that may carry its FEC copy.
+    RecoverMissingFrame(OutPcm);
+    return EPullResult::Concealed;
+}
@@ -0,0 +1,139 @@
+#include "OpusPacketArena.h"
+
+void FOpusPacketArena::Reset(int32 ExpectedPackets, int32 ExpectedBytes)
+{
+    Bytes.Reset(FMath::Max(0, ExpectedBytes));
+    Spans.Reset(FMath::Max(0, ExpectedPackets));
+    PendingOffset = INDEX_NONE;
+}
+
+void FOpusPacketArena::Empty()
+{
+    Bytes.Empty();
+    Spans.Empty();
+    PendingOffset = INDEX_NONE;
+}
+
+uint8* FOpusPacketArena::BeginPacket(int32 MaxBytes)
+{
+    if (PendingOffset != INDEX_NONE)
+    {
+        Bytes.SetNum(PendingOffset, EAllowShrinking::No);
+    }
+
+    PendingOffset = Bytes.Num();
+    Bytes.AddUninitialized(FMath::Max(0, MaxBytes));
+    return Bytes.GetData() + PendingOffset;
+}
+
+void FOpusPacketArena::CommitPacket(int32 NumBytes)
+{
+    check(PendingOffset != INDEX_NONE);
+    check(NumBytes >= 0 && PendingOffset + NumBytes <= Bytes.Num());
+
+    FSpan& Span = Spans.AddDefaulted_GetRef();
+    Span.Offset = PendingOffset;
+    Span.Length = NumBytes;
+
+    Bytes.SetNum(PendingOffset + NumBytes, EAllowShrinking::No);
+    PendingOffset = INDEX_NONE;
+}
+
+void FOpusPacketArena::AddPacket(TArrayView<const uint8> Data)
+{
+    uint8* Dest = BeginPacket(Data.Num());
+    if (Data.Num() > 0)
+    {
+        FMemory::Memcpy(Dest, Data.GetData(), Data.Num());
+    }
+    CommitPacket(Data.Num());
+}
+
+void FOpusPacketArena::AddPackets(const TArray<FOpusPacket>& Packets)
+{
+    int64 Total = 0;
+    for (const FOpusPacket& P : Packets)
+    {
+        Total += P.Data.Num();
+    }
+    Bytes.Reserve(Bytes.Num() + (int32)FMath::Min<int64>(Total, MAX_int32 - Bytes.Num()));
+    Spans.Reserve(Spans.Num() + Packets.Num());
+
+    for (const FOpusPacket& P : Packets)
+    {
+        AddPacket(P.Data);
+    }
+}
+
+void FOpusPacketArena::AppendRange(const FOpusPacketArena& Other, int32 First, int32 Count)
+{
+    check(PendingOffset == INDEX_NONE && &Other != this);
+    const int32 Begin = FMath::Clamp(First, 0, Other.Num());
+    const int32 End = FMath::Clamp(First + Count, Begin, Other.Num());
+    if (Begin == End)
+        return;
+
+    const int32 SrcOffset = Other.Spans[Begin].Offset;
+    const int32 SrcBytes = Other.Spans[End - 1].Offset + Other.Spans[End - 1].Length - SrcOffset;
+    const int32 DestOffset = Bytes.Num();
+
+    Bytes.Append(Other.Bytes.GetData() + SrcOffset, SrcBytes);
+    Spans.Reserve(Spans.Num() + End - Begin);
+    for (int32 i = Begin; i < End; ++i)
+    {
+        FSpan& Span = Spans.AddDefaulted_GetRef();
+        Span.Offset = Other.Spans[i].Offset - SrcOffset + DestOffset;
+        Span.Length = Other.Spans[i].Length;
+    }
+}
+
+void FOpusPacketArena::RemoveFront(int32 Count)
+{
+    Count = FMath::Clamp(Count, 0, Spans.Num());
+    if (Count == 0)
+        return;
+
+    const int32 Shift = (Count < Spans.Num()) ? Spans[Count].Offset : (int32)GetTotalBytes();
+    Bytes.RemoveAt(0, Shift, EAllowShrinking::No);
+    Spans.RemoveAt(0, Count, EAllowShrinking::No);
+    for (FSpan& Span : Spans)
+    {
+        Span.Offset -= Shift;
+    }
+    if (PendingOffset != INDEX_NONE)
+    {
+        PendingOffset -= Shift;
+    }
+}
+
+void FOpusPacketArena::RemoveLast()
+{
+    if (Spans.Num() == 0)
+        return;
+
+    Bytes.SetNum(Spans.Last().Offset, EAllowShrinking::No);
+    Spans.Pop(EAllowShrinking::No);
+    PendingOffset = INDEX_NONE;
+}
+
+int64 FOpusPacketArena::GetRangeBytes(int32 First, int32 Count) const
+{
+    const int32 Begin = FMath::Clamp(First, 0, Spans.Num());
+    const int32 End = FMath::Clamp(First + Count, Begin, Spans.Num());
+    int64 Total = 0;
+    for (int32 i = Begin; i < End; ++i)
+    {
+        Total += Spans[i].Length;
+    }
+    return Total;
+}
+
+void FOpusPacketArena::ToPackets(TArray<FOpusPacket>& OutPackets) const
+{
+    OutPackets.Reset(Spans.Num());
+    for (int32 i = 0; i < Spans.Num(); ++i)
+    {
+        const TArrayView<const uint8> Packet = GetPacket(i);
+        OutPackets.AddDefaulted_GetRef().Data.Append(Packet.GetData(), Packet.Num());
+    }
+}
@@ -0,0 +1,94 @@
+#include "OpusParallelEncoder.h"
+#include "OpusCodecPool.h"
+#include "OpusPacketArena.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+
+namespace OpusParallelEncoder
+{
+    bool EncodeToArena(TArrayView<const int16> Pcm, const FParams& Params, FOpusPacketArena& OutPackets)
+    {
+        if (Params.SourceSampleRate > 0 && Params.SourceSampleRate != Params.SampleRate)
+        {
+            TArray<int16> Resampled;
+            if (!FPcmResampler::ResampleBuffer(Pcm, Params.SourceSampleRate, Params.SampleRate, Params.Channels, Params.ResampleQuality, Resampled))
+                return false;
+
+            FParams AtCodecRate = Params;
+            AtCodecRate.SourceSampleRate = 0;
+            return EncodeToArena(Resampled, AtCodecRate, OutPackets);
+        }
+
+        const int32 SamplesPerFrameTotal = Params.FrameSamplesPerCh * Params.Channels;
+        if (SamplesPerFrameTotal <= 0)
+            return false;
+
+        // The last frame is padded with silence; the header's EndTrim says how much of it to drop.
+        int32 EndTrim = 0;
+        const int32 PreSkip = FOpusCodec::GetLookahead(Params.SampleRate, Params.Profile);
+        const int32 NumFrames = FOpusCodec::GetClipFrameCount(Pcm.Num() / Params.Channels, Params.FrameSamplesPerCh, PreSkip, EndTrim);
+        const int32 SegmentFrames = FMath::Max(1, Params.SegmentFrames);
+        const int32 PreRoll = FMath::Clamp(Params.PreRollFrames, 0, SegmentFrames);
+        const int32 NumSegments = (NumFrames < 2 * SegmentFrames) ? 1 : FMath::DivideAndRoundUp(NumFrames, SegmentFrames);
+
+        if (NumSegments == 1)
+        {
+            TSharedPtr<FOpusCodec> Codec = FOpusCodecPool::Get().AcquireEncoder(Params.SampleRate, Params.Channels, Params.Bitrate, Params.Profile);
+            int32 OutPreSkip = 0;
+            return Codec && Codec->EncodeClipToArena(Pcm, Params.FrameSamplesPerCh, OutPackets, OutPreSkip, EndTrim);
+        }
+
+        TArray<FOpusPacketArena> Segments;
+        Segments.SetNum(NumSegments);
+        TArray<int32> Skip;
+        Skip.SetNumZeroed(NumSegments);
+        TArray<bool> Ok;
+        Ok.Init(false, NumSegments);
+
+        ParallelFor(NumSegments, [&](int32 Segment)
+        {
+            TSharedPtr<FOpusCodec> Codec = FOpusCodecPool::Get().AcquireEncoder(Params.SampleRate, Params.Channels, Params.Bitrate, Params.Profile);
+            if (!Codec)
+                return;
+
+            const int32 FirstFrame = Segment * SegmentFrames;
+            const int32 EndFrame = FMath::Min(NumFrames, FirstFrame + SegmentFrames);
+            const int32 StartFrame = FMath::Max(0, FirstFrame - PreRoll);
+            Skip[Segment] = FirstFrame - StartFrame;
+
+            Ok[Segment] = Codec->EncodeFramesToArena(Pcm, Params.FrameSamplesPerCh, StartFrame, EndFrame - StartFrame, Segments[Segment]);
+        });
+
+        int64 TotalBytes = 0;
+        for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+        {
+            if (!Ok[Segment])
+                return false;
+            TotalBytes += Segments[Segment].GetTotalBytes();
+        }
+
+        OutPackets.Reset(NumFrames, (int32)FMath::Min<int64>(TotalBytes, MAX_int32));
+        for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+        {
+            // Drop the pre-roll packets; they duplicate the tail of the previous segment.
+            const FOpusPacketArena& Packets = Segments[Segment];
+            OutPackets.AppendRange(Packets, Skip[Segment], Packets.Num() - Skip[Segment]);
+        }
+        return true;
+    }
+
+    void EncodeAsync(TArray<int16>&& Pcm, const FParams& Params, FOnEncoded&& OnEncoded)
+    {
+        AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Pcm = MoveTemp(Pcm), Params, OnEncoded = MoveTemp(OnEncoded)]() mutable
+        {
+            FOpusPacketArena Packets;
+            const bool bSuccess = EncodeToArena(Pcm, Params, Packets);
+            Pcm.Empty();
+
+            AsyncTask(ENamedThreads::GameThread, [bSuccess, Packets = MoveTemp(Packets), OnEncoded = MoveTemp(OnEncoded)]() mutable
+            {
+                OnEncoded(bSuccess, MoveTemp(Packets));
+            });
+        });
+    }
+}
@@ -0,0 +1,176 @@
+#include "OpusSessionRecorder.h"
+#include "OpusCodec.h"
+#include "OpusCodecPool.h"
+
+FOpusSessionRecorder::~FOpusSessionRecorder() = default;
+
+bool FOpusSessionRecorder::Open(const FString& Path, const FOpusStreamHeader& Header, int32 FirstIndex)
+{
+    FrameSamplesPerCh = (Header.SampleRate / 1000) * Header.FrameMs;
+    if (FrameSamplesPerCh <= 0 || Header.Channels <= 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FOpusSessionRecorder::Open: bad header SR=%d Ch=%d FrameMs=%d"), Header.SampleRate, Header.Channels, Header.FrameMs);
+        return false;
+    }
+
+    Decoder = FOpusCodecPool::Get().AcquireDecoder(Header.SampleRate, Header.Channels);
+    if (!Decoder || !Writer.Open(Path, Header.SampleRate, Header.Channels))
+    {
+        Decoder.Reset();
+        return false;
+    }
+
+    Pending.Reset();
+    PendingSilence.Reset();
+    Held.Reset();
+    // The pre-skip only applies when recording from the first frame of the stream.
+    SkipSamples = FirstIndex == 0 ? FMath::Max(0, Header.PreSkip) * Header.Channels : 0;
+    TrimSamples = Header.bLive ? 0 : FMath::Max(0, Header.EndTrim) * Header.Channels;
+    bWaitingForFirst = FirstIndex < 0;
+    NextIndex = FMath::Max(0, FirstIndex);
+    HighestIndex = NextIndex - 1;
+    FramesConcealed = 0;
+    AnnouncedPackets = Header.bLive ? 0 : FMath::Max(0, Header.NumPackets);
+    bWarnedJump = false;
+    return true;
+}
+
+void FOpusSessionRecorder::Insert(int32 Index, TArrayView<const uint8> Packet)
+{
+    if (!IsOpen() || Packet.Num() == 0)
+        return;
+
+    if (bWaitingForFirst)
+    {
+        bWaitingForFirst = false;
+        NextIndex = Index;
+        HighestIndex = Index - 1;
+    }
+    if (Index < NextIndex || Pending.Contains(Index))
+        return;
+    if (Index >= AnnouncedPackets && Index > HighestIndex + MaxJumpFrames)
+    {
+        if (!bWarnedJump)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FOpusSessionRecorder: dropped packet %d, more than %d frames past %d (%s)"), Index, MaxJumpFrames, HighestIndex, *GetPath());
+            bWarnedJump = true;
+        }
+        return;
+    }
+
+    if (Index == NextIndex)
+    {
+        // The common in-order case skips the pending map entirely.
+        WriteNext(Packet);
+    }
+    else
+    {
+        Pending.Add(Index, TArray<uint8>(Packet.GetData(), Packet.Num()));
+    }
+    HighestIndex = FMath::Max(HighestIndex, Index);
+
+    // A clip's missing frames may still be retransmitted, so only its contiguous run is written.
+    Drain(AnnouncedPackets > 0 ? NextIndex - 1 : HighestIndex - MaxGapFrames);
+}
+
+void FOpusSessionRecorder::InsertSilence(int32 First, int32 End)
+{
+    if (!IsOpen() || End <= First)
+        return;
+
+    if (bWaitingForFirst)
+    {
+        bWaitingForFirst = false;
+        NextIndex = First;
+        HighestIndex = First - 1;
+    }
+    First = FMath::Max(First, NextIndex);
+    if (End <= First)
+        return;
+
+    PendingSilence.Add(First, End);
+    HighestIndex = FMath::Max(HighestIndex, End - 1);
+    Drain(HighestIndex - MaxGapFrames);
+}
+
+bool FOpusSessionRecorder::Finish(int32 NumPackets)
+{
+    if (!IsOpen())
+        return false;
+
+    int32 EndIndex = NumPackets > 0 ? NumPackets - 1 : HighestIndex;
+    if (EndIndex > HighestIndex + MaxJumpFrames)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FOpusSessionRecorder: closing %s at frame %d; the %d frames up to the end were never received"), *GetPath(), HighestIndex, EndIndex - HighestIndex);
+        EndIndex = HighestIndex;
+    }
+    Drain(EndIndex);
+    Pending.Reset();
+    PendingSilence.Reset();
+    Held.Reset(); // the end padding
+    Decoder.Reset();
+    return Writer.Close();
+}
+
+void FOpusSessionRecorder::Drain(int32 EndIndex)
+{
+    // Frames up to EndIndex are written even if missing; after that only the contiguous run.
+    while (NextIndex <= EndIndex || Pending.Contains(NextIndex) || PendingSilence.Contains(NextIndex))
+    {
+        int32 SilenceEnd = 0;
+        if (PendingSilence.RemoveAndCopyValue(NextIndex, SilenceEnd))
+        {
+            while (NextIndex < SilenceEnd)
+            {
+                Pending.Remove(NextIndex);
+                WriteNext(TArrayView<const uint8>(), /*bSilent=*/true);
+            }
+            continue;
+        }
+
+        const TArray<uint8>* Packet = Pending.Find(NextIndex);
+        WriteNext(Packet ? TArrayView<const uint8>(*Packet) : TArrayView<const uint8>());
+        Pending.Remove(NextIndex - 1);
+    }
+}
+
+void FOpusSessionRecorder::WriteNext(TArrayView<const uint8> Packet, bool bSilent)
+{
+    // Silence the sender did not transmit is written as zeros, like the jitter buffer plays it.
+    bool bDecoded = !bSilent && Packet.Num() > 0 && Decoder->DecodeFrame(Packet.GetData(), Packet.Num(), FramePcm);
+    if (!bDecoded && !bSilent)
+    {
+        ++FramesConcealed;
+        bDecoded = Decoder->ConcealFrame(FrameSamplesPerCh, FramePcm);
+    }
+    if (!bDecoded)
+    {
+        // Silence, or concealment failed: keep the timeline intact. SetNumZeroed only clears new elements.
+        FramePcm.Reset();
+        FramePcm.SetNumZeroed(FrameSamplesPerCh * Decoder->GetChannels());
+    }
+
+    Emit(FramePcm);
+    ++NextIndex;
+}
+
+void FOpusSessionRecorder::Emit(TArrayView<const int16> Pcm)
+{
+    const int32 Skip = FMath::Min(SkipSamples, Pcm.Num());
+    SkipSamples -= Skip;
+    Pcm = Pcm.RightChop(Skip);
+
+    if (TrimSamples <= 0)
+    {
+        Writer.Append(Pcm);
+        return;
+    }
+
+    Held.Append(Pcm.GetData(), Pcm.Num());
+    const int32 Ready = Held.Num() - TrimSamples;
+    if (Ready > 0)
+    {
+        Writer.Append(MakeArrayView(Held.GetData(), Ready));
+        Held.RemoveAt(0, Ready, EAllowShrinking::No);
+    }
+}
@@ -0,0 +1,32 @@
+#include "OpusTypes.h"
+
+bool FOpusChunkBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    Ar << SessionHandle;
+
+    uint32 First = (uint32)FMath::Max(0, FirstIndex);
+    Ar.SerializeIntPacked(First);
+
+    uint32 NumBytes = (uint32)Payload.Num();
+    Ar.SerializeIntPacked(NumBytes);
+
+    if (Ar.IsLoading())
+    {
+        if (First > (uint32)MAX_int32 || NumBytes > (uint32)MaxPayloadBytes)
+        {
+            Ar.SetError();
+            bOutSuccess = false;
+            return true;
+        }
+        FirstIndex = (int32)First;
+        Payload.SetNumUninitialized((int32)NumBytes);
+    }
+
+    if (NumBytes > 0)
+    {
+        Ar.Serialize(Payload.GetData(), (int64)NumBytes);
+    }
+
+    bOutSuccess = !Ar.IsError();
+    return true;
+}
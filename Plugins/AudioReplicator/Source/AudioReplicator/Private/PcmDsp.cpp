@@ -0,0 +1,784 @@
+#include "PcmDsp.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+    #define PCMDSP_NEON 1
+    #include <arm_neon.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+    #define PCMDSP_SSE2 1
+    #include <emmintrin.h>
+    #if PLATFORM_ALWAYS_HAS_AVX_2
+        #define PCMDSP_AVX2 1
+        #include <immintrin.h>
+    #endif
+#endif
+
+#ifndef PCMDSP_NEON
+    #define PCMDSP_NEON 0
+#endif
+#ifndef PCMDSP_SSE2
+    #define PCMDSP_SSE2 0
+#endif
+#ifndef PCMDSP_AVX2
+    #define PCMDSP_AVX2 0
+#endif
+
+namespace
+{
+    constexpr float Int16ToFloatScale = 1.0f / 32768.0f;
+    constexpr float FloatToInt16Scale = 32768.0f;
+    constexpr float Int32ToFloatScale = 1.0f / 2147483648.0f;
+
+    // Xorshift32: shifts and xors only, so the vector paths can run one generator per lane.
+    inline uint32 NextRandom(uint32& State)
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        return State;
+    }
+
+    // Top 23 bits of a random word as a float in [0, 1).
+    inline float RandomUnit(uint32 Bits)
+    {
+        const uint32 F = (Bits >> 9) | 0x3F800000u;
+        float V;
+        FMemory::Memcpy(&V, &F, sizeof(V));
+        return V - 1.0f;
+    }
+
+    // Independent non-zero seeds for the lanes of a vector generator.
+    inline uint32 LaneSeed(uint32 Seed, uint32 Lane)
+    {
+        const uint32 S = Seed ^ ((Lane + 1) * 0x9E3779B9u);
+        return S ? S : 0x6D2B79F5u;
+    }
+
+    // Largest magnitude and sum of squares, kept raw so vector and scalar parts can be merged.
+    void AccumulatePeakSumSq(const int16* In, int32 Num, int32& InOutPeak, uint64& InOutSumSq)
+    {
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const int32 V = In[i];
+            InOutPeak = FMath::Max(InOutPeak, FMath::Abs(V));
+            InOutSumSq += (uint64)(V * V);
+        }
+    }
+
+    void FinishPeakRms(int32 Peak, uint64 SumSq, int32 Num, float& OutPeak, float& OutRms)
+    {
+        OutPeak = FMath::Min(1.0f, Peak * Int16ToFloatScale);
+        OutRms = (Num > 0) ? (float)(FMath::Sqrt((double)SumSq / Num) / 32768.0) : 0.0f;
+    }
+}
+
+namespace PcmDsp
+{
+    namespace Scalar
+    {
+        void Int16ToFloat(const int16* In, float* Out, int32 Num)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                Out[i] = In[i] * Int16ToFloatScale;
+            }
+        }
+
+        void FloatToInt16(const float* In, int16* Out, int32 Num)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const float V = FMath::Clamp(In[i] * FloatToInt16Scale, -32768.0f, 32767.0f);
+                Out[i] = (int16)FMath::RoundHalfToEven(V);
+            }
+        }
+
+        void Int32ToInt16(const int32* In, int16* Out, int32 Num)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                Out[i] = (int16)FMath::Clamp(In[i], -32768, 32767);
+            }
+        }
+
+        void Int16ToInt32(const int16* In, int32* Out, int32 Num)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                Out[i] = In[i];
+            }
+        }
+
+        void Int24ToFloat(const uint8* In, float* Out, int32 Num)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                // Assemble in the top three bytes so the sign comes along for free.
+                const uint8* P = In + 3 * i;
+                const int32 V = (int32)(((uint32)P[0] << 8) | ((uint32)P[1] << 16) | ((uint32)P[2] << 24));
+                Out[i] = V * Int32ToFloatScale;
+            }
+        }
+
+        void Int32ToFloat(const int32* In, float* Out, int32 Num)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                Out[i] = In[i] * Int32ToFloatScale;
+            }
+        }
+
+        void FloatToInt16Dither(const float* In, int16* Out, int32 Num, uint32& InOutSeed)
+        {
+            uint32 State = InOutSeed ? InOutSeed : LaneSeed(0, 0);
+            for (int32 i = 0; i < Num; ++i)
+            {
+                // Difference of two uniform draws: triangular noise in (-1, 1) LSB.
+                const float A = RandomUnit(NextRandom(State));
+                const float B = RandomUnit(NextRandom(State));
+                const float V = FMath::Clamp(In[i] * FloatToInt16Scale + (A - B), -32768.0f, 32767.0f);
+                Out[i] = (int16)FMath::RoundHalfToEven(V);
+            }
+            InOutSeed = State;
+        }
+
+        void ApplyGain(int16* InOut, int32 Num, float Gain)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const float V = FMath::Clamp(InOut[i] * Gain, -32768.0f, 32767.0f);
+                InOut[i] = (int16)FMath::RoundHalfToEven(V);
+            }
+        }
+
+        void ApplyGain(float* InOut, int32 Num, float Gain)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                InOut[i] *= Gain;
+            }
+        }
+
+        void Interleave(const int16* const* Planes, int32 NumChannels, int32 NumFrames, int16* Out)
+        {
+            for (int32 f = 0; f < NumFrames; ++f)
+            {
+                for (int32 c = 0; c < NumChannels; ++c)
+                {
+                    Out[f * NumChannels + c] = Planes[c][f];
+                }
+            }
+        }
+
+        void Deinterleave(const int16* In, int32 NumChannels, int32 NumFrames, int16* const* OutPlanes)
+        {
+            for (int32 f = 0; f < NumFrames; ++f)
+            {
+                for (int32 c = 0; c < NumChannels; ++c)
+                {
+                    OutPlanes[c][f] = In[f * NumChannels + c];
+                }
+            }
+        }
+
+        void ComputePeakRms(const int16* In, int32 Num, float& OutPeak, float& OutRms)
+        {
+            int32 Peak = 0;
+            uint64 SumSq = 0;
+            AccumulatePeakSumSq(In, Num, Peak, SumSq);
+            FinishPeakRms(Peak, SumSq, Num, OutPeak, OutRms);
+        }
+
+        float DotProduct(const float* A, const float* B, int32 Num)
+        {
+            float Sum = 0.0f;
+            for (int32 i = 0; i < Num; ++i)
+            {
+                Sum += A[i] * B[i];
+            }
+            return Sum;
+        }
+    }
+
+    const TCHAR* GetKernelPathName()
+    {
+#if PCMDSP_AVX2
+        return TEXT("AVX2");
+#elif PCMDSP_SSE2
+        return TEXT("SSE2");
+#elif PCMDSP_NEON
+        return TEXT("NEON");
+#else
+        return TEXT("Scalar");
+#endif
+    }
+
+    void Int16ToFloat(const int16* In, float* Out, int32 Num)
+    {
+        int32 i = 0;
+#if PCMDSP_AVX2
+        const __m256 Scale8 = _mm256_set1_ps(Int16ToFloatScale);
+        for (; i + 16 <= Num; i += 16)
+        {
+            const __m256i X = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(In + i));
+            const __m256i Lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(X));
+            const __m256i Hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(X, 1));
+            _mm256_storeu_ps(Out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(Lo), Scale8));
+            _mm256_storeu_ps(Out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(Hi), Scale8));
+        }
+#endif
+#if PCMDSP_SSE2
+        const __m128 Scale = _mm_set1_ps(Int16ToFloatScale);
+        for (; i + 8 <= Num; i += 8)
+        {
+            const __m128i X = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + i));
+            const __m128i Lo = _mm_srai_epi32(_mm_unpacklo_epi16(X, X), 16);
+            const __m128i Hi = _mm_srai_epi32(_mm_unpackhi_epi16(X, X), 16);
+            _mm_storeu_ps(Out + i, _mm_mul_ps(_mm_cvtepi32_ps(Lo), Scale));
+            _mm_storeu_ps(Out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(Hi), Scale));
+        }
+#elif PCMDSP_NEON
+        for (; i + 8 <= Num; i += 8)
+        {
+            const int16x8_t X = vld1q_s16(In + i);
+            vst1q_f32(Out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(X))), Int16ToFloatScale));
+            vst1q_f32(Out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(X))), Int16ToFloatScale));
+        }
+#endif
+        Scalar::Int16ToFloat(In + i, Out + i, Num - i);
+    }
+
+    void FloatToInt16(const float* In, int16* Out, int32 Num)
+    {
+        int32 i = 0;
+#if PCMDSP_AVX2
+        {
+            const __m256 Scale8 = _mm256_set1_ps(FloatToInt16Scale);
+            const __m256 Min8 = _mm256_set1_ps(-32768.0f);
+            const __m256 Max8 = _mm256_set1_ps(32767.0f);
+            for (; i + 16 <= Num; i += 16)
+            {
+                // Clamp before converting: out-of-range floats convert to INT_MIN.
+                const __m256 A = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(In + i), Scale8), Min8), Max8);
+                const __m256 B = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(In + i + 8), Scale8), Min8), Max8);
+                const __m256i Packed = _mm256_packs_epi32(_mm256_cvtps_epi32(A), _mm256_cvtps_epi32(B));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i), _mm256_permute4x64_epi64(Packed, 0xD8));
+            }
+        }
+#endif
+#if PCMDSP_SSE2
+        const __m128 Scale = _mm_set1_ps(FloatToInt16Scale);
+        const __m128 Min = _mm_set1_ps(-32768.0f);
+        const __m128 Max = _mm_set1_ps(32767.0f);
+        for (; i + 8 <= Num; i += 8)
+        {
+            const __m128 A = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(In + i), Scale), Min), Max);
+            const __m128 B = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(In + i + 4), Scale), Min), Max);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), _mm_packs_epi32(_mm_cvtps_epi32(A), _mm_cvtps_epi32(B)));
+        }
+#elif PCMDSP_NEON
+        for (; i + 8 <= Num; i += 8)
+        {
+            // vcvtnq rounds to nearest even and saturates; vqmovn saturates to int16.
+            const int32x4_t A = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(In + i), FloatToInt16Scale));
+            const int32x4_t B = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(In + i + 4), FloatToInt16Scale));
+            vst1q_s16(Out + i, vcombine_s16(vqmovn_s32(A), vqmovn_s32(B)));
+        }
+#endif
+        Scalar::FloatToInt16(In + i, Out + i, Num - i);
+    }
+
+    void Int32ToInt16(const int32* In, int16* Out, int32 Num)
+    {
+        int32 i = 0;
+#if PCMDSP_AVX2
+        for (; i + 16 <= Num; i += 16)
+        {
+            const __m256i A = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(In + i));
+            const __m256i B = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(In + i + 8));
+            // packs works per 128-bit lane; the permute restores sample order.
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(A, B), 0xD8));
+        }
+#endif
+#if PCMDSP_SSE2
+        for (; i + 8 <= Num; i += 8)
+        {
+            const __m128i A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + i));
+            const __m128i B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + i + 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), _mm_packs_epi32(A, B));
+        }
+#elif PCMDSP_NEON
+        for (; i + 8 <= Num; i += 8)
+        {
+            vst1q_s16(Out + i, vcombine_s16(vqmovn_s32(vld1q_s32(In + i)), vqmovn_s32(vld1q_s32(In + i + 4))));
+        }
+#endif
+        Scalar::Int32ToInt16(In + i, Out + i, Num - i);
+    }
+
+    void Int16ToInt32(const int16* In, int32* Out, int32 Num)
+    {
+        int32 i = 0;
+#if PCMDSP_AVX2
+        for (; i + 16 <= Num; i += 16)
+        {
+            const __m256i X = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(In + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i), _mm256_cvtepi16_epi32(_mm256_castsi256_si128(X)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i + 8), _mm256_cvtepi16_epi32(_mm256_extracti128_si256(X, 1)));
+        }
+#endif
+#if PCMDSP_SSE2
+        for (; i + 8 <= Num; i += 8)
+        {
+            const __m128i X = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), _mm_srai_epi32(_mm_unpacklo_epi16(X, X), 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i + 4), _mm_srai_epi32(_mm_unpackhi_epi16(X, X), 16));
+        }
+#elif PCMDSP_NEON
+        for (; i + 8 <= Num; i += 8)
+        {
+            const int16x8_t X = vld1q_s16(In + i);
+            vst1q_s32(Out + i, vmovl_s16(vget_low_s16(X)));
+            vst1q_s32(Out + i + 4, vmovl_s16(vget_high_s16(X)));
+        }
+#endif
+        Scalar::Int16ToInt32(In + i, Out + i, Num - i);
+    }
+
+    void Int24ToFloat(const uint8* In, float* Out, int32 Num)
+    {
+        int32 i = 0;
+#if PCMDSP_AVX2
+        {
+            // AVX2 implies SSSE3: shuffle each 3-byte sample into the top of a 32-bit lane.
+            const __m128i Spread = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+            const __m256 Scale8 = _mm256_set1_ps(Int32ToFloatScale);
+            // Two 16-byte loads per 8 samples read 4 bytes past the 24 used: stop while 10 samples remain.
+            for (; i + 10 <= Num; i += 8)
+            {
+                const __m128i A = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(In + 3 * i)), Spread);
+                const __m128i B = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(In + 3 * i + 12)), Spread);
+                const __m256i X = _mm256_inserti128_si256(_mm256_castsi128_si256(A), B, 1);
+                _mm256_storeu_ps(Out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(X), Scale8));
+            }
+        }
+#elif PCMDSP_NEON
+        for (; i + 8 <= Num; i += 8)
+        {
+            // vld3 splits the bytes of 8 samples into low, middle and high planes.
+            const uint8x8x3_t B = vld3_u8(In + 3 * i);
+            const int16x8_t Hi = vreinterpretq_s16_u16(vorrq_u16(vmovl_u8(B.val[1]), vshll_n_u8(B.val[2], 8)));
+            const uint16x8_t Lo = vshll_n_u8(B.val[0], 8);
+            const int32x4_t X0 = vorrq_s32(vshll_n_s16(vget_low_s16(Hi), 16), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(Lo))));
+            const int32x4_t X1 = vorrq_s32(vshll_n_s16(vget_high_s16(Hi), 16), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(Lo))));
+            vst1q_f32(Out + i, vmulq_n_f32(vcvtq_f32_s32(X0), Int32ToFloatScale));
+            vst1q_f32(Out + i + 4, vmulq_n_f32(vcvtq_f32_s32(X1), Int32ToFloatScale));
+        }
+#endif
+        // SSE2 has no byte shuffle; without AVX2 the packed format goes through the scalar loop.
+        Scalar::Int24ToFloat(In + 3 * i, Out + i, Num - i);
+    }
+
+    void Int32ToFloat(const int32* In, float* Out, int32 Num)
+    {
+        int32 i = 0;
+#if PCMDSP_AVX2
+        const __m256 Scale8 = _mm256_set1_ps(Int32ToFloatScale);
+        for (; i + 8 <= Num; i += 8)
+        {
+            const __m256i X = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(In + i));
+            _mm256_storeu_ps(Out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(X), Scale8));
+        }
+#endif
+#if PCMDSP_SSE2
+        const __m128 Scale = _mm_set1_ps(Int32ToFloatScale);
+        for (; i + 4 <= Num; i += 4)
+        {
+            const __m128i X = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + i));
+            _mm_storeu_ps(Out + i, _mm_mul_ps(_mm_cvtepi32_ps(X), Scale));
+        }
+#elif PCMDSP_NEON
+        for (; i + 4 <= Num; i += 4)
+        {
+            vst1q_f32(Out + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(In + i)), Int32ToFloatScale));
+        }
+#endif
+        Scalar::Int32ToFloat(In + i, Out + i, Num - i);
+    }
+
+    void FloatToInt16Dither(const float* In, int16* Out, int32 Num, uint32& InOutSeed)
+    {
+        if (InOutSeed == 0)
+        {
+            InOutSeed = LaneSeed(0, 0);
+        }
+
+        int32 i = 0;
+#if PCMDSP_SSE2 || PCMDSP_NEON
+        if (Num >= 8)
+        {
+            alignas(16) uint32 Seeds[4];
+            for (uint32 Lane = 0; Lane < 4; ++Lane)
+            {
+                Seeds[Lane] = LaneSeed(InOutSeed, Lane);
+            }
+#if PCMDSP_SSE2
+            __m128i State = _mm_load_si128(reinterpret_cast<const __m128i*>(Seeds));
+            const __m128i Exponent = _mm_set1_epi32(0x3F800000);
+            const __m128 Scale = _mm_set1_ps(FloatToInt16Scale);
+            const __m128 Min = _mm_set1_ps(-32768.0f);
+            const __m128 Max = _mm_set1_ps(32767.0f);
+
+            // One xorshift step on every lane, returned as uniform floats in [1, 2).
+            auto Draw = [&State, &Exponent]()
+            {
+                State = _mm_xor_si128(State, _mm_slli_epi32(State, 13));
+                State = _mm_xor_si128(State, _mm_srli_epi32(State, 17));
+                State = _mm_xor_si128(State, _mm_slli_epi32(State, 5));
+                return _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(State, 9), Exponent));
+            };
+
+            for (; i + 8 <= Num; i += 8)
+            {
+                // The [1, 2) offsets cancel in the difference of two draws.
+                const __m128 DA = _mm_sub_ps(Draw(), Draw());
+                const __m128 DB = _mm_sub_ps(Draw(), Draw());
+                const __m128 A = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(In + i), Scale), DA), Min), Max);
+                const __m128 B = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(In + i + 4), Scale), DB), Min), Max);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), _mm_packs_epi32(_mm_cvtps_epi32(A), _mm_cvtps_epi32(B)));
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(Seeds), State);
+#else
+            uint32x4_t State = vld1q_u32(Seeds);
+            const uint32x4_t Exponent = vdupq_n_u32(0x3F800000u);
+
+            auto Draw = [&State, &Exponent]()
+            {
+                State = veorq_u32(State, vshlq_n_u32(State, 13));
+                State = veorq_u32(State, vshrq_n_u32(State, 17));
+                State = veorq_u32(State, vshlq_n_u32(State, 5));
+                return vreinterpretq_f32_u32(vorrq_u32(vshrq_n_u32(State, 9), Exponent));
+            };
+
+            for (; i + 8 <= Num; i += 8)
+            {
+                const float32x4_t DA = vsubq_f32(Draw(), Draw());
+                const float32x4_t DB = vsubq_f32(Draw(), Draw());
+                const int32x4_t A = vcvtnq_s32_f32(vaddq_f32(vmulq_n_f32(vld1q_f32(In + i), FloatToInt16Scale), DA));
+                const int32x4_t B = vcvtnq_s32_f32(vaddq_f32(vmulq_n_f32(vld1q_f32(In + i + 4), FloatToInt16Scale), DB));
+                vst1q_s16(Out + i, vcombine_s16(vqmovn_s32(A), vqmovn_s32(B)));
+            }
+            vst1q_u32(Seeds, State);
+#endif
+            // Fold the lanes back into one seed so the next call continues a fresh sequence.
+            InOutSeed = Seeds[0] ^ Seeds[1] ^ Seeds[2] ^ Seeds[3];
+            if (InOutSeed == 0)
+            {
+                InOutSeed = LaneSeed(Seeds[0], 0);
+            }
+        }
+#endif
+        Scalar::FloatToInt16Dither(In + i, Out + i, Num - i, InOutSeed);
+    }
+
+    void ApplyGain(int16* InOut, int32 Num, float Gain)
+    {
+        if (Gain == 1.0f)
+            return;
+
+        int32 i = 0;
+#if PCMDSP_AVX2
+        {
+            const __m256 Gain8 = _mm256_set1_ps(Gain);
+            const __m256 Min8 = _mm256_set1_ps(-32768.0f);
+            const __m256 Max8 = _mm256_set1_ps(32767.0f);
+            for (; i + 16 <= Num; i += 16)
+            {
+                const __m256i X = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(InOut + i));
+                const __m256 Lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(X)));
+                const __m256 Hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(X, 1)));
+                const __m256i A = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(Lo, Gain8), Min8), Max8));
+                const __m256i B = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(Hi, Gain8), Min8), Max8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(InOut + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(A, B), 0xD8));
+            }
+        }
+#endif
+#if PCMDSP_SSE2
+        const __m128 Gain4 = _mm_set1_ps(Gain);
+        const __m128 Min = _mm_set1_ps(-32768.0f);
+        const __m128 Max = _mm_set1_ps(32767.0f);
+        for (; i + 8 <= Num; i += 8)
+        {
+            const __m128i X = _mm_loadu_si128(reinterpret_cast<const __m128i*>(InOut + i));
+            const __m128 Lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(X, X), 16));
+            const __m128 Hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(X, X), 16));
+            const __m128i A = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(Lo, Gain4), Min), Max));
+            const __m128i B = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(Hi, Gain4), Min), Max));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(InOut + i), _mm_packs_epi32(A, B));
+        }
+#elif PCMDSP_NEON
+        for (; i + 8 <= Num; i += 8)
+        {
+            const int16x8_t X = vld1q_s16(InOut + i);
+            const int32x4_t A = vcvtnq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(X))), Gain));
+            const int32x4_t B = vcvtnq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(X))), Gain));
+            vst1q_s16(InOut + i, vcombine_s16(vqmovn_s32(A), vqmovn_s32(B)));
+        }
+#endif
+        Scalar::ApplyGain(InOut + i, Num - i, Gain);
+    }
+
+    void ApplyGain(float* InOut, int32 Num, float Gain)
+    {
+        if (Gain == 1.0f)
+            return;
+
+        int32 i = 0;
+#if PCMDSP_AVX2
+        const __m256 Gain8 = _mm256_set1_ps(Gain);
+        for (; i + 8 <= Num; i += 8)
+        {
+            _mm256_storeu_ps(InOut + i, _mm256_mul_ps(_mm256_loadu_ps(InOut + i), Gain8));
+        }
+#endif
+#if PCMDSP_SSE2
+        const __m128 Gain4 = _mm_set1_ps(Gain);
+        for (; i + 4 <= Num; i += 4)
+        {
+            _mm_storeu_ps(InOut + i, _mm_mul_ps(_mm_loadu_ps(InOut + i), Gain4));
+        }
+#elif PCMDSP_NEON
+        for (; i + 4 <= Num; i += 4)
+        {
+            vst1q_f32(InOut + i, vmulq_n_f32(vld1q_f32(InOut + i), Gain));
+        }
+#endif
+        Scalar::ApplyGain(InOut + i, Num - i, Gain);
+    }
+
+    void Interleave(const int16* const* Planes, int32 NumChannels, int32 NumFrames, int16* Out)
+    {
+        if (NumChannels == 1)
+        {
+            FMemory::Memcpy(Out, Planes[0], NumFrames * sizeof(int16));
+            return;
+        }
+        if (NumChannels != 2)
+        {
+            Scalar::Interleave(Planes, NumChannels, NumFrames, Out);
+            return;
+        }
+
+        // Stereo, by far the common case beyond mono.
+        const int16* L = Planes[0];
+        const int16* R = Planes[1];
+        int32 f = 0;
+#if PCMDSP_SSE2
+        for (; f + 8 <= NumFrames; f += 8)
+        {
+            const __m128i VL = _mm_loadu_si128(reinterpret_cast<const __m128i*>(L + f));
+            const __m128i VR = _mm_loadu_si128(reinterpret_cast<const __m128i*>(R + f));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + 2 * f), _mm_unpacklo_epi16(VL, VR));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + 2 * f + 8), _mm_unpackhi_epi16(VL, VR));
+        }
+#elif PCMDSP_NEON
+        for (; f + 8 <= NumFrames; f += 8)
+        {
+            int16x8x2_t V;
+            V.val[0] = vld1q_s16(L + f);
+            V.val[1] = vld1q_s16(R + f);
+            vst2q_s16(Out + 2 * f, V);
+        }
+#endif
+        for (; f < NumFrames; ++f)
+        {
+            Out[2 * f] = L[f];
+            Out[2 * f + 1] = R[f];
+        }
+    }
+
+    void Deinterleave(const int16* In, int32 NumChannels, int32 NumFrames, int16* const* OutPlanes)
+    {
+        if (NumChannels == 1)
+        {
+            FMemory::Memcpy(OutPlanes[0], In, NumFrames * sizeof(int16));
+            return;
+        }
+        if (NumChannels != 2)
+        {
+            Scalar::Deinterleave(In, NumChannels, NumFrames, OutPlanes);
+            return;
+        }
+
+        int16* L = OutPlanes[0];
+        int16* R = OutPlanes[1];
+        int32 f = 0;
+#if PCMDSP_SSE2
+        for (; f + 8 <= NumFrames; f += 8)
+        {
+            const __m128i A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + 2 * f));
+            const __m128i B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + 2 * f + 8));
+            // Each 32-bit lane holds one L/R pair: sign-extend each half, then pack back (never saturates).
+            const __m128i LA = _mm_srai_epi32(_mm_slli_epi32(A, 16), 16);
+            const __m128i LB = _mm_srai_epi32(_mm_slli_epi32(B, 16), 16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(L + f), _mm_packs_epi32(LA, LB));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(R + f), _mm_packs_epi32(_mm_srai_epi32(A, 16), _mm_srai_epi32(B, 16)));
+        }
+#elif PCMDSP_NEON
+        for (; f + 8 <= NumFrames; f += 8)
+        {
+            const int16x8x2_t V = vld2q_s16(In + 2 * f);
+            vst1q_s16(L + f, V.val[0]);
+            vst1q_s16(R + f, V.val[1]);
+        }
+#endif
+        for (; f < NumFrames; ++f)
+        {
+            L[f] = In[2 * f];
+            R[f] = In[2 * f + 1];
+        }
+    }
+
+    void ComputePeakRms(const int16* In, int32 Num, float& OutPeak, float& OutRms)
+    {
+        int32 Peak = 0;
+        uint64 SumSq = 0;
+        int32 i = 0;
+#if PCMDSP_AVX2
+        {
+            __m256i Max16 = _mm256_setzero_si256();
+            __m256i Min16 = _mm256_setzero_si256();
+            __m256i Acc64 = _mm256_setzero_si256();
+            const __m256i Zero = _mm256_setzero_si256();
+            for (; i + 16 <= Num; i += 16)
+            {
+                const __m256i X = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(In + i));
+                Max16 = _mm256_max_epi16(Max16, X);
+                Min16 = _mm256_min_epi16(Min16, X);
+                // Pair sums of squares reach 2^31 for two -32768 samples: read them as unsigned.
+                const __m256i Sq = _mm256_madd_epi16(X, X);
+                Acc64 = _mm256_add_epi64(Acc64, _mm256_unpacklo_epi32(Sq, Zero));
+                Acc64 = _mm256_add_epi64(Acc64, _mm256_unpackhi_epi32(Sq, Zero));
+            }
+
+            alignas(32) int16 MaxLanes[16];
+            alignas(32) int16 MinLanes[16];
+            alignas(32) uint64 AccLanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(MaxLanes), Max16);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(MinLanes), Min16);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(AccLanes), Acc64);
+            for (int32 k = 0; k < 16; ++k)
+            {
+                Peak = FMath::Max(Peak, FMath::Max((int32)MaxLanes[k], -(int32)MinLanes[k]));
+            }
+            SumSq += AccLanes[0] + AccLanes[1] + AccLanes[2] + AccLanes[3];
+        }
+#endif
+#if PCMDSP_SSE2
+        {
+            __m128i Max16 = _mm_setzero_si128();
+            __m128i Min16 = _mm_setzero_si128();
+            __m128i Acc64 = _mm_setzero_si128();
+            const __m128i Zero = _mm_setzero_si128();
+            for (; i + 8 <= Num; i += 8)
+            {
+                const __m128i X = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + i));
+                Max16 = _mm_max_epi16(Max16, X);
+                Min16 = _mm_min_epi16(Min16, X);
+                const __m128i Sq = _mm_madd_epi16(X, X);
+                Acc64 = _mm_add_epi64(Acc64, _mm_unpacklo_epi32(Sq, Zero));
+                Acc64 = _mm_add_epi64(Acc64, _mm_unpackhi_epi32(Sq, Zero));
+            }
+
+            alignas(16) int16 MaxLanes[8];
+            alignas(16) int16 MinLanes[8];
+            alignas(16) uint64 AccLanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(MaxLanes), Max16);
+            _mm_store_si128(reinterpret_cast<__m128i*>(MinLanes), Min16);
+            _mm_store_si128(reinterpret_cast<__m128i*>(AccLanes), Acc64);
+            for (int32 k = 0; k < 8; ++k)
+            {
+                Peak = FMath::Max(Peak, FMath::Max((int32)MaxLanes[k], -(int32)MinLanes[k]));
+            }
+            SumSq += AccLanes[0] + AccLanes[1];
+        }
+#elif PCMDSP_NEON
+        {
+            int16x8_t Max16 = vdupq_n_s16(0);
+            int16x8_t Min16 = vdupq_n_s16(0);
+            int64x2_t Acc64 = vdupq_n_s64(0);
+            for (; i + 8 <= Num; i += 8)
+            {
+                const int16x8_t X = vld1q_s16(In + i);
+                Max16 = vmaxq_s16(Max16, X);
+                Min16 = vminq_s16(Min16, X);
+                Acc64 = vpadalq_s32(Acc64, vmull_s16(vget_low_s16(X), vget_low_s16(X)));
+                Acc64 = vpadalq_s32(Acc64, vmull_s16(vget_high_s16(X), vget_high_s16(X)));
+            }
+
+            int16 MaxLanes[8];
+            int16 MinLanes[8];
+            int64 AccLanes[2];
+            vst1q_s16(MaxLanes, Max16);
+            vst1q_s16(MinLanes, Min16);
+            vst1q_s64(AccLanes, Acc64);
+            for (int32 k = 0; k < 8; ++k)
+            {
+                Peak = FMath::Max(Peak, FMath::Max((int32)MaxLanes[k], -(int32)MinLanes[k]));
+            }
+            SumSq += (uint64)AccLanes[0] + (uint64)AccLanes[1];
+        }
+#endif
+        AccumulatePeakSumSq(In + i, Num - i, Peak, SumSq);
+        FinishPeakRms(Peak, SumSq, Num, OutPeak, OutRms);
+    }
+
+    float DotProduct(const float* A, const float* B, int32 Num)
+    {
+        float Sum = 0.0f;
+        int32 i = 0;
+#if PCMDSP_AVX2
+        {
+            // Two accumulators hide the add latency; the filters are 16 to 64 taps long.
+            __m256 Acc0 = _mm256_setzero_ps();
+            __m256 Acc1 = _mm256_setzero_ps();
+            for (; i + 16 <= Num; i += 16)
+            {
+                Acc0 = _mm256_add_ps(Acc0, _mm256_mul_ps(_mm256_loadu_ps(A + i), _mm256_loadu_ps(B + i)));
+                Acc1 = _mm256_add_ps(Acc1, _mm256_mul_ps(_mm256_loadu_ps(A + i + 8), _mm256_loadu_ps(B + i + 8)));
+            }
+            const __m256 Acc = _mm256_add_ps(Acc0, Acc1);
+            __m128 Acc4 = _mm_add_ps(_mm256_castps256_ps128(Acc), _mm256_extractf128_ps(Acc, 1));
+            Acc4 = _mm_add_ps(Acc4, _mm_movehl_ps(Acc4, Acc4));
+            Acc4 = _mm_add_ss(Acc4, _mm_shuffle_ps(Acc4, Acc4, 1));
+            Sum += _mm_cvtss_f32(Acc4);
+        }
+#endif
+#if PCMDSP_SSE2
+        {
+            __m128 Acc0 = _mm_setzero_ps();
+            __m128 Acc1 = _mm_setzero_ps();
+            for (; i + 8 <= Num; i += 8)
+            {
+                Acc0 = _mm_add_ps(Acc0, _mm_mul_ps(_mm_loadu_ps(A + i), _mm_loadu_ps(B + i)));
+                Acc1 = _mm_add_ps(Acc1, _mm_mul_ps(_mm_loadu_ps(A + i + 4), _mm_loadu_ps(B + i + 4)));
+            }
+            __m128 Acc4 = _mm_add_ps(Acc0, Acc1);
+            Acc4 = _mm_add_ps(Acc4, _mm_movehl_ps(Acc4, Acc4));
+            Acc4 = _mm_add_ss(Acc4, _mm_shuffle_ps(Acc4, Acc4, 1));
+            Sum += _mm_cvtss_f32(Acc4);
+        }
+#elif PCMDSP_NEON
+        {
+            float32x4_t Acc0 = vdupq_n_f32(0.0f);
+            float32x4_t Acc1 = vdupq_n_f32(0.0f);
+            for (; i + 8 <= Num; i += 8)
+            {
+                Acc0 = vmlaq_f32(Acc0, vld1q_f32(A + i), vld1q_f32(B + i));
+                Acc1 = vmlaq_f32(Acc1, vld1q_f32(A + i + 4), vld1q_f32(B + i + 4));
+            }
+            Sum += vaddvq_f32(vaddq_f32(Acc0, Acc1));
+        }
+#endif
+        return Sum + Scalar::DotProduct(A + i, B + i, Num - i);
+    }
+}
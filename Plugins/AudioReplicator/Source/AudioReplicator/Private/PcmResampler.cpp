@@ -0,0 +1,284 @@
+#include "PcmResampler.h"
+#include "PcmDsp.h"
+
+namespace
+{
+    struct FResamplePreset
+    {
+        int32 Taps;
+        // Kaiser window shape: higher is more stopband rejection and a wider transition band.
+        double Beta;
+        // Passband edge as a fraction of the lower Nyquist frequency.
+        double Rolloff;
+    };
+
+    FResamplePreset GetPreset(EAudioResampleQuality Quality)
+    {
+        switch (Quality)
+        {
+        case EAudioResampleQuality::Fast:     return { 16, 5.0, 0.86 };
+        case EAudioResampleQuality::High:     return { 64, 9.0, 0.95 };
+        case EAudioResampleQuality::Balanced:
+        default:                              return { 32, 7.0, 0.92 };
+        }
+    }
+
+    // Zeroth-order modified Bessel function of the first kind, for the Kaiser window.
+    double BesselI0(double X)
+    {
+        double Sum = 1.0;
+        double Term = 1.0;
+        const double HalfX = 0.5 * X;
+        for (int32 k = 1; k < 50 && Term > Sum * 1e-12; ++k)
+        {
+            const double T = HalfX / k;
+            Term *= T * T;
+            Sum += Term;
+        }
+        return Sum;
+    }
+
+    int32 GreatestCommonDivisor(int32 A, int32 B)
+    {
+        while (B != 0)
+        {
+            const int32 T = A % B;
+            A = B;
+            B = T;
+        }
+        return A;
+    }
+
+    constexpr int32 MaxRate = 384000;
+}
+
+bool FPcmResampler::Init(int32 InInputRate, int32 InOutputRate, int32 InChannels, EAudioResampleQuality Quality)
+{
+    if (InInputRate <= 0 || InOutputRate <= 0 || InInputRate > MaxRate || InOutputRate > MaxRate || InChannels <= 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FPcmResampler::Init: bad format %d -> %d Hz, Ch=%d"), InInputRate, InOutputRate, InChannels);
+        Channels = 0;
+        return false;
+    }
+
+    InputRate = InInputRate;
+    OutputRate = InOutputRate;
+    Channels = InChannels;
+
+    const int32 Gcd = GreatestCommonDivisor(InputRate, OutputRate);
+    Up = OutputRate / Gcd;
+    Down = InputRate / Gcd;
+
+    if (IsPassthrough())
+    {
+        Taps = 0;
+        NumPhases = 0;
+        Coefs.Reset();
+    }
+    else
+    {
+        BuildFilter(Quality);
+    }
+
+    Reset();
+    return true;
+}
+
+void FPcmResampler::BuildFilter(EAudioResampleQuality Quality)
+{
+    const FResamplePreset Preset = GetPreset(Quality);
+    Taps = Preset.Taps;
+    NumPhases = FMath::Min(Up, MaxPhases);
+
+    // Cutoff in cycles per input sample, below the Nyquist frequency of the lower rate.
+    const double Cutoff = 0.5 * Preset.Rolloff * FMath::Min(1.0, (double)Up / Down);
+    const double Center = Taps / 2;
+    const double HalfWidth = Center + 1.0;
+    const double WindowNorm = 1.0 / BesselI0(Preset.Beta);
+
+    Coefs.SetNumUninitialized((NumPhases + 1) * Taps);
+    for (int32 p = 0; p <= NumPhases; ++p)
+    {
+        float* Row = Coefs.GetData() + p * Taps;
+        const double PhaseOffset = (double)p / NumPhases;
+
+        double Sum = 0.0;
+        for (int32 k = 0; k < Taps; ++k)
+        {
+            // Distance of tap k from the output instant, in input samples.
+            const double X = k - Center - PhaseOffset;
+            const double Sinc = FMath::IsNearlyZero(X) ? 2.0 * Cutoff : FMath::Sin(2.0 * UE_DOUBLE_PI * Cutoff * X) / (UE_DOUBLE_PI * X);
+            const double R = X / HalfWidth;
+            const double Window = R * R < 1.0 ? BesselI0(Preset.Beta * FMath::Sqrt(1.0 - R * R)) * WindowNorm : 0.0;
+            const double C = Sinc * Window;
+            Row[k] = (float)C;
+            Sum += C;
+        }
+
+        // Unity gain at DC for every phase, so a constant signal carries no phase ripple.
+        const float Norm = Sum != 0.0 ? (float)(1.0 / Sum) : 1.0f;
+        for (int32 k = 0; k < Taps; ++k)
+        {
+            Row[k] *= Norm;
+        }
+    }
+}
+
+void FPcmResampler::Reset()
+{
+    History.SetNum(IsPassthrough() ? 0 : Channels);
+    for (TArray<float>& Plane : History)
+    {
+        Plane.Reset();
+        Plane.AddZeroed(Taps / 2);
+    }
+    Pos = 0;
+    Frac = 0;
+    TotalIn = 0;
+    TotalOut = 0;
+}
+
+int64 FPcmResampler::GetOutputFrames(int64 InFrames) const
+{
+    if (IsPassthrough())
+        return InFrames;
+    return (InFrames * Up + Down - 1) / Down;
+}
+
+int64 FPcmResampler::GetOutputFrames(int64 InFrames, int32 InputRate, int32 OutputRate)
+{
+    if (InputRate <= 0 || InputRate == OutputRate)
+        return InFrames;
+    const int32 Gcd = GreatestCommonDivisor(InputRate, OutputRate);
+    return (InFrames * (OutputRate / Gcd) + InputRate / Gcd - 1) / (InputRate / Gcd);
+}
+
+void FPcmResampler::Process(TArrayView<const int16> In, TArray<int16>& Out)
+{
+    if (!IsInitialized() || In.Num() < Channels)
+        return;
+
+    const int32 Frames = In.Num() / Channels;
+    if (IsPassthrough())
+    {
+        Out.Append(In.GetData(), Frames * Channels);
+        return;
+    }
+
+    AppendInput(In.GetData(), Frames);
+    Produce(MAX_int64, Out);
+}
+
+void FPcmResampler::Flush(TArray<int16>& Out)
+{
+    if (!IsInitialized() || IsPassthrough())
+        return;
+
+    // Zeros past the end let the window slide over the last input frames.
+    for (TArray<float>& Plane : History)
+    {
+        Plane.AddZeroed(Taps);
+    }
+    Produce(GetOutputFrames(TotalIn), Out);
+    Reset();
+}
+
+void FPcmResampler::AppendInput(const int16* In, int32 Frames)
+{
+    TotalIn += Frames;
+
+    if (Channels == 1)
+    {
+        TArray<float>& Plane = History[0];
+        const int32 Old = Plane.Num();
+        Plane.AddUninitialized(Frames);
+        PcmDsp::Int16ToFloat(In, Plane.GetData() + Old, Frames);
+        return;
+    }
+
+    InScratch.SetNumUninitialized(Frames * Channels, EAllowShrinking::No);
+    PcmDsp::Int16ToFloat(In, InScratch.GetData(), Frames * Channels);
+    for (int32 c = 0; c < Channels; ++c)
+    {
+        TArray<float>& Plane = History[c];
+        const int32 Old = Plane.Num();
+        Plane.AddUninitialized(Frames);
+        float* Dst = Plane.GetData() + Old;
+        const float* Src = InScratch.GetData() + c;
+        for (int32 f = 0; f < Frames; ++f)
+        {
+            Dst[f] = Src[f * Channels];
+        }
+    }
+}
+
+void FPcmResampler::Produce(int64 MaxFrames, TArray<int16>& Out)
+{
+    const int64 Avail = History[0].Num();
+    const bool bExactPhases = NumPhases == Up;
+    BlendRow.SetNumUninitialized(bExactPhases ? 0 : Taps, EAllowShrinking::No);
+
+    OutScratch.Reset();
+    while (TotalOut < MaxFrames && Pos + Taps <= Avail)
+    {
+        const float* Row;
+        if (bExactPhases)
+        {
+            Row = Coefs.GetData() + Frac * Taps;
+        }
+        else
+        {
+            const double X = (double)Frac * NumPhases / Up;
+            const int32 P = (int32)X;
+            const float T = (float)(X - P);
+            const float* R0 = Coefs.GetData() + P * Taps;
+            const float* R1 = R0 + Taps;
+            float* Blend = BlendRow.GetData();
+            for (int32 k = 0; k < Taps; ++k)
+            {
+                Blend[k] = R0[k] + T * (R1[k] - R0[k]);
+            }
+            Row = Blend;
+        }
+
+        for (int32 c = 0; c < Channels; ++c)
+        {
+            OutScratch.Add(PcmDsp::DotProduct(Row, History[c].GetData() + Pos, Taps));
+        }
+
+        ++TotalOut;
+        Frac += Down;
+        Pos += Frac / Up;
+        Frac %= Up;
+    }
+
+    if (OutScratch.Num() > 0)
+    {
+        const int32 Old = Out.Num();
+        Out.AddUninitialized(OutScratch.Num());
+        PcmDsp::FloatToInt16(OutScratch.GetData(), Out.GetData() + Old, OutScratch.Num());
+    }
+
+    // Drop the history the window has moved past.
+    const int32 Consumed = (int32)FMath::Min(Pos, Avail);
+    if (Consumed > 0)
+    {
+        for (TArray<float>& Plane : History)
+        {
+            Plane.RemoveAt(0, Consumed, EAllowShrinking::No);
+        }
+        Pos -= Consumed;
+    }
+}
+
+bool FPcmResampler::ResampleBuffer(TArrayView<const int16> In, int32 InputRate, int32 OutputRate, int32 Channels, EAudioResampleQuality Quality, TArray<int16>& Out)
+{
+    FPcmResampler Resampler;
+    if (!Resampler.Init(InputRate, OutputRate, Channels, Quality))
+        return false;
+
+    Out.Reset((int32)FMath::Min<int64>(Resampler.GetOutputFrames(In.Num() / Channels) * Channels, MAX_int32));
+    Resampler.Process(In, Out);
+    Resampler.Flush(Out);
+    return true;
+}
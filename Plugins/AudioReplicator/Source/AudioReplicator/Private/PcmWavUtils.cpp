@@ -1,7 +1,9 @@
 #include "PcmWavUtils.h"
-#include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "PcmDsp.h"
 
 // Lightweight utilities for reading and writing PCM16 WAV (RIFF/WAVE) files.
 //
@@ -9,18 +11,19 @@
 // - PcmWav::LoadWavFileToPcm16: Parse a WAV file on disk and extract
 //   interleaved PCM16 samples, sample rate, and channel count.
 // - PcmWav::SavePcm16ToWavFile: Serialize interleaved PCM16 samples to a
-//   standard RIFF/WAVE file on disk.
+//   standard RIFF/WAVE file on disk (through the incremental FWavWriter).
 //
 // Notes and assumptions:
-// - Only uncompressed PCM format (AudioFormat = 1) is supported.
-// - Only 16-bit samples are supported.
-// - Only mono or stereo (1 or 2 channels) is supported.
+// - Reading accepts 16/24/32-bit PCM, 32-bit float and WAVE_FORMAT_EXTENSIBLE,
+//   with any channel count; FWavConverter turns it into PCM16 mono or stereo.
+// - Writing produces 16-bit PCM, mono or stereo.
 // - Endianness: WAV is little-endian; helpers read/write LE explicitly.
 // - The code performs basic validation of RIFF/WAVE headers and chunk bounds
 //   and logs warnings via UE_LOG on failure, returning false.
 //
 // The implementation avoids allocations where possible and uses simple
-// byte-wise parsing of the RIFF chunk structure.
+// byte-wise parsing of the RIFF chunk structure. Files are read through
+// FWavReader, which maps the data chunk or reads it in bounded pieces.
 
 namespace
 {
@@ -28,18 +31,104 @@ namespace
     inline uint16 ReadU16LE(const uint8* p) { return (uint16)(p[0] | (p[1] << 8)); }
     inline uint32 ReadU32LE(const uint8* p) { return (uint32)(p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24)); }
 
-    // Append 16/32-bit unsigned integers to a byte buffer in little-endian order.
-    inline void WriteU16LE(TArray<uint8>& Out, uint16 v)
+    // Store 16/32-bit unsigned integers in little-endian order.
+    inline void StoreU16LE(uint8* p, uint16 v)
     {
-        Out.Add((uint8)(v & 0xFF));
-        Out.Add((uint8)((v >> 8) & 0xFF));
+        p[0] = (uint8)(v & 0xFF);
+        p[1] = (uint8)((v >> 8) & 0xFF);
     }
-    inline void WriteU32LE(TArray<uint8>& Out, uint32 v)
+    inline void StoreU32LE(uint8* p, uint32 v)
     {
-        Out.Add((uint8)(v & 0xFF));
-        Out.Add((uint8)((v >> 8) & 0xFF));
-        Out.Add((uint8)((v >> 16) & 0xFF));
-        Out.Add((uint8)((v >> 24) & 0xFF));
+        p[0] = (uint8)(v & 0xFF);
+        p[1] = (uint8)((v >> 8) & 0xFF);
+        p[2] = (uint8)((v >> 16) & 0xFF);
+        p[3] = (uint8)((v >> 24) & 0xFF);
+    }
+
+    // Canonical header: RIFF (12) + fmt chunk (8+16) + data chunk header (8).
+    constexpr int32 WavHeaderBytes = 44;
+
+    // The RIFF size field must hold the data plus the 36 header bytes after it.
+    constexpr int64 MaxDataBytes = (int64)MAX_uint32 - (WavHeaderBytes - 8);
+
+    void WriteHeader(uint8* Out, int32 SR, int32 Ch, uint32 DataBytes)
+    {
+        const uint32 BitsPerSample = 16;
+        const uint32 BlockAlign = (BitsPerSample / 8) * (uint32)Ch;
+        const uint32 ByteRate = (uint32)SR * BlockAlign;
+        const uint32 FmtChunkSize = 16; // PCM fmt chunk payload size
+        // RIFF chunk size (file size - 8): "WAVE" (4) + fmt chunk (8+N) + data chunk (8+M)
+        const uint32 RiffSize = 4 /*WAVE*/ + (8 + FmtChunkSize) + (8 + DataBytes);
+
+        // RIFF header
+        FMemory::Memcpy(Out + 0, "RIFF", 4);
+        StoreU32LE(Out + 4, RiffSize);
+        FMemory::Memcpy(Out + 8, "WAVE", 4);
+
+        // fmt chunk (PCM)
+        FMemory::Memcpy(Out + 12, "fmt ", 4);
+        StoreU32LE(Out + 16, FmtChunkSize);
+        StoreU16LE(Out + 20, 1);                    // AudioFormat = PCM
+        StoreU16LE(Out + 22, (uint16)Ch);           // NumChannels
+        StoreU32LE(Out + 24, (uint32)SR);           // SampleRate
+        StoreU32LE(Out + 28, ByteRate);             // ByteRate
+        StoreU16LE(Out + 32, (uint16)BlockAlign);   // BlockAlign
+        StoreU16LE(Out + 34, (uint16)BitsPerSample);// BitsPerSample
+
+        // data chunk header
+        FMemory::Memcpy(Out + 36, "data", 4);
+        StoreU32LE(Out + 40, DataBytes);
+    }
+
+    // Samples per IFileHandle::Read when the file could not be mapped.
+    constexpr int64 ReadChunkSamples = 256 * 1024;
+
+    // Frames converted per step when the source is not PCM16 in the output layout.
+    constexpr int32 ConvertBlockFrames = 4096;
+
+    constexpr uint16 WaveFormatPcm = 0x0001;
+    constexpr uint16 WaveFormatFloat = 0x0003;
+    constexpr uint16 WaveFormatExtensible = 0xFFFE;
+    constexpr int32 MaxSourceChannels = 32;
+
+    // SPEAKER_* bits of the extensible channel mask.
+    enum : uint32
+    {
+        SpeakerFrontLeft = 0x1, SpeakerFrontRight = 0x2, SpeakerFrontCenter = 0x4, SpeakerLowFrequency = 0x8,
+        SpeakerBackLeft = 0x10, SpeakerBackRight = 0x20, SpeakerFrontLeftOfCenter = 0x40, SpeakerFrontRightOfCenter = 0x80,
+        SpeakerBackCenter = 0x100, SpeakerSideLeft = 0x200, SpeakerSideRight = 0x400, SpeakerTopCenter = 0x800,
+        SpeakerTopFrontLeft = 0x1000, SpeakerTopFrontCenter = 0x2000, SpeakerTopFrontRight = 0x4000,
+        SpeakerTopBackLeft = 0x8000, SpeakerTopBackCenter = 0x10000, SpeakerTopBackRight = 0x20000
+    };
+
+    // Layouts assumed for files without a channel mask, by channel count (mono, stereo, 3.0, quad, 5.0, 5.1, 6.1, 7.1).
+    constexpr uint32 DefaultChannelMasks[] = { 0, 0x4, 0x3, 0x7, 0x33, 0x37, 0x3F, 0x70F, 0x63F };
+
+    // Stereo fold-down gains of one speaker: -3 dB for centre and surround, LFE dropped.
+    void GetStereoGains(uint32 Speaker, float& OutL, float& OutR)
+    {
+        constexpr float Minus3dB = 0.7071f;
+        switch (Speaker)
+        {
+        case SpeakerFrontLeft:          OutL = 1.0f;     OutR = 0.0f;     break;
+        case SpeakerFrontRight:         OutL = 0.0f;     OutR = 1.0f;     break;
+        case SpeakerLowFrequency:       OutL = 0.0f;     OutR = 0.0f;     break;
+        case SpeakerFrontLeftOfCenter:
+        case SpeakerBackLeft:
+        case SpeakerSideLeft:           OutL = Minus3dB; OutR = 0.0f;     break;
+        case SpeakerFrontRightOfCenter:
+        case SpeakerBackRight:
+        case SpeakerSideRight:          OutL = 0.0f;     OutR = Minus3dB; break;
+        case SpeakerTopFrontLeft:
+        case SpeakerTopBackLeft:        OutL = 0.5f;     OutR = 0.0f;     break;
+        case SpeakerTopFrontRight:
+        case SpeakerTopBackRight:       OutL = 0.0f;     OutR = 0.5f;     break;
+        case SpeakerBackCenter:
+        case SpeakerTopCenter:
+        case SpeakerTopFrontCenter:
+        case SpeakerTopBackCenter:      OutL = 0.5f;     OutR = 0.5f;     break;
+        default:                        OutL = Minus3dB; OutR = Minus3dB; break; // front centre and unknown
+        }
     }
 
     // Compare 4-byte ASCII tag at p with a null-terminated C-string tag.
@@ -108,117 +197,288 @@ namespace PcmWav
         return Full;
     }
 
+    int32 FWavSourceFormat::GetBytesPerSample() const
+    {
+        switch (SampleFormat)
+        {
+        case ESampleFormat::Int16: return 2;
+        case ESampleFormat::Int24: return 3;
+        default: return 4;
+        }
+    }
+
+    void FWavConverter::Configure(const FWavSourceFormat& InFormat, const FWavLoadOptions& InOptions)
+    {
+        Format = InFormat;
+        Options = InOptions;
+        Matrix.Reset();
+
+        const int32 InCh = Format.Channels;
+        OutChannels = (Options.Downmix == EAudioWavDownmix::Mono) ? 1 : FMath::Min(InCh, 2);
+
+        bPassthrough = Format.SampleFormat == ESampleFormat::Int16 && InCh == OutChannels;
+        if (InCh == OutChannels)
+            return;
+
+        Matrix.SetNumZeroed(OutChannels * InCh);
+        if (Options.Downmix == EAudioWavDownmix::FirstChannels)
+        {
+            for (int32 Out = 0; Out < OutChannels; ++Out)
+            {
+                Matrix[Out * InCh + Out] = 1.0f;
+            }
+            return;
+        }
+
+        // Speaker of each channel: the set bits of the mask in order, or the default layout for the count.
+        uint32 Mask = Format.ChannelMask;
+        if (Mask == 0 || FMath::CountBits(Mask) < (uint64)InCh)
+        {
+            Mask = (InCh < (int32)UE_ARRAY_COUNT(DefaultChannelMasks)) ? DefaultChannelMasks[InCh] : 0;
+        }
+
+        // The ITU gains are used as they are: scaling the rows down to their sum would leave a 5.1 fold-down
+        // about 7.6 dB quieter than the source. The rare peaks past full scale saturate in the 16-bit conversion.
+        for (int32 In = 0; In < InCh; ++In)
+        {
+            float L = 0.5f, R = 0.5f; // channels without a known position go to the middle
+            if (Mask != 0)
+            {
+                const uint32 Bit = Mask & (~Mask + 1);
+                Mask &= ~Bit;
+                GetStereoGains(Bit, L, R);
+            }
+
+            if (OutChannels == 1)
+            {
+                Matrix[In] = 0.5f * (L + R);
+            }
+            else
+            {
+                Matrix[In] = L;
+                Matrix[InCh + In] = R;
+            }
+        }
+    }
+
+    void FWavConverter::Convert(const uint8* Raw, int32 InNumFrames, int16* Out)
+    {
+        const int32 InCh = Format.Channels;
+        const int32 NumIn = InNumFrames * InCh;
+
+        if (bPassthrough)
+        {
+            FMemory::Memcpy(Out, Raw, NumIn * sizeof(int16));
+            return;
+        }
+
+        // 1) Source samples to float with the vector kernels.
+        SourceScratch.SetNumUninitialized(NumIn, EAllowShrinking::No);
+        float* Source = SourceScratch.GetData();
+        switch (Format.SampleFormat)
+        {
+        case ESampleFormat::Int16:   PcmDsp::Int16ToFloat(reinterpret_cast<const int16*>(Raw), Source, NumIn); break;
+        case ESampleFormat::Int24:   PcmDsp::Int24ToFloat(Raw, Source, NumIn); break;
+        case ESampleFormat::Int32:   PcmDsp::Int32ToFloat(reinterpret_cast<const int32*>(Raw), Source, NumIn); break;
+        case ESampleFormat::Float32: FMemory::Memcpy(Source, Raw, NumIn * sizeof(float)); break;
+        }
+
+        // 2) Channel mix; the matrix is tiny, so a plain loop over frames is enough.
+        const float* Mixed = Source;
+        if (Matrix.Num() > 0)
+        {
+            MixScratch.SetNumUninitialized(InNumFrames * OutChannels, EAllowShrinking::No);
+            float* Dst = MixScratch.GetData();
+            const float* Gains = Matrix.GetData();
+            for (int32 Frame = 0; Frame < InNumFrames; ++Frame)
+            {
+                const float* Src = Source + Frame * InCh;
+                for (int32 OutCh = 0; OutCh < OutChannels; ++OutCh)
+                {
+                    const float* Row = Gains + OutCh * InCh;
+                    float Acc = 0.0f;
+                    for (int32 InIdx = 0; InIdx < InCh; ++InIdx)
+                    {
+                        Acc += Row[InIdx] * Src[InIdx];
+                    }
+                    Dst[Frame * OutChannels + OutCh] = Acc;
+                }
+            }
+            Mixed = Dst;
+        }
+
+        // 3) Down to 16 bits; the kernels saturate, so a loud fold-down clips instead of wrapping.
+        const int32 NumOut = InNumFrames * OutChannels;
+        if (Options.bDither)
+        {
+            PcmDsp::FloatToInt16Dither(Mixed, Out, NumOut, DitherSeed);
+        }
+        else
+        {
+            PcmDsp::FloatToInt16(Mixed, Out, NumOut);
+        }
+    }
+
+    FWavReader::FWavReader() = default;
+
+    FWavReader::~FWavReader()
+    {
+        Close();
+    }
+
+    void FWavReader::Close()
+    {
+        // The region must go before the handle it was mapped from.
+        Mapped = TArrayView<const int16>();
+        MappedBytes = nullptr;
+        MappedRegion.Reset();
+        MappedFile.Reset();
+        File.Reset();
+        ReadScratch.Empty();
+        Format = FWavSourceFormat();
+        SampleRate = 0;
+        NumFrames = 0;
+        DataOffset = 0;
+        DataBytes = -1;
+    }
 
     /**
-     * Load a WAV (RIFF/WAVE) file from disk and decode interleaved PCM16 samples.
+     * Open a WAV (RIFF/WAVE) file and locate its fmt and data chunks.
      *
      * Supported formats:
-     * - AudioFormat = 1 (PCM)
-     * - BitsPerSample = 16
-     * - Channels = 1 or 2
+     * - AudioFormat = 1 (PCM) with 16, 24 or 32 bits per sample
+     * - AudioFormat = 3 (IEEE float) with 32 bits per sample
+     * - AudioFormat = 0xFFFE (extensible) with either of the above as sub-format
+     * - Any channel count up to MaxSourceChannels
      *
-     * On success, fills OutPcm with interleaved int16 samples, sets OutSR to the
-     * sample rate and OutCh to the channel count, and returns true. On failure,
-     * logs a warning and returns false with outputs cleared.
+     * Only the 8-byte chunk headers and the fmt payload are read; chunk payloads
+     * are skipped with Seek. Mapping is attempted afterwards and is optional.
      */
-    bool LoadWavFileToPcm16(const FString& InPath, TArray<int16>& OutPcm, int32& OutSR, int32& OutCh)
+    bool FWavReader::Open(const FString& InPath, const FWavLoadOptions& InOptions, bool bAllowMapping)
     {
-        OutPcm.Reset(); OutSR = 0; OutCh = 0;
+        Close();
 
         const FString Path = ResolveProjectPath_V3(InPath);
-        UE_LOG(LogTemp, Display, TEXT("LoadWavFileToPcm16: '%s' -> '%s'"), *InPath, *Path);
+        UE_LOG(LogTemp, Display, TEXT("FWavReader::Open: '%s' -> '%s'"), *InPath, *Path);
 
-        if (!FPaths::FileExists(Path))
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        File.Reset(PlatformFile.OpenRead(*Path));
+        if (!File)
         {
-            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: file not found: %s"), *Path);
+            UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: file not found: %s"), *Path);
             return false;
         }
 
-
-        TArray<uint8> Bytes;
-        if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+        const int64 FileSize = File->Size();
+        uint8 Riff[12];
+        if (FileSize < 12 || !File->Read(Riff, sizeof(Riff)))
         {
-            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: read failed: %s"), *Path);
+            UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: read failed: %s"), *Path);
+            Close();
             return false;
         }
 
-        const uint8* p = Bytes.GetData();
-        const uint8* end = p + Bytes.Num();
-
         // Validate RIFF/WAVE header
-        if (!Match4(p, "RIFF"))
+        if (!Match4(Riff, "RIFF") || !Match4(Riff + 8, "WAVE"))
         {
-            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: not RIFF %s"), *Path);
+            UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: not RIFF/WAVE %s"), *Path);
+            Close();
             return false;
         }
-        uint32 riffSize = ReadU32LE(p + 4); (void)riffSize;
-        if (!Match4(p + 8, "WAVE"))
-        {
-            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: not WAVE %s"), *Path);
-            return false;
-        }
-        const uint8* cursor = p + 12;
 
         // Scan for required chunks: "fmt " and "data"
         bool haveFmt = false, haveData = false;
-        int32 Channels = 0;
-        int32 SampleRate = 0;
-        int32 BitsPerSample = 0;
-        const uint8* dataPtr = nullptr;
-        uint32 dataSize = 0;
-
-        while (cursor + 8 <= end)
-        {
-            const uint8* chunkId = cursor;
-            uint32 chunkSize = ReadU32LE(cursor + 4);
-            const uint8* chunkData = cursor + 8;
-            const uint8* next = chunkData + chunkSize;
-            if (next > end)
+        int64 cursor = 12;
+        int64 dataBytes = 0;
+
+        while (cursor + 8 <= FileSize && !(haveFmt && haveData))
+        {
+            uint8 ChunkHeader[8];
+            if (!File->Seek(cursor) || !File->Read(ChunkHeader, sizeof(ChunkHeader)))
             {
-                UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: truncated chunk"));
+                UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: read failed: %s"), *Path);
+                Close();
                 return false;
             }
 
-            if (Match4(chunkId, "fmt "))
+            const uint32 chunkSize = ReadU32LE(ChunkHeader + 4);
+            const int64 chunkData = cursor + 8;
+            const int64 next = chunkData + chunkSize;
+            if (next > FileSize)
             {
-                // PCM format chunk (at least 16 bytes for PCM)
-                if (chunkSize < 16)
+                UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: truncated chunk"));
+                Close();
+                return false;
+            }
+
+            if (Match4(ChunkHeader, "fmt "))
+            {
+                // PCM format chunk (at least 16 bytes; 40 with the extensible fields)
+                uint8 Fmt[40];
+                const int32 fmtBytes = (int32)FMath::Min<uint32>(chunkSize, sizeof(Fmt));
+                if (chunkSize < 16 || !File->Read(Fmt, fmtBytes))
                 {
-                    UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: fmt chunk too small"));
+                    UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: fmt chunk too small"));
+                    Close();
                     return false;
                 }
-                uint16 audioFormat = ReadU16LE(chunkData + 0);
-                uint16 numChannels = ReadU16LE(chunkData + 2);
-                uint32 sampleRate = ReadU32LE(chunkData + 4);
-                /*uint32 byteRate    =*/ ReadU32LE(chunkData + 8);
-                /*uint16 blockAlign  =*/ ReadU16LE(chunkData + 12);
-                uint16 bitsPerSample = ReadU16LE(chunkData + 14);
-
-                if (audioFormat != 1 /*PCM*/)
+                uint16 audioFormat = ReadU16LE(Fmt + 0);
+                const uint16 numChannels = ReadU16LE(Fmt + 2);
+                const uint32 sampleRate = ReadU32LE(Fmt + 4);
+                const uint16 blockAlign = ReadU16LE(Fmt + 12);
+                const uint16 bitsPerSample = ReadU16LE(Fmt + 14);
+
+                if (audioFormat == WaveFormatExtensible)
                 {
-                    UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: only PCM supported (format=%u)"), (unsigned)audioFormat);
-                    return false;
+                    if (fmtBytes < 40)
+                    {
+                        UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: extensible fmt chunk too small"));
+                        Close();
+                        return false;
+                    }
+                    // The sub-format GUID starts with the plain format tag.
+                    Format.ChannelMask = ReadU32LE(Fmt + 20);
+                    audioFormat = ReadU16LE(Fmt + 24);
                 }
-                if (bitsPerSample != 16)
+
+                if (audioFormat == WaveFormatPcm && bitsPerSample == 16)
                 {
-                    UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: only 16-bit PCM supported (bps=%u)"), (unsigned)bitsPerSample);
+                    Format.SampleFormat = ESampleFormat::Int16;
+                }
+                else if (audioFormat == WaveFormatPcm && bitsPerSample == 24)
+                {
+                    Format.SampleFormat = ESampleFormat::Int24;
+                }
+                else if (audioFormat == WaveFormatPcm && bitsPerSample == 32)
+                {
+                    Format.SampleFormat = ESampleFormat::Int32;
+                }
+                else if (audioFormat == WaveFormatFloat && bitsPerSample == 32)
+                {
+                    Format.SampleFormat = ESampleFormat::Float32;
+                }
+                else
+                {
+                    UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: unsupported format=%u bps=%u"), (unsigned)audioFormat, (unsigned)bitsPerSample);
+                    Close();
                     return false;
                 }
-                if (numChannels != 1 && numChannels != 2)
+
+                Format.Channels = (int32)numChannels;
+                if (numChannels < 1 || numChannels > MaxSourceChannels || blockAlign != Format.GetBytesPerFrame())
                 {
-                    UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: unsupported channels=%u"), (unsigned)numChannels);
+                    UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: unsupported channels=%u blockAlign=%u"), (unsigned)numChannels, (unsigned)blockAlign);
+                    Close();
                     return false;
                 }
 
-                Channels = (int32)numChannels;
                 SampleRate = (int32)sampleRate;
-                BitsPerSample = (int32)bitsPerSample;
                 haveFmt = true;
             }
-            else if (Match4(chunkId, "data"))
+            else if (Match4(ChunkHeader, "data"))
             {
-                dataPtr = chunkData;
-                dataSize = chunkSize;
+                DataOffset = chunkData;
+                dataBytes = chunkSize;
                 haveData = true;
             }
 
@@ -226,35 +486,280 @@ namespace PcmWav
             cursor = next + (chunkSize & 1 ? 1 : 0);
         }
 
-        if (!haveFmt || !haveData || dataPtr == nullptr)
+        if (!haveFmt || !haveData || SampleRate <= 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FWavReader::Open: missing fmt or data chunk"));
+            Close();
+            return false;
+        }
+
+        // Whole frames only.
+        NumFrames = dataBytes / Format.GetBytesPerFrame();
+        DataBytes = NumFrames * Format.GetBytesPerFrame();
+        Converter.Configure(Format, InOptions);
+
+#if PLATFORM_LITTLE_ENDIAN
+        if (bAllowMapping && DataBytes > 0)
+        {
+            auto Result = PlatformFile.OpenMappedEx(*Path);
+            if (Result.HasValue())
+            {
+                MappedFile = Result.StealValue();
+                MappedRegion.Reset(MappedFile->MapRegion(DataOffset, DataBytes));
+            }
+
+            if (MappedRegion && MappedRegion->GetMappedSize() == DataBytes)
+            {
+                MappedBytes = MappedRegion->GetMappedPtr();
+
+                // The data chunk starts on a word boundary, but check before viewing it as int16.
+                if (Converter.IsPassthrough() && IsAligned(MappedBytes, alignof(int16)))
+                {
+                    Mapped = MakeArrayView(reinterpret_cast<const int16*>(MappedBytes), (int32)FMath::Min<int64>(GetNumSamples(), MAX_int32));
+                }
+            }
+            else
+            {
+                MappedRegion.Reset();
+                MappedFile.Reset();
+            }
+        }
+#endif
+        return true;
+    }
+
+    int64 FWavReader::ReadSamples(int64 FirstSample, TArrayView<int16> Out)
+    {
+        if (!IsOpen() || FirstSample < 0)
+            return -1;
+
+        const int64 Count = FMath::Min<int64>(Out.Num(), GetNumSamples() - FirstSample);
+        if (Count <= 0)
+            return 0;
+
+        if (IsMapped() && FirstSample + Count <= Mapped.Num())
+        {
+            FMemory::Memcpy(Out.GetData(), Mapped.GetData() + FirstSample, Count * sizeof(int16));
+            return Count;
+        }
+
+        const int32 OutCh = GetChannels();
+        if (!Converter.IsPassthrough() && FirstSample % OutCh != 0)
+            return -1;
+
+        if (Converter.IsPassthrough())
+        {
+            // Straight chunked copy into the caller's buffer.
+            if (MappedBytes)
+            {
+                FMemory::Memcpy(Out.GetData(), MappedBytes + FirstSample * sizeof(int16), Count * sizeof(int16));
+            }
+            else
+            {
+                if (!File->Seek(DataOffset + FirstSample * (int64)sizeof(int16)))
+                    return -1;
+                for (int64 Done = 0; Done < Count; )
+                {
+                    const int64 Step = FMath::Min(ReadChunkSamples, Count - Done);
+                    if (!File->Read(reinterpret_cast<uint8*>(Out.GetData() + Done), Step * sizeof(int16)))
+                        return -1;
+                    Done += Step;
+                }
+            }
+#if !PLATFORM_LITTLE_ENDIAN
+            for (int64 i = 0; i < Count; ++i)
+            {
+                Out[i] = (int16)BYTESWAP_ORDER16((uint16)Out[i]);
+            }
+#endif
+            return Count;
+        }
+
+        const int32 BytesPerFrame = Format.GetBytesPerFrame();
+        const int64 FirstFrame = FirstSample / OutCh;
+        const int64 EndFrame = FMath::DivideAndRoundUp(FirstSample + Count, (int64)OutCh);
+
+        if (!MappedBytes && !File->Seek(DataOffset + FirstFrame * BytesPerFrame))
+            return -1;
+
+        // Convert block by block; a partial last frame is converted into a scratch frame.
+        TArray<int16, TInlineAllocator<MaxSourceChannels>> Tail;
+        int64 Written = 0;
+        for (int64 Frame = FirstFrame; Frame < EndFrame; )
+        {
+            const int32 Step = (int32)FMath::Min<int64>(ConvertBlockFrames, EndFrame - Frame);
+            const uint8* Raw = MappedBytes ? MappedBytes + Frame * BytesPerFrame : nullptr;
+            if (!Raw || (Format.GetBytesPerSample() == 4 && !IsAligned(Raw, alignof(int32))))
+            {
+                // Unmapped, or 32-bit samples at an unaligned address: stage the block.
+                ReadScratch.SetNumUninitialized(Step * BytesPerFrame, EAllowShrinking::No);
+                if (Raw)
+                {
+                    FMemory::Memcpy(ReadScratch.GetData(), Raw, Step * BytesPerFrame);
+                }
+                else if (!File->Read(ReadScratch.GetData(), Step * BytesPerFrame))
+                {
+                    return -1;
+                }
+                Raw = ReadScratch.GetData();
+            }
+
+            const int64 Wanted = FMath::Min<int64>((int64)Step * OutCh, Count - Written);
+            if (Wanted == (int64)Step * OutCh)
+            {
+                Converter.Convert(Raw, Step, Out.GetData() + Written);
+            }
+            else
+            {
+                // Only the last frame can be partial; convert the full frames directly, then the tail.
+                const int32 Full = (int32)(Wanted / OutCh);
+                Converter.Convert(Raw, Full, Out.GetData() + Written);
+                Tail.SetNumUninitialized(OutCh);
+                Converter.Convert(Raw + Full * BytesPerFrame, 1, Tail.GetData());
+                FMemory::Memcpy(Out.GetData() + Written + Full * OutCh, Tail.GetData(), (Wanted - Full * OutCh) * sizeof(int16));
+            }
+            Written += Wanted;
+            Frame += Step;
+        }
+        return Written;
+    }
+
+    /**
+     * Load a WAV (RIFF/WAVE) file from disk and decode interleaved PCM16 samples.
+     *
+     * On success, fills OutPcm with interleaved int16 samples, sets OutSR to the
+     * sample rate and OutCh to the channel count after downmix, and returns true.
+     * On failure, logs a warning and returns false with outputs cleared.
+     *
+     * The samples are copied or converted from the mapping, or read in chunks,
+     * straight into OutPcm, so peak memory is the PCM itself rather than file plus PCM.
+     */
+    bool LoadWavFileToPcm16(const FString& InPath, TArray<int16>& OutPcm, int32& OutSR, int32& OutCh, const FWavLoadOptions& Options)
+    {
+        OutPcm.Reset(); OutSR = 0; OutCh = 0;
+
+        FWavReader Reader;
+        if (!Reader.Open(InPath, Options))
+            return false;
+
+        const int64 SampleCount = Reader.GetNumSamples();
+        if (SampleCount > MAX_int32)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: data chunk too large (%lld samples)"), SampleCount);
+            return false;
+        }
+
+        OutPcm.SetNumUninitialized((int32)SampleCount);
+        if (Reader.ReadSamples(0, OutPcm) != SampleCount)
         {
-            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: missing fmt or data chunk"));
+            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: read failed: %s"), *InPath);
+            OutPcm.Reset();
             return false;
         }
 
-        if (BitsPerSample != 16 || Channels <= 0 || SampleRate <= 0)
+        OutSR = Reader.GetSampleRate();
+        OutCh = Reader.GetChannels();
+        return true;
+    }
+
+    FWavWriter::FWavWriter() = default;
+
+    FWavWriter::~FWavWriter()
+    {
+        Close();
+    }
+
+    bool FWavWriter::Open(const FString& InPath, int32 InSampleRate, int32 InChannels)
+    {
+        Close();
+
+        if (InSampleRate <= 0 || (InChannels != 1 && InChannels != 2))
         {
-            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: bad fmt parameters"));
+            UE_LOG(LogTemp, Warning, TEXT("FWavWriter::Open: bad params SR=%d Ch=%d"), InSampleRate, InChannels);
             return false;
         }
 
-        if (dataPtr + dataSize > end)
+        // Resolve relative paths against ProjectSavedDir rather than Engine/Binaries CWD.
+        FullPath = ResolveProjectPath_V3(InPath);
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(FullPath), /*Tree=*/true);
+
+        File.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FullPath));
+        if (!File)
         {
-            UE_LOG(LogTemp, Warning, TEXT("LoadWavFileToPcm16: data size out of bounds"));
+            UE_LOG(LogTemp, Warning, TEXT("FWavWriter::Open: failed to open %s"), *FullPath);
             return false;
         }
 
-        // Copy PCM payload as int16 little-endian samples (interleaved by channel).
-        const int32 SampleCount = (int32)(dataSize / sizeof(int16));
-        OutPcm.SetNumUninitialized(SampleCount);
-        FMemory::Memcpy(OutPcm.GetData(), dataPtr, SampleCount * sizeof(int16));
+        SampleRate = InSampleRate;
+        Channels = InChannels;
+        DataBytes = 0;
+        bFailed = false;
 
-        OutSR = SampleRate;
-        OutCh = Channels;
+        // Sizes are written as zero and patched by Close.
+        uint8 Header[WavHeaderBytes];
+        WriteHeader(Header, SampleRate, Channels, 0);
+        if (!File->Write(Header, sizeof(Header)))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FWavWriter::Open: failed to write %s"), *FullPath);
+            File.Reset();
+            return false;
+        }
+        return true;
+    }
+
+    bool FWavWriter::Append(TArrayView<const int16> Pcm)
+    {
+        if (!File || bFailed)
+            return false;
+        if (Pcm.Num() == 0)
+            return true;
+
+        const int64 Bytes = (int64)Pcm.Num() * sizeof(int16);
+        if (DataBytes + Bytes > MaxDataBytes)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FWavWriter::Append: %s would exceed the 4 GB RIFF limit"), *FullPath);
+            bFailed = true;
+            return false;
+        }
+
+#if PLATFORM_LITTLE_ENDIAN
+        if (!File->Write(reinterpret_cast<const uint8*>(Pcm.GetData()), Bytes))
+#else
+        TArray<int16> Swapped(Pcm.GetData(), Pcm.Num());
+        for (int16& S : Swapped)
+        {
+            S = (int16)BYTESWAP_ORDER16((uint16)S);
+        }
+        if (!File->Write(reinterpret_cast<const uint8*>(Swapped.GetData()), Bytes))
+#endif
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FWavWriter::Append: write failed: %s"), *FullPath);
+            bFailed = true;
+            return false;
+        }
 
+        DataBytes += Bytes;
         return true;
     }
 
+    bool FWavWriter::Close()
+    {
+        if (!File)
+            return false;
+
+        // Patched even after a failed Append: the header then covers the samples written before it, so the
+        // file still plays. The failure only shows in the return value.
+        uint8 Header[WavHeaderBytes];
+        WriteHeader(Header, SampleRate, Channels, (uint32)DataBytes);
+        const bool bPatched = File->Seek(0) && File->Write(Header, sizeof(Header)) && File->Flush();
+        if (!bPatched)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("FWavWriter::Close: failed to finalize %s"), *FullPath);
+        }
+        File.Reset();
+        return bPatched && !bFailed;
+    }
+
     /**
      * Save interleaved PCM16 samples to a WAV (RIFF/WAVE) file on disk.
      *
@@ -273,55 +778,16 @@ namespace PcmWav
             return false;
         }
 
-        const uint32 BitsPerSample = 16;
-        const uint32 BlockAlign = (BitsPerSample / 8) * (uint32)Ch;
-        const uint32 ByteRate = (uint32)SR * BlockAlign;
-        const uint32 DataBytes = (uint32)(Pcm.Num() * sizeof(int16));
-        const uint32 FmtChunkSize = 16; // PCM fmt chunk payload size
-        // RIFF chunk size (file size - 8): "WAVE" (4) + fmt chunk (8+N) + data chunk (8+M)
-        const uint32 RiffSize = 4 /*WAVE*/ + (8 + FmtChunkSize) + (8 + DataBytes);
-
-        TArray<uint8> Out;
-        Out.Reserve(12 + 8 + FmtChunkSize + 8 + DataBytes);
-
-        // RIFF header
-        Out.Append((const uint8*)"RIFF", 4);
-        WriteU32LE(Out, RiffSize);
-        Out.Append((const uint8*)"WAVE", 4);
-
-        // fmt chunk (PCM)
-        Out.Append((const uint8*)"fmt ", 4);
-        WriteU32LE(Out, FmtChunkSize);
-        WriteU16LE(Out, 1);                 // AudioFormat = PCM
-        WriteU16LE(Out, (uint16)Ch);        // NumChannels
-        WriteU32LE(Out, (uint32)SR);        // SampleRate
-        WriteU32LE(Out, ByteRate);          // ByteRate
-        WriteU16LE(Out, (uint16)BlockAlign);// BlockAlign
-        WriteU16LE(Out, (uint16)BitsPerSample); // BitsPerSample
-
-        // data chunk header
-        Out.Append((const uint8*)"data", 4);
-        WriteU32LE(Out, DataBytes);
-
-        // PCM payload
-        if (DataBytes > 0)
-        {
-            const uint8* Raw = reinterpret_cast<const uint8*>(Pcm.GetData());
-            Out.Append(Raw, DataBytes);
-        }
-
-        // Ensure output directory exists before writing the file. Resolve relative
-        // paths against ProjectSavedDir rather than Engine/Binaries CWD.
-        const FString FullPath = ResolveProjectPath_V3(InPath);
-        const FString Dir = FPaths::GetPath(FullPath);
-        IFileManager::Get().MakeDirectory(*Dir, /*Tree=*/true);
+        FWavWriter Writer;
+        if (!Writer.Open(InPath, SR, Ch))
+            return false;
 
-        if (!FFileHelper::SaveArrayToFile(Out, *FullPath))
+        const bool bAppended = Writer.Append(Pcm);
+        if (!Writer.Close() || !bAppended)
         {
-            UE_LOG(LogTemp, Warning, TEXT("SavePcm16ToWavFile: failed to save %s"), *FullPath);
+            UE_LOG(LogTemp, Warning, TEXT("SavePcm16ToWavFile: failed to save %s"), *InPath);
             return false;
         }
-
         return true;
     }
 }
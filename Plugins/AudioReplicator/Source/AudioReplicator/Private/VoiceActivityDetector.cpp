@@ -0,0 +1,47 @@
+#include "VoiceActivityDetector.h"
+#include "PcmDsp.h"
+
+void FVoiceActivityDetector::Configure(float InThreshold, int32 InHangoverFrames)
+{
+    Threshold = FMath::Clamp(InThreshold, 0.0f, 1.0f);
+    HangoverFrames = FMath::Max(0, InHangoverFrames);
+    Reset();
+}
+
+bool FVoiceActivityDetector::IsAboveThreshold(const int16* Samples, int32 NumSamples) const
+{
+    if (Threshold <= 0.0f)
+        return true;
+    if (!Samples || NumSamples <= 0)
+        return false;
+
+    float Peak = 0.0f;
+    float Rms = 0.0f;
+    PcmDsp::ComputePeakRms(Samples, NumSamples, Peak, Rms);
+    return Rms >= Threshold;
+}
+
+bool FVoiceActivityDetector::Update(bool bAboveThreshold, bool bEncoderInDtx)
+{
+    if (bAboveThreshold && !bEncoderInDtx)
+    {
+        HangoverLeft = HangoverFrames;
+        bActive = true;
+    }
+    else if (HangoverLeft > 0)
+    {
+        --HangoverLeft;
+        bActive = true;
+    }
+    else
+    {
+        bActive = false;
+    }
+    return bActive;
+}
+
+void FVoiceActivityDetector::Reset()
+{
+    HangoverLeft = 0;
+    bActive = false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Per-frame bitrate and expected-loss control for one live session.
+ *
+ * Congestion (a saturated connection or pacer budget, frames piling up unsent, or heavy loss at the
+ * receivers) cuts the bitrate by a fifth at most every 200 ms. Once the path has been clear for two
+ * seconds it climbs back towards the maximum by 8% of it per second. The expected loss follows the
+ * worst receiver report within the configured bounds, so Opus spends bits on in-band FEC only when
+ * frames are actually being lost.
+ */
+class AUDIOREPLICATOR_API FAudioBitrateController
+{
+public:
+    struct FConditions
+    {
+        // Frames encoded but not sent yet.
+        int32 QueuedFrames = 0;
+        // The local connection, the pacer budget or a relay recipient is saturated.
+        bool bSaturated = false;
+        // Worst loss the receivers reported recently, in percent.
+        int32 LossPercent = 0;
+    };
+
+    // Starts at MaxBitrate and MinLossPercent.
+    void Configure(int32 InMinBitrate, int32 InMaxBitrate, int32 InMinLossPercent, int32 InMaxLossPercent, int32 InFrameMs);
+
+    // Feed the conditions before a frame is encoded; true when the bitrate or loss percentage changed.
+    bool Update(const FConditions& Conditions);
+
+    bool IsEnabled() const { return MaxBitrate > 0; }
+    int32 GetBitrate() const { return Bitrate; }
+    int32 GetLossPercent() const { return LossPercent; }
+    int32 GetNumDecreases() const { return NumDecreases; }
+
+private:
+    int32 MinBitrate = 0;
+    int32 MaxBitrate = 0;
+    int32 MinLossPercent = 0;
+    int32 MaxLossPercent = 0;
+
+    // Thresholds in frames, derived from the frame duration.
+    int32 QueueHighFrames = 3;
+    int32 DecreaseIntervalFrames = 10;
+    int32 HoldFrames = 100;
+    double IncreasePerFrame = 0.0;
+
+    double Rate = 0.0;
+    int32 Bitrate = 0;
+    int32 LossPercent = 0;
+    int32 FramesSinceDecrease = 0;
+    int32 NumDecreases = 0;
+};
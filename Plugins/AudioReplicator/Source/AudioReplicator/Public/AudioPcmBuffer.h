@@ -0,0 +1,58 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "AudioPcmBuffer.generated.h"
+
+/**
+ * Opaque handle to interleaved PCM16 audio for Blueprints.
+ *
+ * The samples stay in int16 and are passed between the library nodes by reference, so a
+ * load -> encode -> decode -> save chain never widens them. Sample values are only copied
+ * out (as int32) when a script explicitly asks for them.
+ */
+UCLASS(BlueprintType)
+class AUDIOREPLICATOR_API UAudioPcmBuffer : public UObject
+{
+    GENERATED_BODY()
+public:
+    // New buffer in the transient package taking ownership of the samples.
+    static UAudioPcmBuffer* Create(TArray<int16>&& InSamples, int32 InSampleRate, int32 InChannels);
+
+    const TArray<int16>& GetSamples() const { return Samples; }
+    TArray<int16>& GetMutableSamples() { return Samples; }
+    void SetSamples(TArray<int16>&& InSamples, int32 InSampleRate, int32 InChannels);
+
+    UFUNCTION(BlueprintPure, Category = "AudioReplicator|PCM")
+    int32 GetSampleRate() const { return SampleRate; }
+
+    UFUNCTION(BlueprintPure, Category = "AudioReplicator|PCM")
+    int32 GetChannels() const { return Channels; }
+
+    // Total interleaved samples (all channels).
+    UFUNCTION(BlueprintPure, Category = "AudioReplicator|PCM")
+    int32 GetNumSamples() const { return Samples.Num(); }
+
+    UFUNCTION(BlueprintPure, Category = "AudioReplicator|PCM")
+    float GetDurationSec() const;
+
+    // Copy Count samples starting at StartSample out as int32; Count < 0 means up to the end.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|PCM")
+    void GetSampleValues(int32 StartSample, int32 Count, TArray<int32>& OutValues) const;
+
+    // Replace the contents; values are clamped to the int16 range.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|PCM")
+    void SetSampleValues(const TArray<int32>& Values, int32 InSampleRate, int32 InChannels);
+
+    // Scale every sample in place; results saturate at the int16 range.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|PCM")
+    void ApplyGain(float Gain);
+
+    // Append interleaved samples of another buffer with the same format.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|PCM")
+    bool AppendBuffer(const UAudioPcmBuffer* Other);
+
+private:
+    TArray<int16> Samples;
+    int32 SampleRate = AUDIO_REPL_OPUS_SR;
+    int32 Channels = 1;
+};
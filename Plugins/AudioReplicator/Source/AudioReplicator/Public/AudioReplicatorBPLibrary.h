@@ -2,6 +2,9 @@
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "OpusTypes.h"
 #include "AudioReplicatorDebugTypes.h"
+#include "AudioPcmBuffer.h"
+#include "PcmWavUtils.h"
+#include "PcmResampler.h"
 #include "AudioReplicatorBPLibrary.generated.h"
 
 UCLASS()
@@ -13,8 +16,12 @@ public:
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
     static bool LoadWavToPcm16(const FString& WavPath, TArray<int32>& OutPcm16, int32& OutSampleRate, int32& OutChannels);
 
+    // Sample rates Opus cannot encode (44.1 kHz, ...) are resampled to AUDIO_REPL_OPUS_SR first;
+    // pass the same SampleRate to the decode nodes to get the original rate back.
+    // The last frame is padded with silence; OutHeader carries the trims DecodeOpusStreamToPcmBuffer
+    // needs to give back exactly the samples that went in.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
-    static bool EncodePcm16ToOpusPackets(const TArray<int32>& Pcm16, int32 SampleRate, int32 Channels, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets);
+    static bool EncodePcm16ToOpusPackets(const TArray<int32>& Pcm16, int32 SampleRate, int32 Channels, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader, EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip);
 
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
     static void PackOpusPackets(const TArray<FOpusPacket>& Packets, TArray<uint8>& OutBuffer);
@@ -22,14 +29,42 @@ public:
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
     static bool UnpackOpusPackets(const TArray<uint8>& Buffer, TArray<FOpusPacket>& OutPackets);
 
+    // OutputSampleRate resamples the result, e.g. to the audio device rate; 0 keeps SampleRate.
+    // Without a header the encoder delay and the end padding stay in the output.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
-    static bool DecodeOpusPacketsToPcm16(const TArray<FOpusPacket>& Packets, int32 SampleRate, int32 Channels, TArray<int32>& OutPcm16);
+    static bool DecodeOpusPacketsToPcm16(const TArray<FOpusPacket>& Packets, int32 SampleRate, int32 Channels, TArray<int32>& OutPcm16, int32 OutputSampleRate = 0);
 
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
     static bool SavePcm16ToWav(const FString& OutPath, const TArray<int32>& Pcm16, int32 SampleRate, int32 Channels);
 
+    // PCM buffer handles: the same operations without widening samples to int32.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
-    static bool TranscodeWavToOpusAndBack(const FString& InWavPath, const FString& OutWavPath, int32 Bitrate = 32000, int32 FrameMs = 20);
+    static bool LoadWavToPcmBuffer(const FString& WavPath, UAudioPcmBuffer*& OutBuffer, EAudioWavDownmix Downmix = EAudioWavDownmix::Stereo);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
+    static bool EncodePcmBufferToOpusPackets(const UAudioPcmBuffer* Buffer, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader, EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
+    static bool DecodeOpusPacketsToPcmBuffer(const TArray<FOpusPacket>& Packets, int32 SampleRate, int32 Channels, UAudioPcmBuffer*& OutBuffer, int32 OutputSampleRate = 0);
+
+    // Decode with the header from an encode node or a received session: the pre-skip and end
+    // padding are trimmed, so a clip comes back at its original length.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
+    static bool DecodeOpusStreamToPcmBuffer(const TArray<FOpusPacket>& Packets, const FOpusStreamHeader& Header, UAudioPcmBuffer*& OutBuffer, int32 OutputSampleRate = 0);
+
+    // Convert a buffer to another sample rate with FPcmResampler.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
+    static bool ResamplePcmBuffer(const UAudioPcmBuffer* Buffer, int32 SampleRate, UAudioPcmBuffer*& OutBuffer, EAudioResampleQuality Quality = EAudioResampleQuality::Balanced);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
+    static bool SavePcmBufferToWav(const FString& OutPath, const UAudioPcmBuffer* Buffer);
+
+    // Wrap int32 sample values (clamped) in a new buffer.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
+    static UAudioPcmBuffer* MakePcmBuffer(const TArray<int32>& Pcm16, int32 SampleRate, int32 Channels);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Local")
+    static bool TranscodeWavToOpusAndBack(const FString& InWavPath, const FString& OutWavPath, int32 Bitrate = 32000, int32 FrameMs = 20, EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip);
 
     UFUNCTION(BlueprintPure, Category = "AudioReplicator|Paths")
     static FString ResolveProjectPath(const FString& Path);
@@ -51,6 +86,26 @@ public:
         int32 BufferBytes,
         int32 PacketCount);
 
+    // Times the vector PCM kernels against their scalar reference; slow, run it from a debug menu.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    static FString RunPcmKernelBenchmark(int32 Iterations = 200);
+
+    // Cost of converting one second of each supported WAV format to PCM16.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    static FString RunWavConversionBenchmark(int32 Iterations = 100);
+
+    // Resampler cost and delay at each quality preset.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    static FString RunResamplerBenchmark(int32 Iterations = 20);
+
+    // Encode CPU per second of audio, packet rate and delay for each EOpusEncoderProfile.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    static FString RunEncoderProfileBenchmark(int32 Seconds = 10);
+
+    // Peak and RMS level (0..1) of a PCM buffer, e.g. for a mic meter.
+    UFUNCTION(BlueprintPure, Category = "AudioReplicator|Debug")
+    static void GetPcmBufferLevel(const UAudioPcmBuffer* Buffer, float& OutPeak, float& OutRms);
+
     UFUNCTION(BlueprintPure, Category = "AudioReplicator|Debug")
     static FString OpusStreamHeaderToString(const FOpusStreamHeader& Header);
 
@@ -0,0 +1,23 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Micro-benchmarks for the hot paths of the plugin.
+ *
+ * Each one runs on synthetic data and returns a printable report; nothing here runs unless
+ * called explicitly (see the Debug nodes in UAudioReplicatorBPLibrary).
+ */
+namespace AudioReplicatorBenchmarks
+{
+    // PcmDsp vector kernels against the scalar reference on one second of 48 kHz stereo.
+    FString RunPcmKernels(int32 Iterations);
+
+    // PcmWav::FWavConverter on one second of 48 kHz audio in each supported source format and layout.
+    FString RunWavConversion(int32 Iterations);
+
+    // FPcmResampler at every quality preset for common rate pairs, one second of stereo per call.
+    FString RunResampler(int32 Iterations);
+
+    // FOpusCodec at every EOpusEncoderProfile on Seconds of a speech-like 48 kHz signal, mono and stereo.
+    FString RunEncoderProfiles(int32 Seconds);
+}
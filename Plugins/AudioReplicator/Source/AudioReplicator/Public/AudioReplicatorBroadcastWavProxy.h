@@ -0,0 +1,72 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "HAL/ThreadSafeBool.h"
+#include "OpusTypes.h"
+#include "AudioReplicatorBroadcastWavProxy.generated.h"
+
+class UAudioReplicatorComponent;
+class FOpusPacketArena;
+struct FBroadcastWavSource;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnWavBroadcastAsyncEvent, FGuid, SessionId, const FOpusStreamHeader&, Header, float, Progress);
+
+/**
+ * Async Blueprint node that broadcasts a WAV file without touching the game thread for the heavy work.
+ *
+ * The file is opened (memory-mapped when possible) and hashed for the clip cache on a background task.
+ * Once the header is known the clip is opened as a streamed transfer and OnStarted fires; the PCM is then
+ * encoded in blocks with one pooled encoder and every block is appended to the outgoing queue as soon as it is ready, so the first
+ * chunks are on the wire long before the last ones are encoded. Sources at a rate Opus cannot encode are
+ * resampled block by block just ahead of the encoder. All events fire on the game thread.
+ */
+UCLASS()
+class AUDIOREPLICATOR_API UAudioReplicatorBroadcastWavProxy : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+public:
+
+    // Header is known and the session is open.
+    UPROPERTY(BlueprintAssignable)
+    FOnWavBroadcastAsyncEvent OnStarted;
+
+    // Fraction of the clip encoded and queued, once per block.
+    UPROPERTY(BlueprintAssignable)
+    FOnWavBroadcastAsyncEvent OnProgress;
+
+    // Every packet is queued, or the server already had the clip in its cache.
+    UPROPERTY(BlueprintAssignable)
+    FOnWavBroadcastAsyncEvent OnCompleted;
+
+    // Load or encode failed, or the session was cancelled; SessionId is invalid if it never opened.
+    UPROPERTY(BlueprintAssignable)
+    FOnWavBroadcastAsyncEvent OnFailed;
+
+    // Owning client only, like StartBroadcastFromWav.
+    UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", DefaultToSelf = "Component"), Category = "AudioReplicator|Network")
+    static UAudioReplicatorBroadcastWavProxy* BroadcastWavAsync(UAudioReplicatorComponent* Component, const FString& WavPath, int32 Bitrate = 32000, int32 FrameMs = 20);
+
+    virtual void Activate() override;
+
+    // Frames encoded per block handed to the component.
+    static constexpr int32 FramesPerBlock = 50;
+
+private:
+    void HandleLoaded(bool bSuccess, FOpusStreamHeader&& Header, TSharedPtr<FBroadcastWavSource, ESPMode::ThreadSafe> Source);
+    void HandleBlock(FOpusPacketArena&& Packets, int32 FramesDone, bool bLast);
+    void Fail();
+    void Finish();
+
+    TWeakObjectPtr<UAudioReplicatorComponent> Component;
+    FString WavPath;
+    int32 Bitrate = 32000;
+    int32 FrameMs = 20;
+
+    FGuid SessionId;
+    FOpusStreamHeader Header;
+    int32 TotalFrames = 0;
+    bool bFinished = false;
+
+    // Set on the game thread to stop the encode task early.
+    TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> bCancelled = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+};
@@ -3,23 +3,150 @@
 #include "Components/ActorComponent.h"
 #include "OpusTypes.h"
 #include "AudioReplicatorDebugTypes.h"
+#include "AudioReplicatorPacer.h"
+#include "OpusPacketArena.h"
+#include "AudioPcmBuffer.h"
+#include "PcmWavUtils.h"
+#include "PcmResampler.h"
+#include "VoiceActivityDetector.h"
+#include "AudioBitrateController.h"
 #include "AudioReplicatorComponent.generated.h"
 
+class FOpusCodec;
+class FOpusJitterBuffer;
+class FOpusSessionRecorder;
+class USoundWave;
+class USoundWaveProcedural;
+class UNetConnection;
+
+// How chunk payloads travel; start/end control messages are always reliable.
+UENUM(BlueprintType)
+enum class EAudioReplicatorTransport : uint8
+{
+    // Every chunk is a reliable RPC: no loss, but one lost packet stalls everything behind it.
+    Reliable,
+    // Chunks are unreliable RPCs ordered by their index; losses are concealed by the receiver
+    // and, for non-live transfers, optionally re-requested.
+    Unreliable
+};
+
+// Who the server forwards a session to; the originator never gets its own audio back.
+UENUM(BlueprintType)
+enum class EAudioReplicatorRelayMode : uint8
+{
+    // NetMulticast on the owning actor: every connection the actor is relevant to, the sender included.
+    Multicast,
+    // Every player connection except the originator.
+    AllListeners,
+    // Players whose pawn is within RelayRadius of the originator's pawn when the session starts.
+    Proximity,
+    // The players set with SetRelayRecipients (team, squad, ...).
+    Explicit
+};
+
+// What live sessions send while the voice gate (FVoiceActivityDetector) is closed.
+UENUM(BlueprintType)
+enum class EAudioSilenceMode : uint8
+{
+    // Every frame is encoded and sent as is; no gating.
+    SendAll,
+    // Opus DTX: the encoder codes silence as 1-2 byte frames, which are not sent; they keep their chunk
+    // index and receivers play silence for them, so the timeline is kept at almost no cost.
+    Dtx,
+    // Silent frames are not encoded into the stream at all; as with Dtx, they keep their chunk index
+    // and receivers play silence for them.
+    Suppress
+};
+
 // Blueprint delegates for monitoring replicated Opus sessions.
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnOpusTransferStarted, FGuid, SessionId, FOpusStreamHeader, Header);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnOpusChunkReceived, FGuid, SessionId, FOpusChunk, Chunk);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnOpusTransferEnded, FGuid, SessionId);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnOpusBroadcastEncoded, FGuid, SessionId, bool, bSuccess);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnOpusRecordingFinished, FGuid, SessionId, FString, WavPath, bool, bSuccess);
 
 USTRUCT()
 struct FOutgoingTransfer
 {
     GENERATED_BODY()
     FGuid SessionId;
+    uint16 SessionHandle = 0;
     FOpusStreamHeader Header;
-    TArray<FOpusChunk> Chunks;
+    // Encoded frames in one arena; the packet at array index i is chunk ReleasedChunks + i.
+    FOpusPacketArena Packets;
     int32 NextIndex = 0;
     bool bHeaderSent = false;
     bool bEndSent = false;
+
+    // Live sessions: persistent encoder and the PCM tail that does not fill a whole frame yet.
+    // WAV clips: the PCM, encoded straight into Packets once the upload is needed.
+    TSharedPtr<FOpusCodec> Codec;
+    TArray<int16> PendingPcm;
+    int32 FrameSamplesPerCh = 0;
+
+    // Rate of the source PCM; Header.SampleRate is the rate it is encoded at. When they differ, clips
+    // resample PendingPcm while they are encoded and live sessions convert every push with Resampler.
+    int32 SourceSampleRate = 0;
+    TSharedPtr<FPcmResampler> Resampler;
+
+    // Live sessions: speech gate, what to do with the frames it rejects, and how many of them it withheld.
+    FVoiceActivityDetector Vad;
+    EAudioSilenceMode SilenceMode = EAudioSilenceMode::SendAll;
+    int32 FramesSuppressed = 0;
+    TArray<int16> SilentFrame;
+
+    // Live sessions: the current run of silent frames was announced with an empty marker frame, so
+    // the rest of it is not sent (SendChunkBatches).
+    bool bSilenceMarked = false;
+
+    // Live sessions: adaptive bitrate, fed by the latest feedback the server passed on.
+    FAudioBitrateController RateControl;
+    int32 ReportedLossPercent = 0;
+    double LossReportTime = -1.0;
+    double CongestionReportTime = -1.0;
+
+    // Clip offered by content hash; chunks are held back until the server answers.
+    bool bAwaitingCacheReply = false;
+    double OfferTime = 0.0;
+
+    // WAV clips: hash of the source PCM. Once encoded, the hash of the frames is remembered under it,
+    // so the next broadcast of the same file can be offered before it is encoded.
+    FGuid SourceHash;
+
+    // PendingPcm is being encoded on worker threads; the header goes out when it is done.
+    bool bEncoding = false;
+
+    // Clip whose packets are appended while it is being sent (AppendStreamedClipPackets); no end marker until the last one.
+    bool bStreaming = false;
+    bool bServedFromCache = false;
+
+    // Live sessions drop chunks once they are sent; keep their totals for debugging.
+    int32 ReleasedChunks = 0;
+    int32 ReleasedBytes = 0;
+
+    // Finished unreliable transfers stay around for a while to answer retransmission requests.
+    double EndSentTime = 0.0;
+};
+
+// Missing chunk indices of an incoming session, kept as they arrive: sorted, disjoint [X, Y] ranges
+// below the highest index received so far. A late chunk finds its gap by binary search, but splitting
+// or closing it shifts the array, so Add is O(gaps) in the worst case; in-order chunks are O(1).
+struct FChunkGapTracker
+{
+    // Record the first arrival of Index.
+    void Add(int32 Index);
+
+    // Record [First, End) as arrived at once; used for live silence, which usually follows the highest index.
+    void AddRange(int32 First, int32 End);
+
+    int32 GetHighest() const { return Highest; }
+    int32 GetNumMissing() const { return NumMissing; }
+    const TArray<FIntPoint>& GetGaps() const { return Gaps; }
+
+private:
+    TArray<FIntPoint> Gaps;
+    int32 Highest = INDEX_NONE;
+    int32 NumMissing = 0;
 };
 
 USTRUCT()
@@ -29,8 +156,124 @@ struct FIncomingTransfer
     FOpusStreamHeader Header;
     TArray<FOpusPacket> Packets; // Accumulated packets for eventual decoding.
     int32 Received = 0;
+
+    // Memory held in Packets: the payloads plus one FOpusPacket per slot.
+    int64 Bytes = 0;
+
+    // Running debug counters: distinct chunks and their bytes, and the gaps between them.
+    int32 UniqueChunks = 0;
+    int64 UniqueBytes = 0;
+    FChunkGapTracker Gaps;
+
+    // Live sessions trimmed under memory pressure: packets below this index were dropped.
+    int32 FirstRetainedIndex = 0;
+
+    // Live sessions: index of the last silence marker. The frames up to the next one that arrives
+    // were silence the sender did not transmit, not loss.
+    int32 SilentFrom = INDEX_NONE;
+
+    // Live sessions: highest index and distinct chunks at the start of the current loss report window.
+    int32 LossWindowHighest = INDEX_NONE;
+    int32 LossWindowUnique = 0;
+    double LossWindowStart = 0.0;
+
+    // Last time the session received data or was read; finished sessions expire and are evicted by it.
+    mutable double LastUseTime = 0.0;
     bool bStarted = false;
     bool bEnded = false;
+
+    // Live playback: jitter buffer with a long-lived decoder feeding a procedural sound wave.
+    TSharedPtr<FOpusJitterBuffer> Jitter;
+
+    // Set while the session is being recorded to a WAV file (StartRecordingSession).
+    TSharedPtr<FOpusSessionRecorder> Recorder;
+
+    // Clips that ended with frames missing: the recording waits for their retransmission until this
+    // time; 0 when it is not waiting.
+    double RecordingDeadline = 0.0;
+
+    UPROPERTY()
+    TObjectPtr<USoundWaveProcedural> PlaybackWave = nullptr;
+
+    bool bPlaybackFinished = false;
+};
+
+// Listener of a relayed session: its endpoint component and the handle the server assigned for it.
+struct FRelayRecipient
+{
+    TWeakObjectPtr<UAudioReplicatorComponent> Endpoint;
+    uint16 Handle = 0;
+};
+
+// Server, on a listener's endpoint: a catch-up still being sent, frames [NextIndex, EndIndex) of a
+// session relayed by Source, under the handle assigned for this listener.
+struct FRelayCatchUp
+{
+    TWeakObjectPtr<UAudioReplicatorComponent> Source;
+    FGuid SessionId;
+    uint16 Handle = 0;
+    int32 NextIndex = 0;
+    int32 EndIndex = 0;
+};
+
+// Server, on a listener's endpoint: lost frames of a clip relayed by Owner that this player asked for
+// again, Indices[NextIndex] onwards.
+struct FRelayRetransmit
+{
+    TWeakObjectPtr<UAudioReplicatorComponent> Owner;
+    // The source as the request named it; null when the sender is not relevant to the player.
+    TWeakObjectPtr<UAudioReplicatorComponent> Source;
+    FGuid SessionId;
+    TArray<int32> Indices;
+    int32 NextIndex = 0;
+};
+
+// Server-side view of a session relayed by this component.
+USTRUCT()
+struct FRelaySession
+{
+    GENERATED_BODY()
+    FOpusStreamHeader Header;
+    // Non-live sessions keep their chunks so lost ones can be re-sent to clients that ask.
+    TArray<FOpusPacket> Packets;
+
+    // Live sessions keep only the most recent chunks for late joiners; slot = Index % Num.
+    TArray<FOpusChunk> RecentChunks;
+
+    bool bEnded = false;
+    double EndedTime = 0.0;
+
+    // Memory held in Packets or RecentChunks, slots included, and when the last batch came in.
+    int64 Bytes = 0;
+    double LastBatchTime = 0.0;
+    // Live sessions: the last batch ended on a silence marker, so the sender may stay quiet for long.
+    bool bSilent = false;
+    // Clips: frames stopped being kept because the store was full; set to warn once.
+    bool bStoreFull = false;
+
+    // Fixed when the session starts; empty in Multicast mode unless the clip was served from the cache.
+    TArray<FRelayRecipient> Recipients;
+
+    int32 BatchesRelayed = 0;
+    int64 BytesReceived = 0;
+    int64 BytesRelayed = 0;
+
+    // Live sessions: when the originator was last told that a recipient connection is saturated.
+    double CongestionReportTime = -1.0;
+
+    // The complete clip is (or was) in the server clip cache.
+    bool bInClipCache = false;
+
+    // Started from the cache by Server_OfferClip; an upload that follows a late offer reply is ignored.
+    bool bServedFromCache = false;
+};
+
+// Client side of a relayed session: which session a server-assigned handle belongs to and
+// which component keeps it (the source component if it is relevant here, else the endpoint).
+struct FRelayBinding
+{
+    FGuid SessionId;
+    TWeakObjectPtr<UAudioReplicatorComponent> Target;
 };
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
@@ -40,10 +283,161 @@ class AUDIOREPLICATOR_API UAudioReplicatorComponent : public UActorComponent
 public:
     UAudioReplicatorComponent();
 
-    // Maximum amount of chunks to send per tick to avoid network spam.
+    // Maximum amount of chunks per retransmission RPC; regular sending is paced by MaxSendBytesPerSec.
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net")
     int32 MaxPacketsPerTick = 32;
 
+    // Byte rate budget for chunks sent over this component's connection, shared by all outgoing sessions
+    // of every component on that connection; give those components the same settings. Zero disables pacing.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "0"))
+    int32 MaxSendBytesPerSec = 32000;
+
+    // How many bytes may go out at once after the connection was idle.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "64"))
+    int32 MaxBurstBytes = 4096;
+
+    // Send live voice as soon as a frame is encoded, ahead of bulk clip transfers.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net")
+    bool bPrioritizeLiveSessions = true;
+
+    // Server: who receives the sessions of this component. The recipient set is fixed when a session starts.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay")
+    EAudioReplicatorRelayMode RelayMode = EAudioReplicatorRelayMode::AllListeners;
+
+    // Proximity mode: maximum distance between the speaker and a listener, in unreal units.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay", meta = (ClampMin = "0"))
+    float RelayRadius = 3000.0f;
+
+    // Server: how much recent audio of a live session a late joiner gets in its catch-up burst.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay", meta = (ClampMin = "0"))
+    int32 LiveCatchUpMs = 200;
+
+    // Server: how long finished clips stay available for late joiners and RequestSessionReplay, in seconds.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay", meta = (ClampMin = "0"))
+    float ClipReplayRetentionSec = 30.0f;
+
+    // Server: sessions this component relays at once, and the memory their frames may take. Finished
+    // sessions are dropped oldest first to make room; a start that still does not fit is refused.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay", meta = (ClampMin = "1"))
+    int32 MaxRelaySessions = 8;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay", meta = (ClampMin = "0"))
+    int64 MaxRelayBytes = 32 * 1024 * 1024;
+
+    // Server: a session whose end message never comes is dropped after this many seconds without frames.
+    // A live session that went silent waits for the session limit instead. 0 keeps them.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay", meta = (ClampMin = "0"))
+    float RelaySessionIdleSec = 30.0f;
+
+    // Ask the server for a catch-up burst when chunks of an unknown session keep arriving.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Relay")
+    bool bRequestCatchUp = true;
+
+    // Offer clips to the server by content hash first and skip the upload if it already has them.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Cache")
+    bool bUseClipCache = true;
+
+    // Encoder setup for WAV clips (StartBroadcastFromWav, BroadcastWavAsync); carried in their header.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Source")
+    EOpusEncoderProfile ClipEncoderProfile = EOpusEncoderProfile::MusicClip;
+
+    // Encoder setup for live sessions opened with OpenStreamSession.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Source")
+    EOpusEncoderProfile LiveEncoderProfile = EOpusEncoderProfile::Voice;
+
+    // How WAV files with more than two channels (or any, for Mono) are reduced before encoding.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Source")
+    EAudioWavDownmix WavDownmix = EAudioWavDownmix::Stereo;
+
+    // TPDF dither when 24-bit, 32-bit and float WAV files are reduced to 16 bits.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Source")
+    bool bDitherWavSources = true;
+
+    // Filter used when a WAV file or live session runs at a rate Opus cannot encode (44.1 kHz, ...)
+    // and is converted to AUDIO_REPL_OPUS_SR.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Source")
+    EAudioResampleQuality ResampleQuality = EAudioResampleQuality::Balanced;
+
+    // Load options for WAV broadcasts, from WavDownmix and bDitherWavSources.
+    PcmWav::FWavLoadOptions GetWavLoadOptions() const;
+
+    // Byte budget of one chunk batch RPC; consecutive frames are packed until the next one would exceed it.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "64", ClampMax = "65535"))
+    int32 MaxBatchBytes = 1024;
+
+    // Transport for chunk payloads sent by this component.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net")
+    EAudioReplicatorTransport Transport = EAudioReplicatorTransport::Reliable;
+
+    // Unreliable transport only: re-request chunks of non-live transfers that were lost on the way.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net")
+    bool bRetransmitLostChunks = true;
+
+    // How long finished transfers stay available for retransmission, in seconds.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "0"))
+    float RetransmitWindowSec = 5.0f;
+
+    // Expected packet loss for live sessions; values above zero enable Opus in-band FEC so receivers
+    // can rebuild a lost frame from the packet that follows it.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "0", ClampMax = "100"))
+    int32 ExpectedPacketLossPercent = 0;
+
+    // Live sessions adapt their bitrate and expected loss to the send queue, connection saturation and
+    // receiver loss reports, between MinAdaptiveBitrate and the bitrate the session was opened with.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net")
+    bool bAdaptiveBitrate = true;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "6000"))
+    int32 MinAdaptiveBitrate = 8000;
+
+    // Upper bound for the expected loss (and so the FEC overhead) set from receiver reports; the lower
+    // bound is ExpectedPacketLossPercent.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "0", ClampMax = "100"))
+    int32 MaxAdaptiveLossPercent = 25;
+
+    // Gain applied to PCM pushed into live sessions before encoding, e.g. the user's mic volume.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Net", meta = (ClampMin = "0.0", ClampMax = "4.0"))
+    float InputGain = 1.0f;
+
+    // Live sessions: how frames below the voice gate are sent. Applies to sessions opened afterwards.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Voice")
+    EAudioSilenceMode SilenceMode = EAudioSilenceMode::Dtx;
+
+    // RMS level in [0, 1] a frame must reach to open the voice gate, e.g. the user's mic threshold;
+    // 0 leaves the decision to the Opus VAD alone.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Voice", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float VoiceActivityThreshold = 0.0f;
+
+    // How long the gate stays open after the last frame of speech.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Voice", meta = (ClampMin = "0"))
+    int32 VoiceHangoverMs = 300;
+
+    // Decode incoming sessions while they arrive and feed a procedural sound wave for playback.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Playback")
+    bool bEnableLivePlayback = false;
+
+    // Adaptive jitter buffer bounds; the target depth moves between these values. Live sessions drop
+    // their oldest frames past the maximum, clips never do.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Playback", meta = (ClampMin = "20"))
+    int32 JitterMinDepthMs = 40;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Playback", meta = (ClampMin = "20"))
+    int32 JitterMaxDepthMs = 120;
+
+    // Memory cap for the packets of all incoming sessions. Finished sessions are evicted least recently
+    // used first; if that is not enough, the oldest packets of running live sessions are dropped.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Receive", meta = (ClampMin = "0"))
+    int64 MaxIncomingBytes = 8 * 1024 * 1024;
+
+    // Finished incoming sessions are dropped after this many seconds without being read, and sessions whose
+    // end never came after as long without data; 0 keeps them until MaxIncomingBytes or ReleaseIncomingSession removes them.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Receive", meta = (ClampMin = "0"))
+    float IncomingSessionTtlSec = 120.0f;
+
+    // How often receivers report the loss they see on live sessions back to the sender; 0 disables the reports.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Receive", meta = (ClampMin = "0"))
+    float LossReportIntervalSec = 1.0f;
+
     // Multicast events exposed to gameplay code.
     UPROPERTY(BlueprintAssignable, Category = "AudioReplicator|Net")
     FOnOpusTransferStarted OnTransferStarted;
@@ -54,53 +448,214 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "AudioReplicator|Net")
     FOnOpusTransferEnded OnTransferEnded;
 
+    // Owning client: a clip started from PCM (StartBroadcastFromWav) finished encoding in the background.
+    // On failure the session is dropped.
+    UPROPERTY(BlueprintAssignable, Category = "AudioReplicator|Net")
+    FOnOpusBroadcastEncoded OnBroadcastEncoded;
+
+    // A recording started with StartRecordingSession was closed: at the session end (for a clip missing frames,
+    // once they were retransmitted or RetransmitWindowSec passed) or by StopRecordingSession.
+    UPROPERTY(BlueprintAssignable, Category = "AudioReplicator|Net")
+    FOnOpusRecordingFinished OnRecordingFinished;
+
     // == Blueprint API: transfer lifecycle ==
     // 1) Broadcast already encoded Opus packets (client-side call).
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
     bool StartBroadcastOpus(const TArray<FOpusPacket>& Packets, FOpusStreamHeader Header, FGuid& OutSessionId);
 
-    // 2) Broadcast from a WAV file (encode locally, then stream).
+    // 2) Broadcast from a WAV file. The clip is encoded on worker threads (see OnBroadcastEncoded), then streamed.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
     bool StartBroadcastFromWav(const FString& WavPath, int32 Bitrate, int32 FrameMs, FGuid& OutSessionId);
 
+    // 3) Live streaming: open a session, push PCM as it is captured, close when done.
+    // Every complete frame is encoded with a persistent codec and sent right away.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
+    bool OpenStreamSession(int32 SampleRate, int32 Channels, int32 Bitrate, int32 FrameMs, FGuid& OutSessionId);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
+    bool PushStreamPcm(const FGuid& SessionId, const TArray<int32>& Pcm16);
+
+    // Same as PushStreamPcm without the int32 round trip; the buffer format must match the session.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
+    bool PushStreamPcmBuffer(const FGuid& SessionId, const UAudioPcmBuffer* Buffer);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
+    void CloseStreamSession(const FGuid& SessionId);
+
+    // Native variant for capture callbacks that already hold interleaved int16 samples (game thread only).
+    bool PushStreamPcm16(const FGuid& SessionId, TArrayView<const int16> Pcm16);
+
+    // Native: a clip whose packets are produced while it is being sent (e.g. encoded in the background).
+    // The header goes out (or is offered to the server cache) right away with NumPackets unknown;
+    // appended packets are paced like any clip, and the end marker follows the last block.
+    enum class EStreamedClipAppend : uint8
+    {
+        Queued,
+        ServedFromCache, // the server already had the clip; stop producing packets
+        Gone             // cancelled or unknown session
+    };
+    bool BeginStreamedClip(const FOpusStreamHeader& Header, FGuid& OutSessionId);
+    EStreamedClipAppend AppendStreamedClipPackets(const FGuid& SessionId, const FOpusPacketArena& Packets, bool bLast);
+
+    // MD5 of the stream parameters and the clip content, stored in a guid for FOpusStreamHeader::ContentHash.
+    static FGuid MakeContentHash(const FOpusStreamHeader& Header, TArrayView<const uint8> Content);
+
+    // MakeContentHash of the packets in the Chunking::PackWithLengths format, the key the server cache uses.
+    static FGuid MakeContentHash(const FOpusStreamHeader& Header, const FOpusPacketArena& Packets);
+
+    // True on the client that owns this component, where broadcasts can be started.
+    bool IsOwnerClient() const;
+
     // Abort an active transfer early if required.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
     void CancelBroadcast(const FGuid& SessionId);
 
-    // Access the received data for a session (e.g., to decode and save a WAV).
+    // Access the received data for a session (e.g., to decode and save a WAV). Copies the packets;
+    // native code should use GetReceivedPacketsView.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
     bool GetReceivedPackets(const FGuid& SessionId, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader) const;
 
+    // Native: the received packets without a copy. The view is valid until the next chunk of the
+    // session arrives or the session is released, so do not keep it across frames.
+    bool GetReceivedPacketsView(const FGuid& SessionId, TArrayView<const FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader) const;
+
+    // Drop an incoming session once its packets are no longer needed; playback and recording stop.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Net")
+    bool ReleaseIncomingSession(const FGuid& SessionId);
+
+    // Sessions and bytes held for incoming transfers, and what the store dropped so far.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    void GetIncomingStoreStats(FAudioReplicatorIncomingStoreStats& OutStats) const;
+
+    // Procedural wave fed by live playback of a session; valid from OnTransferStarted when bEnableLivePlayback is set.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Playback")
+    USoundWave* GetIncomingPlaybackWave(const FGuid& SessionId) const;
+
+    // Decode an incoming session to a WAV file as its chunks arrive; the file is finalized when the session ends.
+    // Chunks already received are written first, so a clip can also be recorded after it started.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Playback")
+    bool StartRecordingSession(const FGuid& SessionId, const FString& WavPath);
+
+    // Close the recording early; what was written so far stays a valid WAV file.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Playback")
+    bool StopRecordingSession(const FGuid& SessionId);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    bool GetIncomingJitterStats(const FGuid& SessionId, FAudioReplicatorJitterStats& OutStats) const;
+
     // Debug helpers that expose the current state of transfers without having to gather data manually.
+    // The summary comes from running counters and is cheap enough to poll every frame; the per-chunk
+    // arrays (Chunks, PendingChunkIndices, MissingChunkIndices) cost O(chunks) and are only filled
+    // with bIncludeChunks.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    bool GetOutgoingDebugInfo(const FGuid& SessionId, FAudioReplicatorOutgoingDebug& OutDebug, bool bIncludeChunks = false) const;
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    bool GetIncomingDebugInfo(const FGuid& SessionId, FAudioReplicatorIncomingDebug& OutDebug, bool bIncludeChunks = false) const;
+
+    // Explicit mode: players that receive the next sessions of this component. Any actor owned by
+    // the player's connection works (controller, pawn, player state).
+    UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "AudioReplicator|Relay")
+    void SetRelayRecipients(const TArray<AActor*>& Recipients);
+
+    // Server: recipients and traffic of a session relayed for this component.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
-    bool GetOutgoingDebugInfo(const FGuid& SessionId, FAudioReplicatorOutgoingDebug& OutDebug) const;
+    bool GetRelayStats(const FGuid& SessionId, FAudioReplicatorRelayStats& OutStats) const;
+
+    // Ask the server to send a session of this component again from its start, e.g. a finished clip
+    // this player joined too late for. Live sessions restart from their most recent audio.
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Relay")
+    void RequestSessionReplay(const FGuid& SessionId);
 
+    // Server: true if this component relays the given session.
+    bool IsRelaying(const FGuid& SessionId) const { return ServerSessions.Contains(SessionId); }
+
+    // Budget, achieved rate and queue depth of the send pacer.
     UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
-    bool GetIncomingDebugInfo(const FGuid& SessionId, FAudioReplicatorIncomingDebug& OutDebug) const;
+    void GetSendStats(FAudioReplicatorSendStats& OutStats) const;
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
     // === SERVER RPC ===
+    // SessionHandle is the compact id that chunk batches of this session carry instead of the guid.
+    UFUNCTION(Server, Reliable)
+    void Server_StartTransfer(const FGuid& SessionId, uint16 SessionHandle, const FOpusStreamHeader& Header);
+
+    // Clip broadcast by content hash: the server either plays it from its cache or asks for the upload.
+    UFUNCTION(Server, Reliable)
+    void Server_OfferClip(const FGuid& SessionId, uint16 SessionHandle, const FOpusStreamHeader& Header);
+
     UFUNCTION(Server, Reliable)
-    void Server_StartTransfer(const FGuid& SessionId, const FOpusStreamHeader& Header);
+    void Server_SendChunkBatch(const FOpusChunkBatch& Batch);
+
+    UFUNCTION(Server, Unreliable)
+    void Server_SendChunkBatchUnreliable(const FOpusChunkBatch& Batch);
 
+    // NumPackets is the final chunk count, which live sessions only know once they are closed.
     UFUNCTION(Server, Reliable)
-    void Server_SendChunk(const FGuid& SessionId, const FOpusChunk& Chunk);
+    void Server_EndTransfer(const FGuid& SessionId, int32 NumPackets);
 
+    // Sent through the caller's own endpoint: ask for the header and buffered chunks of a session
+    // relayed by Source, identified by its id or, if the id is unknown, by the sender's handle.
     UFUNCTION(Server, Reliable)
-    void Server_EndTransfer(const FGuid& SessionId);
+    void Server_RequestCatchUp(UAudioReplicatorComponent* Source, const FGuid& SessionId, uint16 SourceHandle);
+
+    // Sent through the caller's own endpoint: ask for chunks of a session relayed by Source.
+    UFUNCTION(Server, Reliable)
+    void Server_RequestChunks(UAudioReplicatorComponent* Source, const FGuid& SessionId, const TArray<int32>& Indices);
+
+    // Sent through the caller's own endpoint: loss seen on a live session of Source, passed on to its owner.
+    UFUNCTION(Server, Unreliable)
+    void Server_ReportLoss(UAudioReplicatorComponent* Source, const FGuid& SessionId, int32 LossPercent);
+
+    // === CLIENT RPC ===
+    // Server -> owning client: feedback for a live session; LossPercent is INDEX_NONE when only
+    // congestion of a recipient connection is reported.
+    UFUNCTION(Client, Unreliable)
+    void Client_ReportNetworkFeedback(const FGuid& SessionId, int32 LossPercent, bool bCongested);
+
+    // Server -> owning client: chunks that never reached the server, re-sent reliably.
+    UFUNCTION(Client, Reliable)
+    void Client_ResendChunks(const FGuid& SessionId, const TArray<int32>& Indices);
+
+    // Server -> owning client: whether an offered clip was served from the cache.
+    UFUNCTION(Client, Reliable)
+    void Client_ClipOfferResult(const FGuid& SessionId, bool bCached);
+
+    // Server -> requesting endpoint: retransmitted chunks of a session relayed by Source.
+    UFUNCTION(Client, Reliable)
+    void Client_ReceiveChunks(UAudioReplicatorComponent* Source, const FGuid& SessionId, const TArray<FOpusChunk>& Chunks);
+
+    // Server -> recipient endpoint: a session of Source relayed to this player only.
+    // Handle is assigned by the server per recipient, so it stays unique even when Source is not relevant here.
+    // SourceHandle is non-zero for catch-ups of multicast sessions: it binds the sender's own handle too.
+    UFUNCTION(Client, Reliable)
+    void Client_RelayStartTransfer(UAudioReplicatorComponent* Source, const FGuid& SessionId, uint16 Handle, uint16 SourceHandle, const FOpusStreamHeader& Header);
+
+    UFUNCTION(Client, Reliable)
+    void Client_RelayChunkBatch(const FOpusChunkBatch& Batch);
+
+    UFUNCTION(Client, Unreliable)
+    void Client_RelayChunkBatchUnreliable(const FOpusChunkBatch& Batch);
+
+    UFUNCTION(Client, Reliable)
+    void Client_RelayEndTransfer(const FGuid& SessionId, uint16 Handle, int32 NumPackets);
 
     // === MULTICAST RPC ===
     UFUNCTION(NetMulticast, Reliable)
-    void Multicast_StartTransfer(const FGuid& SessionId, const FOpusStreamHeader& Header);
+    void Multicast_StartTransfer(const FGuid& SessionId, uint16 SessionHandle, const FOpusStreamHeader& Header);
 
     UFUNCTION(NetMulticast, Reliable)
-    void Multicast_SendChunk(const FGuid& SessionId, const FOpusChunk& Chunk);
+    void Multicast_SendChunkBatch(const FOpusChunkBatch& Batch);
+
+    UFUNCTION(NetMulticast, Unreliable)
+    void Multicast_SendChunkBatchUnreliable(const FOpusChunkBatch& Batch);
 
     UFUNCTION(NetMulticast, Reliable)
-    void Multicast_EndTransfer(const FGuid& SessionId);
+    void Multicast_EndTransfer(const FGuid& SessionId, int32 NumPackets);
 
     virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
@@ -109,15 +664,219 @@ private:
     UPROPERTY()
     TMap<FGuid, FOutgoingTransfer> Outgoing;
 
+    // Client side: source PCM hash -> hash of the frames it was encoded to (FOutgoingTransfer::SourceHash).
+    TMap<FGuid, FGuid> KnownContentHashes;
+
     // Incoming transfers assembled on this instance.
     UPROPERTY()
     TMap<FGuid, FIncomingTransfer> Incoming;
 
-    // Helper: convert packets into indexed chunks for replication.
-    static void BuildChunks(const TArray<FOpusPacket>& Packets, TArray<FOpusChunk>& OutChunks);
+    // Incoming sessions expired, evicted or released lately; their start is not accepted again.
+    TSet<FGuid> ClosedIncoming;
+
+    // Sessions relayed by the server on behalf of the owning client.
+    UPROPERTY()
+    TMap<FGuid, FRelaySession> ServerSessions;
 
-    // Helper: encode a WAV file into Opus packets on the client.
-    bool EncodeWavToOpusPackets(const FString& WavPath, int32 Bitrate, int32 FrameMs, TArray<FOpusPacket>& OutPackets, FOpusStreamHeader& OutHeader) const;
+    // Compact session handles of this component's connection, as announced by the start messages.
+    TMap<uint16, FGuid> SessionHandles;
 
-    bool IsOwnerClient() const;
+    // Batches whose start message has not arrived yet (unreliable batches can overtake it).
+    TArray<FOpusChunkBatch> UnresolvedBatches;
+
+    // Last handle handed out by this client; 0 is never used.
+    uint16 LastSessionHandle = 0;
+
+    // Explicit relay mode recipients.
+    TArray<TWeakObjectPtr<AActor>> RelayRecipientActors;
+
+    // Endpoint only: sessions relayed to this player, by server-assigned handle.
+    TMap<uint16, FRelayBinding> RelayBindings;
+
+    // Relayed batches whose start message has not arrived yet.
+    TArray<FOpusChunkBatch> UnresolvedRelayBatches;
+
+    // Server, endpoint only: last handle assigned for sessions relayed to this player.
+    uint16 LastRelayHandle = 0;
+
+    // When chunks of each unknown sender handle were first parked, and the handles already asked about.
+    TMap<uint16, double> UnresolvedSince;
+    TSet<uint16> CatchUpRequested;
+
+    // Server, endpoint only: catch-ups to this player, drained through its connection's pacer.
+    TArray<FRelayCatchUp> PendingCatchUps;
+
+    // Server, endpoint only: retransmissions to this player, drained through the same pacer.
+    TArray<FRelayRetransmit> PendingRetransmits;
+
+    // Server: next time the recipient sets of running sessions are re-evaluated.
+    double NextRecipientRefreshTime = 0.0;
+
+    // Only used outside a world with the subsystem; otherwise the connection's pacer in the subsystem is.
+    FAudioReplicatorPacer Pacer;
+
+    // Rotates which session is served first so partial rounds even out over time.
+    int32 RoundRobinOffset = 0;
+
+    // Server: memory of all ServerSessions, see FRelaySession::Bytes.
+    int64 RelayBytes = 0;
+
+    // Payload bytes of all Incoming sessions, and what the store dropped to stay under MaxIncomingBytes.
+    int64 IncomingBytes = 0;
+    int32 IncomingExpired = 0;
+    int32 IncomingEvictions = 0;
+    int32 IncomingLiveChunksTrimmed = 0;
+
+    // Helper: create the jitter buffer and playback wave for an incoming session.
+    void StartLivePlayback(FIncomingTransfer& In);
+
+    // Helper: close the session's recording and fire OnRecordingFinished.
+    bool FinishRecording(const FGuid& SessionId, FIncomingTransfer& In, int32 NumPackets);
+
+    // Helper: move decoded frames from the jitter buffers into the playback waves.
+    void PumpLivePlayback(float DeltaTime);
+
+    // Helper: register a clip transfer and either offer it to the server cache or start it right away.
+    bool BeginOutgoingClip(FOutgoingTransfer&& Tr);
+
+    // Helper: start the regular upload; a clip still held as PCM is encoded on worker threads first.
+    bool FinishClipOffer(FOutgoingTransfer& Tr);
+
+    // Helper: game-thread completion of the background clip encode.
+    void HandleClipEncoded(const FGuid& SessionId, bool bSuccess, FOpusPacketArena&& Packets);
+
+    // Helper: client-side, silence markers of a live session; true if the chunk was one and is handled.
+    bool HandleLiveSilence(FIncomingTransfer& In, int32 Index, bool bMarker);
+
+    // Helper: client-side, key an encoded WAV clip by its frames and remember that key for its source PCM.
+    void RememberContentHash(FOutgoingTransfer& Tr);
+
+    // Helper: put a complete non-live session into the server clip cache.
+    void TryCacheClip(FRelaySession& Session);
+
+    // Helper: index range of the frames a relayed session keeps for catch-ups.
+    static void GetBufferedRange(const FRelaySession& Session, int32& OutFirst, int32& OutEnd);
+
+    // Helper: next batch of consecutive buffered frames in [Cursor, EndIndex), at most Budget bytes; advances Cursor.
+    static bool NextBufferedBatch(const FRelaySession& Session, uint16 Handle, int32 Budget, int32 EndIndex, int32& Cursor, FOpusChunkBatch& OutBatch);
+
+    // Helper: server-side, on an endpoint: send pending catch-ups and retransmissions as the player's
+    // connection budget allows.
+    void PumpCatchUps(double Now);
+
+    // Helper: a catch-up of the session to this endpoint's player is still being sent.
+    bool HasPendingCatchUp(const FGuid& SessionId) const;
+
+    // Helper: encode one frame of a live session through its voice gate; false if the encoder failed.
+    bool EncodeLiveFrame(FOutgoingTransfer& Tr, const int16* FramePcm);
+
+    // Helper: what the bitrate controller of a live session sees now.
+    FAudioBitrateController::FConditions GetSendConditions(const FOutgoingTransfer& Tr, double Now) const;
+
+    // Helper: client-side, report the loss of each live incoming session once per LossReportIntervalSec.
+    void ReportReceiveLoss(double Now);
+
+    // Helper: the connection has more queued than it may send right now.
+    static bool IsConnectionSaturated(UNetConnection* Connection);
+
+    // Helper: server-side, tell the originator of a live session when a connection it is relayed to is saturated.
+    void ReportRelayCongestion(const FGuid& SessionId, FRelaySession& Session);
+
+    // Helper: send every queued chunk of a live session, bypassing the pacer budget, and release the sent payloads.
+    void FlushLiveTransfer(FOutgoingTransfer& Tr);
+
+    // Helper: token bucket of this component's connection, shared by every component sending over it.
+    FAudioReplicatorPacer& GetPacer();
+    const FAudioReplicatorPacer& GetPacer() const;
+
+    // Helper: drop the payloads of live chunks that are already sent.
+    static void ReleaseSentLiveChunks(FOutgoingTransfer& Tr);
+
+    // Helper: share the pacer budget between outgoing sessions and send end markers of finished ones.
+    void PumpOutgoing(double Now);
+
+    // Helper: allocate the compact handle for a new outgoing session.
+    uint16 AllocateSessionHandle();
+
+    // Helper: pack up to MaxChunks chunks starting at Tr.Chunks[FirstArrayIndex] into at most MaxBatches
+    // budget-sized batches (INDEX_NONE for no limit) and send them to the server; returns the number of chunks sent.
+    int32 SendChunkBatches(FOutgoingTransfer& Tr, int32 FirstArrayIndex, int32 MaxChunks, int32 MaxBatches, bool bReliable);
+
+    // Helper: server-side bookkeeping shared by the reliable and unreliable batch RPCs.
+    void RelayChunkBatch(const FOpusChunkBatch& Batch, bool bReliable);
+
+    // Helper: server-side recipient endpoints for a new session, originator excluded.
+    void GatherRelayRecipients(TArray<UAudioReplicatorComponent*>& OutEndpoints) const;
+
+    // Helper: true if a session of this component may be sent to Endpoint's player: one it is already
+    // relayed to, or one GatherRelayRecipients picks now. Never the originator.
+    bool IsRelayListener(const FRelaySession& Session, const UAudioReplicatorComponent* Endpoint) const;
+
+    // Helper: allocate the handle of a session relayed to this endpoint's player.
+    uint16 AllocateRelayHandle();
+
+    // Helper: store the frames of a relayed batch for retransmission or catch-up; false if the batch is
+    // malformed or its indices fall outside the session. Clip frames past MaxRelayBytes are not kept.
+    bool StoreRelayedFrames(FRelaySession& Session, const FOpusChunkBatch& Batch);
+
+    // Helper: grow a relayed clip's packet slots to Num and count them in RelayBytes.
+    void GrowRelayPackets(FRelaySession& Session, int32 Num);
+
+    // Helper: drop finished relayed sessions, oldest first, until one more session of Bytes fits the caps.
+    bool MakeRelayRoom(int64 Bytes);
+
+    // Helper: remove a relayed session and its bytes.
+    void RemoveRelaySession(const FGuid& SessionId);
+
+    // Helper: send the header of a session to one endpoint and queue its buffered chunks and, if finished,
+    // the end marker there. Returns the relay handle assigned for that endpoint.
+    uint16 SendCatchUp(UAudioReplicatorComponent* Endpoint, const FGuid& SessionId, FRelaySession& Session, uint16 SourceHandle);
+
+    // Helper: server-side, give players that joined or became eligible mid-session a catch-up.
+    void RefreshRelayRecipients(double Now);
+
+    // Helper: client-side, ask for catch-ups of sessions whose start message never arrived.
+    void RequestCatchUps(double Now);
+
+    // Helper: bind a sender handle to its session and deliver the batches parked for it.
+    void ResolveParkedBatches(uint16 SessionHandle, const FGuid& SessionId);
+
+    // Helper: set up an incoming session and notify listeners (multicast and relay paths).
+    void HandleStartTransfer(const FGuid& SessionId, const FOpusStreamHeader& Header);
+
+    // Helper: finish an incoming session and ask for lost chunks (multicast and relay paths).
+    void HandleEndTransfer(const FGuid& SessionId, int32 NumPackets);
+
+    // Helper: resolve a multicast batch by the sender's handle; unknown handles are parked.
+    void HandleIncomingBatch(const FOpusChunkBatch& Batch);
+
+    // Helper: resolve a relayed batch by the server-assigned handle; unknown handles are parked.
+    void HandleRelayedBatch(const FOpusChunkBatch& Batch);
+
+    // Helper: hand every frame of a resolved batch to HandleIncomingChunk.
+    void DeliverBatch(const FGuid& SessionId, const FOpusChunkBatch& Batch);
+
+    // Helper: keep a batch until its start message arrives; the oldest one goes when the list is full.
+    static void ParkBatch(TArray<FOpusChunkBatch>& Parked, const FOpusChunkBatch& Batch);
+
+    // Helper: store a received chunk and notify listeners.
+    void HandleIncomingChunk(const FGuid& SessionId, const FOpusChunk& Chunk);
+
+    // Helper: ask the server, through the local endpoint, for chunks missing from a finished transfer.
+    void RequestMissingChunks(const FGuid& SessionId, const FIncomingTransfer& In);
+
+    // Helper: drop finished transfers whose retransmission window expired.
+    void ExpireFinishedTransfers(double Now);
+
+    // Helper: apply IncomingSessionTtlSec and MaxIncomingBytes to the incoming sessions.
+    void TrimIncomingSessions(double Now);
+
+    // Helper: remove an incoming session and its bytes from the store.
+    void RemoveIncoming(const FGuid& SessionId);
+
+    // Helper: grow an incoming session's packet slots to Num and count them in the store.
+    void GrowIncomingPackets(FIncomingTransfer& In, int32 Num);
+
+    // Helper: drop the compact handles bound to a session that is gone.
+    void ForgetSessionHandles(const FGuid& SessionId);
 };
@@ -73,6 +73,21 @@ struct FAudioReplicatorOutgoingDebug
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
     bool bTransferComplete = false;
 
+    // Live sessions: frames the voice gate withheld, coded as DTX or replaced by empty frames per the silence mode.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 FramesSuppressed = 0;
+
+    // Live sessions: bitrate and expected loss the adaptive controller currently applies, and how often it backed off.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 CurrentBitrate = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 CurrentLossPercent = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 BitrateDecreases = 0;
+
+    // Only filled when the detail is requested; pending chunks are always NextChunkIndex..TotalChunks-1.
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
     TArray<int32> PendingChunkIndices;
 
@@ -124,6 +139,15 @@ struct FAudioReplicatorIncomingDebug
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
     bool bReadyToAssemble = false;
 
+    // Missing chunks as inclusive index ranges (X = first, Y = last). All of them when the detail is
+    // requested, otherwise only the oldest few; MissingRangeCount is the full number.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    TArray<FIntPoint> MissingRanges;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 MissingRangeCount = 0;
+
+    // Only filled when the detail is requested.
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
     TArray<int32> MissingChunkIndices;
 
@@ -131,3 +155,170 @@ struct FAudioReplicatorIncomingDebug
     TArray<FAudioReplicatorChunkDebug> Chunks;
 };
 
+/**
+ * Playout statistics of the jitter buffer that feeds live playback of an incoming session.
+ */
+USTRUCT(BlueprintType)
+struct FAudioReplicatorJitterStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    FGuid SessionId;
+
+    // Times playback ran dry and had to re-buffer.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Underruns = 0;
+
+    // Frames skipped because the buffer grew past its maximum depth.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Overruns = 0;
+
+    // Packets that arrived after their frame was already played.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 LateDrops = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 FramesDecoded = 0;
+
+    // Missing frames synthesized by packet loss concealment.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 FramesConcealed = 0;
+
+    // Missing frames rebuilt from the in-band FEC data of the following packet.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 FramesRecoveredFec = 0;
+
+    // Frames the sender did not transmit because its speaker was silent, played as silence.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 FramesSilent = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 TargetDepthMs = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 CurrentDepthMs = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    bool bPlaybackFinished = false;
+};
+
+/**
+ * State of the token-bucket pacer that spaces out chunks sent by a component.
+ */
+USTRUCT(BlueprintType)
+struct FAudioReplicatorSendStats
+{
+    GENERATED_BODY()
+
+    // Configured budget; zero when pacing is disabled.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    float BudgetKbps = 0.0f;
+
+    // Rate actually sent over the last second, retransmissions included.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    float SendRateKbps = 0.0f;
+
+    // Current token balance; negative while priority traffic is paid back.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 AvailableBytes = 0;
+
+    // Sessions that still have chunks waiting to be sent.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 ActiveSessions = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 QueuedChunks = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 QueuedBytes = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int64 TotalBytesSent = 0;
+};
+
+/**
+ * Server-side traffic of a session relayed for one component.
+ */
+USTRUCT(BlueprintType)
+struct FAudioReplicatorRelayStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    FGuid SessionId;
+
+    // Listeners the session is forwarded to; for Multicast mode the number of client connections.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Recipients = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 BatchesRelayed = 0;
+
+    // Chunk payload received from the originator.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int64 BytesReceived = 0;
+
+    // Chunk payload sent to all recipients together, retransmissions included.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int64 BytesRelayed = 0;
+};
+
+/**
+ * Counters of the server-side clip cache.
+ */
+USTRUCT(BlueprintType)
+struct FAudioReplicatorClipCacheStats
+{
+    GENERATED_BODY()
+
+    // Broadcasts whose upload was skipped because the server already had the clip.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Hits = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Misses = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Evictions = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 NumClips = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int64 Bytes = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int64 MaxBytes = 0;
+};
+
+/**
+ * Memory held by the incoming sessions of a component.
+ */
+USTRUCT(BlueprintType)
+struct FAudioReplicatorIncomingStoreStats
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 NumSessions = 0;
+
+    // Packet payload stored for all incoming sessions, plus their packet slots.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int64 Bytes = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int64 MaxBytes = 0;
+
+    // Sessions dropped by IncomingSessionTtlSec: finished ones not read, or ones whose end never came.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Expired = 0;
+
+    // Finished sessions dropped, least recently used first, to stay under MaxIncomingBytes.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 Evictions = 0;
+
+    // Payloads of running live sessions dropped, oldest first, when no finished session was left to evict.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator|Debug")
+    int32 LiveChunksTrimmed = 0;
+};
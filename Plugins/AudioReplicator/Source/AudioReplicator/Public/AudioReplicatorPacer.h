@@ -0,0 +1,40 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Token bucket that paces the chunk traffic of one connection by wall-clock time.
+ *
+ * Tokens are bytes. They refill at the configured rate up to the burst size; sending is allowed
+ * while the balance is positive and a send may overdraw it, which later sends pay back. The debt
+ * is capped at one burst so priority traffic cannot starve everything else for long.
+ * The pacer also measures the rate actually achieved over roughly one second windows.
+ */
+class AUDIOREPLICATOR_API FAudioReplicatorPacer
+{
+public:
+    // BytesPerSec <= 0 disables pacing.
+    void Configure(int32 InBytesPerSec, int32 InBurstBytes);
+
+    // Add the tokens earned since the previous call and roll the rate window.
+    void Refill(double Now);
+
+    bool CanSend() const { return BytesPerSec <= 0 || Tokens > 0.0; }
+
+    void Consume(int32 Bytes);
+
+    int32 GetBudgetBytesPerSec() const { return BytesPerSec; }
+    int32 GetAvailableBytes() const { return FMath::FloorToInt32(Tokens); }
+    float GetSendRateBytesPerSec() const { return SendRateBytesPerSec; }
+    int64 GetTotalBytesSent() const { return TotalBytesSent; }
+
+private:
+    int32 BytesPerSec = 0;
+    int32 BurstBytes = 0;
+    double Tokens = 0.0;
+    double LastRefillTime = -1.0;
+
+    double WindowStartTime = 0.0;
+    int64 WindowBytes = 0;
+    float SendRateBytesPerSec = 0.0f;
+    int64 TotalBytesSent = 0;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AudioReplicatorDebugTypes.h"
+#include "OpusClipCache.h"
+#include "AudioReplicatorPacer.h"
+#include "AudioReplicatorSubsystem.generated.h"
+
+class UAudioReplicatorComponent;
+class UNetConnection;
+
+/**
+ * Per-world registry of audio replicator components.
+ *
+ * Every player connection talks to the server through the component on an actor it owns
+ * (its "endpoint"). Requests about sessions of other players, such as retransmissions,
+ * are routed through that endpoint because only owned actors may call server RPCs.
+ *
+ * On the server it also owns the clip cache that lets repeated broadcasts skip the upload.
+ * It keeps one chunk pacer per connection, so every component sending over the same link
+ * shares one byte budget.
+ */
+UCLASS()
+class AUDIOREPLICATOR_API UAudioReplicatorSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+public:
+    void RegisterComponent(UAudioReplicatorComponent* Component);
+    void UnregisterComponent(UAudioReplicatorComponent* Component);
+
+    // Client: the component owned by the local player, or nullptr if there is none yet.
+    UAudioReplicatorComponent* FindLocalEndpoint() const;
+
+    // Server: the component owned by the given client connection.
+    UAudioReplicatorComponent* FindEndpointForConnection(const UNetConnection* Connection) const;
+
+    // Server: one endpoint per player connection, plus the listen server's local player.
+    void GetListenerEndpoints(TArray<UAudioReplicatorComponent*>& OutEndpoints) const;
+
+    // Server: the component that relays the given session, or nullptr.
+    UAudioReplicatorComponent* FindRelayOwner(const FGuid& SessionId) const;
+
+    const TArray<TWeakObjectPtr<UAudioReplicatorComponent>>& GetComponents() const { return Components; }
+
+    // Token bucket of a connection: the server connection on clients, a player connection on the server.
+    // nullptr stands for traffic that never leaves the machine (standalone, the listen server's own player).
+    FAudioReplicatorPacer& GetConnectionPacer(const UNetConnection* Connection);
+    const FAudioReplicatorPacer* FindConnectionPacer(const UNetConnection* Connection) const;
+
+    // Server: finished clips by content hash.
+    FOpusClipCache& GetClipCache() { return ClipCache; }
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Cache")
+    void SetClipCacheMaxBytes(int64 MaxBytes);
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Cache")
+    void EmptyClipCache();
+
+    UFUNCTION(BlueprintCallable, Category = "AudioReplicator|Debug")
+    void GetClipCacheStats(FAudioReplicatorClipCacheStats& OutStats) const;
+
+private:
+    FOpusClipCache ClipCache;
+
+    TMap<TWeakObjectPtr<const UNetConnection>, FAudioReplicatorPacer> ConnectionPacers;
+    FAudioReplicatorPacer LocalPacer;
+
+    TArray<TWeakObjectPtr<UAudioReplicatorComponent>> Components;
+};
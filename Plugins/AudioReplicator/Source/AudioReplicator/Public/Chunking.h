@@ -5,5 +5,8 @@
 namespace Chunking
 {
     void PackWithLengths(const TArray<FOpusPacket>& Packets, TArray<uint8>& OutBuffer);
-    bool UnpackWithLengths(const TArray<uint8>& Buffer, TArray<FOpusPacket>& OutPackets);
+    bool UnpackWithLengths(TArrayView<const uint8> Buffer, TArray<FOpusPacket>& OutPackets);
+
+    // Append one length-prefixed packet in the PackWithLengths format; false if it does not fit the uint16 prefix.
+    bool AppendWithLength(TArrayView<const uint8> Packet, TArray<uint8>& OutBuffer);
 }
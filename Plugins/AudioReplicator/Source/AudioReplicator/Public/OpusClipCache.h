@@ -0,0 +1,57 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "OpusTypes.h"
+
+/**
+ * Server-side LRU cache of finished Opus clips keyed by content hash.
+ *
+ * Clips are stored in the Chunking::PackWithLengths format together with their header.
+ * When the packed bytes exceed the memory cap the least recently used clips are evicted.
+ */
+class AUDIOREPLICATOR_API FOpusClipCache
+{
+public:
+    struct FEntry
+    {
+        FOpusStreamHeader Header;
+        TArray<uint8> Packed;
+        uint64 LastUse = 0;
+    };
+
+    struct FStats
+    {
+        int32 Hits = 0;
+        int32 Misses = 0;
+        int32 Evictions = 0;
+        int32 NumClips = 0;
+        int64 Bytes = 0;
+        int64 MaxBytes = 0;
+    };
+
+    explicit FOpusClipCache(int64 InMaxBytes = 16 * 1024 * 1024);
+
+    // Lookup that counts as a hit or miss and marks the clip as recently used.
+    const FEntry* Find(const FGuid& Hash);
+
+    bool Contains(const FGuid& Hash) const { return Entries.Contains(Hash); }
+
+    // Clips larger than the whole cap are not stored.
+    void Add(const FGuid& Hash, const FOpusStreamHeader& Header, TArray<uint8>&& Packed);
+
+    void SetMaxBytes(int64 InMaxBytes);
+    void Empty();
+
+    FStats GetStats() const;
+
+private:
+    // Evict least recently used clips until NeededBytes more fit under the cap.
+    void EvictToFit(int64 NeededBytes);
+
+    TMap<FGuid, FEntry> Entries;
+    uint64 UseCounter = 0;
+    int64 Bytes = 0;
+    int64 MaxBytes = 0;
+    int32 Hits = 0;
+    int32 Misses = 0;
+    int32 Evictions = 0;
+};
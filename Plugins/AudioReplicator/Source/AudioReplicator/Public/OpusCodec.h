@@ -1,22 +1,110 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "OpusTypes.h"
 
 // forward-declare,    <opus.h>   
 struct OpusEncoder;
 struct OpusDecoder;
+class FOpusPacketArena;
+
+// Mirrors OPUS_APPLICATION_*, keeps <opus.h> out of the public header
+enum class EOpusApplication : uint8
+{
+    Voip,
+    Audio,
+    RestrictedLowDelay
+};
+
+// Mirrors OPUS_BANDWIDTH_*: the widest audio band the encoder may code
+enum class EOpusBandwidth : uint8
+{
+    Narrowband,     // 4 kHz
+    Mediumband,     // 6 kHz
+    Wideband,       // 8 kHz
+    Superwideband,  // 12 kHz
+    Fullband        // 20 kHz
+};
+
+// Encoder ctl values behind an EOpusEncoderProfile
+struct AUDIOREPLICATOR_API FOpusEncoderSettings
+{
+    EOpusApplication Application = EOpusApplication::Audio;
+    int32 Complexity = 8;
+    bool bVbr = true;
+    EOpusBandwidth MaxBandwidth = EOpusBandwidth::Fullband;
+
+    static FOpusEncoderSettings FromProfile(EOpusEncoderProfile Profile);
+};
 
 class AUDIOREPLICATOR_API FOpusCodec
 {
 public:
+    // Encoder + decoder
     static TUniquePtr<FOpusCodec> Create(int32 SampleRate = AUDIO_REPL_OPUS_SR, int32 Channels = 1, int32 Bitrate = 32000);
+    // Encoder only; decode calls fail
+    static TUniquePtr<FOpusCodec> CreateEncoder(int32 SampleRate, int32 Channels, int32 Bitrate, EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip);
+    // Decoder only; encode calls fail
+    static TUniquePtr<FOpusCodec> CreateDecoder(int32 SampleRate, int32 Channels);
+
+    // PCM16 clip -> Opus packets; the tail is padded like EncodeClipToArena
+    bool EncodePcm16ToPackets(const TArray<int16>& Pcm, int32 FrameSizeSamplesPerCh, TArray<TArray<uint8>>& OutPackets, int32& OutPreSkip, int32& OutEndTrim);
+    // One interleaved PCM16 frame -> one Opus packet (keeps encoder state between calls, used by live streams)
+    bool EncodeFrame(const int16* FramePcm, int32 FrameSizeSamplesPerCh, TArray<uint8>& OutPacket);
+    // One frame appended in place to the end of the arena
+    bool EncodeFrameToArena(const int16* FramePcm, int32 FrameSizeSamplesPerCh, FOpusPacketArena& Arena);
+    // Frames [FirstFrame, FirstFrame + NumFrames) of Pcm appended to the arena; frames past the end of Pcm are padded with silence
+    bool EncodeFramesToArena(TArrayView<const int16> Pcm, int32 FrameSizeSamplesPerCh, int32 FirstFrame, int32 NumFrames, FOpusPacketArena& Arena);
+    // Whole clip: the tail is padded with silence until the lookahead is flushed, so the decoder can return
+    // every input sample. OutPreSkip / OutEndTrim are the FOpusStreamHeader values; OutArena is reset first
+    bool EncodeClipToArena(TArrayView<const int16> Pcm, int32 FrameSizeSamplesPerCh, FOpusPacketArena& OutArena, int32& OutPreSkip, int32& OutEndTrim);
+    // Opus packets -> PCM16; PreSkip samples per channel are dropped from the front and EndTrim from the back
+    bool DecodePacketsToPcm16(const TArray<TArray<uint8>>& Packets, TArray<int16>& OutPcm, int32 PreSkip = 0, int32 EndTrim = 0);
+    // One Opus packet -> interleaved PCM16 (keeps decoder state between calls, used by the jitter buffer)
+    bool DecodeFrame(const uint8* Data, int32 NumBytes, TArray<int16>& OutPcm);
+    // Recover a lost frame from the in-band FEC data of the packet that follows it
+    bool DecodeFecFrame(const uint8* NextData, int32 NextNumBytes, int32 FrameSizeSamplesPerCh, TArray<int16>& OutPcm);
+    // Packet loss concealment: synthesize a lost frame from the decoder state
+    bool ConcealFrame(int32 FrameSizeSamplesPerCh, TArray<int16>& OutPcm);
+
+    // Bitrate for the following frames; GetBitrate keeps the creation value, which Reset restores
+    void SetBitrate(int32 InBitrate);
 
-    // PCM16 -> Opus packets
-    bool EncodePcm16ToPackets(const TArray<int16>& Pcm, int32 FrameSizeSamplesPerCh, TArray<TArray<uint8>>& OutPackets);
-    // Opus packets -> PCM16
-    bool DecodePacketsToPcm16(const TArray<TArray<uint8>>& Packets, TArray<int16>& OutPcm);
+    // Expected loss in percent; > 0 also enables in-band FEC so the next packet can repair a lost one
+    void SetPacketLossPercent(int32 Percent);
+
+    // Discontinuous transmission: once Opus' own VAD has seen about 200 ms without activity, frames
+    // shrink to 1-2 byte packets that the decoder fills with comfort noise
+    void SetDtx(bool bEnable);
+    // True while the encoder is in DTX, i.e. its VAD hears no speech; only reported with DTX enabled
+    bool IsInDtx() const;
+
+    // OPUS_RESET_STATE on both sides and restore the creation settings (bitrate, no FEC, no DTX),
+    // so the codec behaves like a freshly created one. Used by FOpusCodecPool on return.
+    void Reset();
 
     int32 GetSampleRate() const { return SR; }
     int32 GetChannels() const { return Ch; }
+    int32 GetBitrate() const { return Bitrate; }
+    EOpusEncoderProfile GetProfile() const { return Profile; }
+    EOpusApplication GetApplication() const { return Application; }
+    bool HasEncoder() const { return Encoder != nullptr; }
+    bool HasDecoder() const { return Decoder != nullptr; }
+    // Duration of the last decoded frame, 0 before anything was decoded
+    int32 GetLastFrameSamplesPerCh() const;
+    // Duration of a packet, -1 if it cannot be parsed
+    int32 GetPacketSamplesPerCh(const uint8* Data, int32 NumBytes) const;
+
+    // Encoder delay in samples per channel, the value OPUS_GET_LOOKAHEAD reports: decoded audio lags the input by this much
+    static int32 GetLookahead(int32 SampleRate, EOpusApplication Application);
+    static int32 GetLookahead(int32 SampleRate, EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip);
+    // Frames a clip of NumSamplesPerCh takes once PreSkip samples of padding have pushed its last sample out
+    // of the encoder; OutEndTrim is the silence after the last sample
+    static int32 GetClipFrameCount(int64 NumSamplesPerCh, int32 FrameSizeSamplesPerCh, int32 PreSkip, int32& OutEndTrim);
+
+    // Opus only runs at 8, 12, 16, 24 and 48 kHz
+    static bool IsSupportedSampleRate(int32 SampleRate);
+    // Rate a source is encoded at: its own when Opus supports it, AUDIO_REPL_OPUS_SR (after FPcmResampler) otherwise
+    static int32 GetEncodeSampleRate(int32 SourceSampleRate);
 
     //   ,  TUniquePtr   
     ~FOpusCodec();
@@ -26,11 +114,13 @@ public:
     FOpusCodec& operator=(const FOpusCodec&) = delete;
 
 private:
-    FOpusCodec(int32 InSR, int32 InCh, int32 InBitrate);
+    FOpusCodec(int32 InSR, int32 InCh, int32 InBitrate, EOpusEncoderProfile InProfile, bool bWithEncoder, bool bWithDecoder);
 
     OpusEncoder* Encoder = nullptr;
     OpusDecoder* Decoder = nullptr;
     int32 SR = 48000;
     int32 Ch = 1;
     int32 Bitrate = 32000;
+    EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip;
+    EOpusApplication Application = EOpusApplication::Audio;
 };
@@ -0,0 +1,75 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "OpusCodec.h"
+
+/**
+ * Process-wide pool of idle Opus encoders and decoders.
+ *
+ * Encoders are keyed by (sample rate, channels, bitrate, profile), decoders by
+ * (sample rate, channels). Acquire returns a shared pointer whose deleter resets the codec
+ * with OPUS_RESET_STATE and hands it back to the pool instead of destroying it, so repeated
+ * encode/decode calls and new sessions skip opus_*_create. Safe to use from any thread.
+ */
+class AUDIOREPLICATOR_API FOpusCodecPool
+{
+public:
+    struct FStats
+    {
+        int32 Created = 0;
+        int32 Reused = 0;
+        int32 Idle = 0;
+    };
+
+    static FOpusCodecPool& Get();
+
+    FOpusCodecPool();
+
+    // Null if the codec cannot be created for these parameters.
+    TSharedPtr<FOpusCodec> AcquireEncoder(int32 SampleRate, int32 Channels, int32 Bitrate, EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip);
+    TSharedPtr<FOpusCodec> AcquireDecoder(int32 SampleRate, int32 Channels);
+
+    // Idle codecs kept per key; extra returned codecs are destroyed.
+    void SetMaxIdlePerKey(int32 InMaxIdlePerKey);
+    void Empty();
+
+    FStats GetStats() const;
+
+private:
+    struct FKey
+    {
+        int32 SampleRate = 0;
+        int32 Channels = 0;
+        int32 Bitrate = 0;
+        EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip;
+        bool bEncoder = false;
+
+        bool operator==(const FKey& Other) const
+        {
+            return SampleRate == Other.SampleRate && Channels == Other.Channels && Bitrate == Other.Bitrate
+                && Profile == Other.Profile && bEncoder == Other.bEncoder;
+        }
+
+        friend uint32 GetTypeHash(const FKey& Key)
+        {
+            uint32 Hash = HashCombine(GetTypeHash(Key.SampleRate), GetTypeHash(Key.Channels));
+            Hash = HashCombine(Hash, GetTypeHash(Key.Bitrate));
+            return HashCombine(Hash, GetTypeHash(((uint32)Key.Profile << 1) | (Key.bEncoder ? 1u : 0u)));
+        }
+    };
+
+    // Shared with the deleters of handed-out codecs, so returns stay valid even after the pool is gone.
+    struct FState
+    {
+        mutable FCriticalSection Lock;
+        TMap<FKey, TArray<TUniquePtr<FOpusCodec>>> Idle;
+        int32 MaxIdlePerKey = 4;
+        int32 NumIdle = 0;
+        int32 Created = 0;
+        int32 Reused = 0;
+    };
+
+    TSharedPtr<FOpusCodec> Acquire(const FKey& Key);
+    static void Return(const TSharedRef<FState, ESPMode::ThreadSafe>& State, FOpusCodec* Codec);
+
+    TSharedRef<FState, ESPMode::ThreadSafe> State;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class FOpusCodec;
+
+/**
+ * Adaptive playout buffer for a single incoming Opus session.
+ *
+ * Packets are inserted by chunk index in any order and pulled back one frame at a time
+ * in index order through a long-lived decoder. Playback starts once the buffered span
+ * reaches the target depth; the target grows by one frame on every underrun and slowly
+ * shrinks back towards the minimum while playback stays stable. Live sessions skip their
+ * oldest frames past the maximum depth to bound latency; clips arrive faster than real time
+ * and are played in full.
+ *
+ * An empty packet marks the start of a silence the sender did not transmit (DTX). Playback
+ * then continues with silence instead of running dry, and the next talk spurt is
+ * played at the target depth behind its first packet.
+ */
+class AUDIOREPLICATOR_API FOpusJitterBuffer
+{
+public:
+    enum class EPullResult : uint8
+    {
+        Decoded,    // OutPcm holds the next decoded frame
+        Concealed,  // The next frame was missing; OutPcm holds an FEC-recovered or concealed frame
+        Silent,     // The sender is silent (DTX or suppressed); OutPcm holds a frame of zeros
+        Buffering,  // Waiting for the buffer to reach the target depth
+        Underrun,   // Playback ran dry; the buffer goes back to buffering
+        Finished    // The session ended and every frame was played
+    };
+
+    struct FStats
+    {
+        int32 Underruns = 0;
+        int32 Overruns = 0;
+        int32 LateDrops = 0;
+        int32 FramesDecoded = 0;
+        int32 FramesConcealed = 0;
+        int32 FramesRecoveredFec = 0;
+        int32 FramesSilent = 0;
+        int32 TargetDepthMs = 0;
+        int32 DepthMs = 0;
+    };
+
+    FOpusJitterBuffer(int32 InSampleRate, int32 InChannels, int32 InFrameMs, int32 InMinDepthMs = 40, int32 InMaxDepthMs = 120, bool bInLive = true);
+    ~FOpusJitterBuffer();
+
+    FOpusJitterBuffer(const FOpusJitterBuffer&) = delete;
+    FOpusJitterBuffer& operator=(const FOpusJitterBuffer&) = delete;
+
+    // False if the decoder could not be created for the stream parameters.
+    bool IsValid() const { return Decoder.IsValid(); }
+
+    // Queue a packet by its chunk index; an empty one is a silence marker. Late and duplicate packets are ignored.
+    void Insert(int32 Index, const TArray<uint8>& Packet);
+
+    // Mark the end of the session; NumPackets <= 0 means the total is unknown.
+    void MarkEnded(int32 NumPackets);
+
+    // Produce the next frame of interleaved PCM16 if playback is running.
+    EPullResult Pull(TArray<int16>& OutPcm);
+
+    int32 GetDepthMs() const;
+    FStats GetStats() const;
+
+private:
+    // Rebuild the missing NextIndex frame from FEC in the following packet, or conceal it.
+    void RecoverMissingFrame(TArray<int16>& OutPcm);
+
+    // Borrowed from FOpusCodecPool, returned when the buffer is destroyed.
+    TSharedPtr<FOpusCodec> Decoder;
+    TMap<int32, TArray<uint8>> Pending;
+
+    int32 SampleRate = 48000;
+    int32 Channels = 1;
+    int32 FrameMs = 20;
+    int32 MinDepthMs = 40;
+    int32 MaxDepthMs = 120;
+    int32 TargetDepthMs = 40;
+    // Clips never skip frames on overrun.
+    bool bLive = true;
+
+    int32 NextIndex = 0;
+    int32 HighestIndex = -1;
+    int32 EndIndex = -1;
+    int32 StableFrames = 0;
+    bool bPlaying = false;
+    bool bStartedPlayout = false;
+    bool bEnded = false;
+
+    // Newest silence marker, and whether playback has reached it and is playing silence.
+    // Missing frames below SilentUntil lead into the talk spurt after a silence and are silence too.
+    int32 SilenceIndex = -1;
+    int32 SilentUntil = -1;
+    bool bInSilence = false;
+
+    FStats Stats;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "OpusTypes.h"
+
+/**
+ * Opus packets stored back to back in one growable byte buffer with an offset/length index.
+ *
+ * The encoder writes each frame in place at the end of the buffer, so a whole clip costs a few
+ * reallocations instead of one array per frame. Packets are read back as views into the buffer;
+ * copies are only made when converting to the Blueprint-facing FOpusPacket.
+ */
+class AUDIOREPLICATOR_API FOpusPacketArena
+{
+public:
+    struct FSpan
+    {
+        int32 Offset = 0;
+        int32 Length = 0;
+    };
+
+    // Drop all packets but keep the memory; optionally make room for what is about to be added.
+    void Reset(int32 ExpectedPackets = 0, int32 ExpectedBytes = 0);
+    void Empty();
+
+    // Reserve MaxBytes at the end of the buffer for a packet written in place.
+    // CommitPacket keeps the first NumBytes of it as the next packet; a new BeginPacket discards an uncommitted one.
+    uint8* BeginPacket(int32 MaxBytes);
+    void CommitPacket(int32 NumBytes);
+
+    void AddPacket(TArrayView<const uint8> Data);
+    void AddPackets(const TArray<FOpusPacket>& Packets);
+
+    // Append packets [First, First + Count) of another arena with a single copy of their bytes.
+    void AppendRange(const FOpusPacketArena& Other, int32 First, int32 Count);
+
+    // Drop the first Count packets and shift the rest to the front (live sessions release what was sent).
+    void RemoveFront(int32 Count);
+
+    // Drop the packet added last (live sessions withdraw a frame the voice gate suppressed).
+    void RemoveLast();
+
+    int32 Num() const { return Spans.Num(); }
+    bool IsValidIndex(int32 Index) const { return Spans.IsValidIndex(Index); }
+
+    TArrayView<const uint8> GetPacket(int32 Index) const
+    {
+        const FSpan& Span = Spans[Index];
+        return TArrayView<const uint8>(Bytes.GetData() + Span.Offset, Span.Length);
+    }
+    int32 GetPacketSize(int32 Index) const { return Spans[Index].Length; }
+
+    // Payload bytes of Count packets starting at First.
+    int64 GetRangeBytes(int32 First, int32 Count) const;
+    int64 GetTotalBytes() const { return PendingOffset == INDEX_NONE ? Bytes.Num() : PendingOffset; }
+
+    void ToPackets(TArray<FOpusPacket>& OutPackets) const;
+
+private:
+    TArray<uint8> Bytes;
+    TArray<FSpan> Spans;
+    // Start of the packet between BeginPacket and CommitPacket.
+    int32 PendingOffset = INDEX_NONE;
+};
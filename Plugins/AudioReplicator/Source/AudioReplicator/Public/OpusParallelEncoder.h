@@ -0,0 +1,44 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "OpusCodec.h"
+#include "PcmResampler.h"
+
+class FOpusPacketArena;
+
+/**
+ * Encodes long PCM clips as independent segments on the task graph.
+ *
+ * Each segment gets its own pooled encoder. A segment after the first starts PreRollFrames
+ * before its boundary and drops the packets of that pre-roll, so its encoder has seen the
+ * preceding audio and the concatenated stream decodes without a seam. PCM at a rate Opus cannot
+ * encode is first converted to SampleRate with FPcmResampler on the calling thread.
+ */
+namespace OpusParallelEncoder
+{
+    struct FParams
+    {
+        int32 SampleRate = AUDIO_REPL_OPUS_SR;
+        int32 Channels = 1;
+        int32 Bitrate = 32000;
+        int32 FrameSamplesPerCh = AUDIO_REPL_OPUS_SR / 50;
+        EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip;
+
+        // Rate of the PCM handed in; 0 means SampleRate. FrameSamplesPerCh is at SampleRate either way.
+        int32 SourceSampleRate = 0;
+        EAudioResampleQuality ResampleQuality = EAudioResampleQuality::Balanced;
+
+        // Frames per segment; clips shorter than two segments are encoded in one piece.
+        int32 SegmentFrames = 250;
+        int32 PreRollFrames = 3;
+    };
+
+    // Completion callback, always called on the game thread.
+    using FOnEncoded = TUniqueFunction<void(bool bSuccess, FOpusPacketArena&& Packets)>;
+
+    // Encode all of Pcm, the last frame padded with silence as FOpusCodec::EncodeClipToArena does,
+    // blocking until all segments are done (any thread).
+    AUDIOREPLICATOR_API bool EncodeToArena(TArrayView<const int16> Pcm, const FParams& Params, FOpusPacketArena& OutPackets);
+
+    // Same on a background task; the game thread is never blocked on the encode.
+    AUDIOREPLICATOR_API void EncodeAsync(TArray<int16>&& Pcm, const FParams& Params, FOnEncoded&& OnEncoded);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "OpusTypes.h"
+#include "PcmWavUtils.h"
+
+class FOpusCodec;
+
+/**
+ * Records one incoming Opus session to a WAV file while its chunks arrive.
+ *
+ * Packets are inserted by chunk index in any order, decoded in index order with a pooled
+ * decoder and appended to a PcmWav::FWavWriter, so only out-of-order packets are held in
+ * memory. A gap in a live session is concealed once MaxGapFrames newer packets have arrived
+ * past it; a clip holds its gaps open for retransmissions until Finish. The header's PreSkip and EndTrim are cut off, so a whole clip is
+ * written at its original length.
+ *
+ * Indices come from the network, so the concealment they can cause is bounded: packets more
+ * than MaxJumpFrames past the newest one are dropped unless a clip header announced them, and
+ * a session that ends more than MaxJumpFrames past its newest packet is closed there instead
+ * of filled up. Live silence (InsertSilence) moves the newest index along with it.
+ */
+class AUDIOREPLICATOR_API FOpusSessionRecorder
+{
+public:
+    FOpusSessionRecorder() = default;
+    ~FOpusSessionRecorder();
+
+    FOpusSessionRecorder(const FOpusSessionRecorder&) = delete;
+    FOpusSessionRecorder& operator=(const FOpusSessionRecorder&) = delete;
+
+    // Create the file and the decoder for the stream. FirstIndex is the first chunk to record;
+    // INDEX_NONE starts at the first packet inserted (late joiners of a live session).
+    bool Open(const FString& Path, const FOpusStreamHeader& Header, int32 FirstIndex = 0);
+
+    // Queue a packet by chunk index and write every frame that is now in order.
+    void Insert(int32 Index, TArrayView<const uint8> Packet);
+
+    // Frames [First, End) of a live session were silence the sender did not transmit. They are
+    // written as zeros, not counted as concealed, and do not hold back the frames after them.
+    void InsertSilence(int32 First, int32 End);
+
+    // Write the remaining frames, concealing the missing ones, and close the file.
+    // NumPackets <= 0 stops at the newest packet received, and so does a NumPackets too far past it.
+    bool Finish(int32 NumPackets);
+
+    bool IsOpen() const { return Writer.IsOpen(); }
+    int64 GetSamplesWritten() const { return Writer.GetNumSamples(); }
+    int32 GetFramesConcealed() const { return FramesConcealed; }
+    const FString& GetPath() const { return Writer.GetPath(); }
+
+    // Frames of newer packets that must arrive before a missing one is given up on.
+    static constexpr int32 MaxGapFrames = 25;
+
+    // Furthest a packet or the end of the session may lie past the newest packet.
+    static constexpr int32 MaxJumpFrames = MaxGapFrames * 4;
+
+private:
+    void Drain(int32 EndIndex);
+    // Decode the NextIndex frame, or conceal it when Packet is empty.
+    void WriteNext(TArrayView<const uint8> Packet, bool bSilent = false);
+    // Write decoded samples past the pre-skip, holding back the last EndTrim frames.
+    void Emit(TArrayView<const int16> Pcm);
+
+    PcmWav::FWavWriter Writer;
+    // Borrowed from FOpusCodecPool, returned when the recorder is destroyed.
+    TSharedPtr<FOpusCodec> Decoder;
+    TMap<int32, TArray<uint8>> Pending;
+    // Silent runs not reached yet: first index -> end index.
+    TMap<int32, int32> PendingSilence;
+    TArray<int16> FramePcm;
+    // Decoded samples that may still turn out to be end padding.
+    TArray<int16> Held;
+
+    int32 FrameSamplesPerCh = 0;
+    int32 NextIndex = 0;
+    int32 HighestIndex = -1;
+    int32 FramesConcealed = 0;
+    // Interleaved samples still to drop at the start, and to hold back at the end.
+    int32 SkipSamples = 0;
+    int32 TrimSamples = 0;
+    // Clips: frame count from the header; packets below it are never dropped as jumps, and gaps
+    // below it wait for Finish.
+    int32 AnnouncedPackets = 0;
+    bool bWaitingForFirst = false;
+    bool bWarnedJump = false;
+};
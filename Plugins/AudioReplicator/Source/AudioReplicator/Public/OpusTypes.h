@@ -2,6 +2,20 @@
 #include "CoreMinimal.h"
 #include "OpusTypes.generated.h"
 
+// Named Opus encoder setups (application, complexity, VBR, bandwidth); see FOpusEncoderSettings.
+UENUM(BlueprintType)
+enum class EOpusEncoderProfile : uint8
+{
+    // VOIP application, complexity 5, VBR, up to wideband: live speech.
+    Voice,
+    // AUDIO application, complexity 8, VBR, fullband: effects and music clips.
+    MusicClip,
+    // RESTRICTED_LOWDELAY, complexity 5, CBR, fullband: 2.5 ms of encoder delay instead of 6.5 ms.
+    LowLatency,
+    // AUDIO application, complexity 10, VBR, fullband: best quality per bit for stored clips.
+    Archival
+};
+
 USTRUCT(BlueprintType)
 struct FOpusPacket
 {
@@ -28,9 +42,32 @@ struct FOpusStreamHeader
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
     int32 FrameMs = 20;
 
+    // Encoder setup the packets were made with; decoders need nothing from it, it is informational.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
+    EOpusEncoderProfile Profile = EOpusEncoderProfile::MusicClip;
+
     // Optional but handy for client-side buffering and progress tracking.
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
     int32 NumPackets = 0;
+
+    // True for push-based live sessions. The length is unknown when they start, so NumPackets is 0 in the
+    // start message; CloseStreamSession sends the final count with the end message like a clip does.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
+    bool bLive = false;
+
+    // Samples per channel of encoder delay at the start of the decoded stream, to be discarded.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
+    int32 PreSkip = 0;
+
+    // Clips only: samples per channel of silence padding the last frame, to be discarded.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
+    int32 EndTrim = 0;
+
+    // Clips only: MD5 of the stream parameters and the packets (MakeContentHash), used to offer the clip to
+    // the server cache. The server keys the cache by the packets it received, so nothing else can hit.
+    // Left invalid, the component computes it from the packets.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
+    FGuid ContentHash;
 };
 
 USTRUCT(BlueprintType)
@@ -46,3 +83,37 @@ struct FOpusChunk
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AudioReplicator")
     FOpusPacket Packet;
 };
+
+// Several consecutive frames of one session packed into a single RPC.
+USTRUCT()
+struct FOpusChunkBatch
+{
+    GENERATED_BODY()
+
+    // Compact per-connection handle, bound to the session id by the start message.
+    UPROPERTY()
+    uint16 SessionHandle = 0;
+
+    // Chunk index of the first frame in the batch; the rest follow consecutively.
+    UPROPERTY()
+    int32 FirstIndex = 0;
+
+    // Frames in the Chunking::PackWithLengths format (uint16 length + payload each).
+    UPROPERTY()
+    TArray<uint8> Payload;
+
+    // Upper bound accepted when reading a batch from the network.
+    static constexpr int32 MaxPayloadBytes = 65535;
+
+    // Packed ints instead of the default property serialization keep the per-RPC header at a few bytes.
+    bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FOpusChunkBatch> : public TStructOpsTypeTraitsBase2<FOpusChunkBatch>
+{
+    enum
+    {
+        WithNetSerializer = true
+    };
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * PCM DSP kernels with SSE2/AVX2 and NEON paths and a scalar fallback.
+ *
+ * The vector path is picked at compile time from the target's intrinsics support (AVX2 only when
+ * the build targets it); every entry point finishes the tail that does not fill a vector with the
+ * scalar code. Float samples are normalized to [-1, 1); int16 conversions saturate.
+ */
+namespace PcmDsp
+{
+    // Name of the vector path compiled in: "AVX2", "SSE2", "NEON" or "Scalar".
+    AUDIOREPLICATOR_API const TCHAR* GetKernelPathName();
+
+    AUDIOREPLICATOR_API void Int16ToFloat(const int16* In, float* Out, int32 Num);
+    AUDIOREPLICATOR_API void FloatToInt16(const float* In, int16* Out, int32 Num);
+
+    AUDIOREPLICATOR_API void Int32ToInt16(const int32* In, int16* Out, int32 Num);
+    AUDIOREPLICATOR_API void Int16ToInt32(const int16* In, int32* Out, int32 Num);
+
+    // Packed little-endian 24-bit samples (3 bytes each) and full-scale int32 samples to float.
+    AUDIOREPLICATOR_API void Int24ToFloat(const uint8* In, float* Out, int32 Num);
+    AUDIOREPLICATOR_API void Int32ToFloat(const int32* In, float* Out, int32 Num);
+
+    // FloatToInt16 with triangular (TPDF) dither of +-1 LSB, for reducing 24-bit and float sources.
+    // InOutSeed carries the noise generator across calls; it must not be zero.
+    AUDIOREPLICATOR_API void FloatToInt16Dither(const float* In, int16* Out, int32 Num, uint32& InOutSeed);
+
+    // In-place gain; int16 results saturate.
+    AUDIOREPLICATOR_API void ApplyGain(int16* InOut, int32 Num, float Gain);
+    AUDIOREPLICATOR_API void ApplyGain(float* InOut, int32 Num, float Gain);
+
+    // Planar <-> interleaved; NumFrames samples per channel.
+    AUDIOREPLICATOR_API void Interleave(const int16* const* Planes, int32 NumChannels, int32 NumFrames, int16* Out);
+    AUDIOREPLICATOR_API void Deinterleave(const int16* In, int32 NumChannels, int32 NumFrames, int16* const* OutPlanes);
+
+    // Peak and RMS level of the samples, normalized to [0, 1].
+    AUDIOREPLICATOR_API void ComputePeakRms(const int16* In, int32 Num, float& OutPeak, float& OutRms);
+
+    // Sum of A[i] * B[i]: the inner loop of the FIR filters (FPcmResampler).
+    AUDIOREPLICATOR_API float DotProduct(const float* A, const float* B, int32 Num);
+
+    // Reference implementations, used for the tails and by the benchmark.
+    namespace Scalar
+    {
+        AUDIOREPLICATOR_API void Int16ToFloat(const int16* In, float* Out, int32 Num);
+        AUDIOREPLICATOR_API void FloatToInt16(const float* In, int16* Out, int32 Num);
+        AUDIOREPLICATOR_API void Int32ToInt16(const int32* In, int16* Out, int32 Num);
+        AUDIOREPLICATOR_API void Int16ToInt32(const int16* In, int32* Out, int32 Num);
+        AUDIOREPLICATOR_API void Int24ToFloat(const uint8* In, float* Out, int32 Num);
+        AUDIOREPLICATOR_API void Int32ToFloat(const int32* In, float* Out, int32 Num);
+        AUDIOREPLICATOR_API void FloatToInt16Dither(const float* In, int16* Out, int32 Num, uint32& InOutSeed);
+        AUDIOREPLICATOR_API void ApplyGain(int16* InOut, int32 Num, float Gain);
+        AUDIOREPLICATOR_API void ApplyGain(float* InOut, int32 Num, float Gain);
+        AUDIOREPLICATOR_API void Interleave(const int16* const* Planes, int32 NumChannels, int32 NumFrames, int16* Out);
+        AUDIOREPLICATOR_API void Deinterleave(const int16* In, int32 NumChannels, int32 NumFrames, int16* const* OutPlanes);
+        AUDIOREPLICATOR_API void ComputePeakRms(const int16* In, int32 Num, float& OutPeak, float& OutRms);
+        AUDIOREPLICATOR_API float DotProduct(const float* A, const float* B, int32 Num);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "PcmResampler.generated.h"
+
+// Filter length of FPcmResampler: longer filters keep more of the top octave but add delay.
+UENUM(BlueprintType)
+enum class EAudioResampleQuality : uint8
+{
+    // 16 taps, ~0.2 ms delay: live voice.
+    Fast,
+    // 32 taps, ~0.35 ms delay: the default for voice and effects.
+    Balanced,
+    // 64 taps, ~0.7 ms delay: music.
+    High
+};
+
+/**
+ * Streaming polyphase resampler for interleaved int16 PCM.
+ *
+ * The ratio is reduced to Up/Down and a Kaiser-windowed sinc is tabulated for every output phase
+ * (interpolated between 1024 tabulated phases when Up is larger), so each output sample per channel
+ * is one PcmDsp::DotProduct over a planar history. Input may arrive in blocks of any size; the filter
+ * delay is compensated, and Flush emits the tail so a whole clip comes out as
+ * GetOutputFrames(InFrames) frames aligned with the input.
+ */
+class AUDIOREPLICATOR_API FPcmResampler
+{
+public:
+    bool Init(int32 InInputRate, int32 InOutputRate, int32 InChannels, EAudioResampleQuality Quality = EAudioResampleQuality::Balanced);
+
+    // Drop the history and start a new stream with the same rates.
+    void Reset();
+
+    // Resample interleaved frames and append the frames now complete to Out.
+    void Process(TArrayView<const int16> In, TArray<int16>& Out);
+
+    // Append the frames still held back by the filter delay, then Reset.
+    void Flush(TArray<int16>& Out);
+
+    bool IsInitialized() const { return Channels > 0; }
+    bool IsPassthrough() const { return InputRate == OutputRate; }
+    int32 GetInputRate() const { return InputRate; }
+    int32 GetOutputRate() const { return OutputRate; }
+    int32 GetChannels() const { return Channels; }
+
+    // Input frames held back before they reach the output.
+    int32 GetLatencyFrames() const { return IsPassthrough() ? 0 : Taps / 2; }
+
+    int64 GetOutputFrames(int64 InFrames) const;
+    static int64 GetOutputFrames(int64 InFrames, int32 InputRate, int32 OutputRate);
+
+    // Process + Flush over a whole buffer.
+    static bool ResampleBuffer(TArrayView<const int16> In, int32 InputRate, int32 OutputRate, int32 Channels, EAudioResampleQuality Quality, TArray<int16>& Out);
+
+    // Phases tabulated at most; finer ratios interpolate between neighbouring phases.
+    static constexpr int32 MaxPhases = 1024;
+
+private:
+    void BuildFilter(EAudioResampleQuality Quality);
+    void AppendInput(const int16* In, int32 Frames);
+    // Produce output frames while the filter window fits in the history, up to MaxFrames.
+    void Produce(int64 MaxFrames, TArray<int16>& Out);
+
+    int32 InputRate = 0;
+    int32 OutputRate = 0;
+    int32 Channels = 0;
+    int32 Taps = 0;
+
+    // Output step in input samples is Down / Up.
+    int32 Up = 1;
+    int32 Down = 1;
+    int32 NumPhases = 0;
+
+    // (NumPhases + 1) rows of Taps coefficients; the extra row closes the interpolation at phase 1.
+    TArray<float> Coefs;
+
+    // Planar float history per channel, primed with Taps / 2 zeros to centre the filter.
+    TArray<TArray<float>> History;
+    int64 Pos = 0;
+    int64 Frac = 0;
+    int64 TotalIn = 0;
+    int64 TotalOut = 0;
+
+    TArray<float> InScratch;
+    TArray<float> OutScratch;
+    // Coefficients of the current output instant when phases are interpolated.
+    TArray<float> BlendRow;
+};
@@ -1,8 +1,82 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "PcmWavUtils.generated.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// How WAV files with more channels than the codec takes are reduced on load.
+UENUM(BlueprintType)
+enum class EAudioWavDownmix : uint8
+{
+    // Mono stays mono; anything wider is folded down to stereo with ITU-style coefficients.
+    Stereo,
+    // Every source is folded down to one channel.
+    Mono,
+    // Keep the first one or two channels and drop the rest.
+    FirstChannels
+};
 
 namespace PcmWav
 {
+    enum class ESampleFormat : uint8
+    {
+        Int16,
+        Int24,   // packed 3-byte samples
+        Int32,   // also 24-bit samples stored left-justified in 32-bit containers
+        Float32
+    };
+
+    // Layout of a data chunk as stored in the file.
+    struct FWavSourceFormat
+    {
+        ESampleFormat SampleFormat = ESampleFormat::Int16;
+        int32 Channels = 0;
+        // WAVE_FORMAT_EXTENSIBLE speaker mask; 0 means the default order for the channel count.
+        uint32 ChannelMask = 0;
+
+        int32 GetBytesPerSample() const;
+        int32 GetBytesPerFrame() const { return GetBytesPerSample() * Channels; }
+    };
+
+    struct FWavLoadOptions
+    {
+        EAudioWavDownmix Downmix = EAudioWavDownmix::Stereo;
+        // TPDF dither whenever samples lose precision (24-bit, 32-bit and float sources, or mixed channels).
+        bool bDither = true;
+    };
+
+    /**
+     * Converts interleaved frames of any supported source format to interleaved PCM16.
+     *
+     * Samples go through the PcmDsp kernels to float, are mixed down with a precomputed matrix
+     * when the channel count changes, and are reduced to 16 bits with dither. 16-bit sources
+     * that keep their channels are copied as they are.
+     */
+    class AUDIOREPLICATOR_API FWavConverter
+    {
+    public:
+        void Configure(const FWavSourceFormat& InFormat, const FWavLoadOptions& InOptions);
+
+        int32 GetOutputChannels() const { return OutChannels; }
+        bool IsPassthrough() const { return bPassthrough; }
+
+        // Raw holds NumFrames * GetBytesPerFrame() bytes; Out receives NumFrames * GetOutputChannels() samples.
+        void Convert(const uint8* Raw, int32 NumFrames, int16* Out);
+
+    private:
+        FWavSourceFormat Format;
+        FWavLoadOptions Options;
+        int32 OutChannels = 0;
+        bool bPassthrough = false;
+        // OutChannels x Format.Channels, row-major; empty when the channels are kept.
+        TArray<float> Matrix;
+        TArray<float> SourceScratch;
+        TArray<float> MixScratch;
+        uint32 DitherSeed = 0x2545F491u;
+    };
+
     /**
      * Resolve a relative or absolute WAV path against the project directories.
      *
@@ -12,12 +86,108 @@ namespace PcmWav
     FString ResolveProjectPath_V3(const FString& Path);
 
     /**
-     * Load a WAV (RIFF PCM 16-bit) file and output interleaved PCM16 samples.
+     * Reader for WAV files that does not load the whole file into memory.
+     *
+     * Accepts 16/24/32-bit integer PCM and 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE, with any
+     * channel count; samples come out as PCM16 with the channels reduced per FWavLoadOptions.
+     * Only the chunk headers are read on Open. The file is memory-mapped when the platform
+     * allows it; a 16-bit file that keeps its channels is then available as a zero-copy view of
+     * interleaved samples. Otherwise ReadSamples converts from the mapping or from chunked reads
+     * straight into the caller's buffer.
+     */
+    class AUDIOREPLICATOR_API FWavReader
+    {
+    public:
+        FWavReader();
+        ~FWavReader();
+
+        // Path is resolved like LoadWavFileToPcm16. Logs a warning and returns false on bad files.
+        bool Open(const FString& InPath, const FWavLoadOptions& InOptions = FWavLoadOptions(), bool bAllowMapping = true);
+        void Close();
+
+        bool IsOpen() const { return DataBytes >= 0; }
+        // The data chunk is available in place as PCM16 (GetMappedSamples).
+        bool IsMapped() const { return Mapped.Num() > 0; }
+
+        int32 GetSampleRate() const { return SampleRate; }
+        // Channels of the PCM16 output, after downmix.
+        int32 GetChannels() const { return Converter.GetOutputChannels(); }
+        const FWavSourceFormat& GetSourceFormat() const { return Format; }
+
+        int64 GetNumFrames() const { return NumFrames; }
+        // Interleaved output samples (frames * output channels).
+        int64 GetNumSamples() const { return NumFrames * GetChannels(); }
+
+        // The data chunk in place when mapped and already PCM16 in the output layout; empty otherwise.
+        TArrayView<const int16> GetMappedSamples() const { return Mapped; }
+
+        // Convert up to Out.Num() output samples starting at FirstSample, which must start a frame unless
+        // the file is copied as is. Returns the number written, or -1 on a read error.
+        int64 ReadSamples(int64 FirstSample, TArrayView<int16> Out);
+
+    private:
+        TUniquePtr<IFileHandle> File;
+        TUniquePtr<IMappedFileHandle> MappedFile;
+        TUniquePtr<IMappedFileRegion> MappedRegion;
+        const uint8* MappedBytes = nullptr;
+        TArrayView<const int16> Mapped;
+
+        FWavSourceFormat Format;
+        FWavConverter Converter;
+        TArray<uint8> ReadScratch;
+
+        int32 SampleRate = 0;
+        int64 NumFrames = 0;
+        int64 DataOffset = 0;
+        int64 DataBytes = -1;
+    };
+
+    /**
+     * Incremental writer for WAV (RIFF PCM 16-bit) files.
+     *
+     * Open writes a 44-byte header with placeholder sizes, Append streams interleaved
+     * samples straight to the file handle, and Close patches the RIFF and data sizes.
+     * Memory use does not depend on the recording length.
+     */
+    class AUDIOREPLICATOR_API FWavWriter
+    {
+    public:
+        FWavWriter();
+        // Closes the file if still open, so an abandoned recording is still a valid WAV.
+        ~FWavWriter();
+
+        FWavWriter(const FWavWriter&) = delete;
+        FWavWriter& operator=(const FWavWriter&) = delete;
+
+        // Path is resolved like SavePcm16ToWavFile; missing directories are created.
+        bool Open(const FString& InPath, int32 InSampleRate, int32 InChannels);
+        bool Append(TArrayView<const int16> Pcm);
+        // Patch the header sizes to the samples written and release the file; returns false if the final
+        // writes or an earlier Append failed.
+        bool Close();
+
+        bool IsOpen() const { return File.IsValid(); }
+        int64 GetNumSamples() const { return DataBytes / (int64)sizeof(int16); }
+        const FString& GetPath() const { return FullPath; }
+
+    private:
+        TUniquePtr<IFileHandle> File;
+        FString FullPath;
+        int32 SampleRate = 0;
+        int32 Channels = 0;
+        int64 DataBytes = 0;
+        bool bFailed = false;
+    };
+
+    /**
+     * Load a WAV file (any format FWavReader accepts) and output interleaved PCM16 samples.
+     * Reads through FWavReader, so the file is never held in memory next to the samples.
      */
-    bool LoadWavFileToPcm16(const FString& Path, TArray<int16>& OutPcm, int32& OutSR, int32& OutCh);
+    bool LoadWavFileToPcm16(const FString& Path, TArray<int16>& OutPcm, int32& OutSR, int32& OutCh, const FWavLoadOptions& Options = FWavLoadOptions());
 
     /**
      * Serialize interleaved PCM16 samples to a standard WAV (RIFF PCM 16-bit) file.
+     * Writes through FWavWriter, without building the file in memory first.
      */
     bool SavePcm16ToWavFile(const FString& Path, const TArray<int16>& Pcm, int32 SR, int32 Ch);
 }
@@ -0,0 +1,35 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Speech gate for live sessions, one decision per encoded frame.
+ *
+ * A frame counts as speech when its RMS level reaches the threshold (the user's mic threshold; 0 lets
+ * every frame through) and the Opus encoder, run with DTX, has not fallen back to discontinuous
+ * transmission. The gate stays open for HangoverFrames after the last speech frame so word endings
+ * and short pauses are not clipped.
+ */
+class AUDIOREPLICATOR_API FVoiceActivityDetector
+{
+public:
+    // Threshold is an RMS level in [0, 1].
+    void Configure(float InThreshold, int32 InHangoverFrames);
+
+    // Energy half of the decision: RMS of the interleaved samples against the threshold.
+    bool IsAboveThreshold(const int16* Samples, int32 NumSamples) const;
+
+    // Feed the decision for the frame just encoded; returns true while the gate is open.
+    bool Update(bool bAboveThreshold, bool bEncoderInDtx);
+
+    bool IsActive() const { return bActive; }
+    float GetThreshold() const { return Threshold; }
+
+    // Closed gate, as at the start of a session.
+    void Reset();
+
+private:
+    float Threshold = 0.0f;
+    int32 HangoverFrames = 0;
+    int32 HangoverLeft = 0;
+    bool bActive = false;
+};
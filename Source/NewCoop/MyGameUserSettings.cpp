@@ -2,6 +2,7 @@
 
 
 #include "MyGameUserSettings.h"
+#include "AudioReplicatorComponent.h"
 
 UMyGameUserSettings::UMyGameUserSettings(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -49,3 +50,15 @@ void UMyGameUserSettings::SetLoopback(bool Value)
 {
 	Loopback = Value;
 }
+
+void UMyGameUserSettings::ApplyVoiceSettings(UAudioReplicatorComponent* Component) const
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	// The threshold gates frames by RMS level; below it live sessions send DTX or nothing.
+	Component->VoiceActivityThreshold = FMath::Clamp(MicThresholdValue, 0.0f, 1.0f);
+	Component->InputGain = FMath::Clamp(MicVolume, 0.0f, 4.0f);
+}
@@ -6,6 +6,8 @@
 #include "GameFramework/GameUserSettings.h"
 #include "MyGameUserSettings.generated.h"
 
+class UAudioReplicatorComponent;
+
 /**
  * 
  */
@@ -73,6 +75,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = Settings)
 	void SetLoopback(bool Value);
 
+	/** Applies the microphone threshold and volume to a voice component; affects sessions it opens afterwards. */
+	UFUNCTION(BlueprintCallable, Category = Settings)
+	void ApplyVoiceSettings(UAudioReplicatorComponent* Component) const;
+
 protected:
 
     UPROPERTY(config)